@@ -11,6 +11,8 @@
 
 #include "config.h"
 #include "MenuNavigation.h"
+#include "EncoderBank.h"
+#include "VoiceAllocator.h"
 
 const char* PROJECT_NAME = "DCO-Teensy Synth";
 const char* PROJECT_SUBTITLE = "6-Voice Poly";
@@ -44,25 +46,12 @@ MIDIDevice midi1(myusb);
 MIDI_CREATE_INSTANCE(HardwareSerial, Serial1, MIDI);
 #endif
 
-Encoder enc1(ENC_1_CLK, ENC_1_DT);
-Encoder enc2(ENC_2_CLK, ENC_2_DT);
-Encoder enc3(ENC_3_CLK, ENC_3_DT);
-Encoder enc4(ENC_4_CLK, ENC_4_DT);
-Encoder enc5(ENC_5_CLK, ENC_5_DT);
-Encoder enc6(ENC_6_CLK, ENC_6_DT);
-Encoder enc7(ENC_7_CLK, ENC_7_DT);
-Encoder enc8(ENC_8_CLK, ENC_8_DT);
-Encoder enc9(ENC_9_CLK, ENC_9_DT);
-Encoder enc10(ENC_10_CLK, ENC_10_DT);
-Encoder enc11(ENC_11_CLK, ENC_11_DT);
-Encoder enc13(ENC_13_CLK, ENC_13_DT);
-Encoder enc14(ENC_14_CLK, ENC_14_DT);
-Encoder enc15(ENC_15_CLK, ENC_15_DT);
-Encoder enc16(ENC_16_CLK, ENC_16_DT);
-Encoder enc17(ENC_17_CLK, ENC_17_DT);
-Encoder enc18(ENC_18_CLK, ENC_18_DT);
-Encoder enc19(ENC_19_CLK, ENC_19_DT);
-Encoder enc20(ENC_20_CLK, ENC_20_DT);
+// All 19 panel encoders, built from the config.h pin tables and indexed like encoderMapping
+// (slot 11 is the menu encoder, which MenuNavigation.cpp reads through the Encoder library)
+const EncoderPins encoderPins[20] = {
+  ENCODER_PINS_1_11, {ENCODER_NO_PIN, ENCODER_NO_PIN}, ENCODER_PINS_13_20
+};
+EncoderBank<20> encoderBank;
 Encoder menuEncoder(MENU_ENCODER_DT, MENU_ENCODER_CLK);
 
 const int encoderMapping[20] = {
@@ -201,18 +190,33 @@ AudioConnection patchCordOutL_DAC(finalMixL, 0, i2s1, 0); // Left channel
 AudioConnection patchCordOutR_DAC(finalMixR, 0, i2s1, 1); // Right channel
 #endif
 
+#ifdef USE_VOICE_SLEEP
+// Every cord into, inside and out of each voice chain. Disconnecting them all
+// leaves the voice's objects with no connections, so they stop rendering.
+#define VOICE_CORDS 10
+AudioConnection* voiceCords[VOICES][VOICE_CORDS] = {
+  { &patchCord1_0, &patchCord1_0b, &patchCord2_0, &patchCord3_0, &patchCord4_0, &patchCord5_0, &patchCord6_0, &patchCord7_0, &patchCord8_0, &patchCordMix1 },
+  { &patchCord1_1, &patchCord1_1b, &patchCord2_1, &patchCord3_1, &patchCord4_1, &patchCord5_1, &patchCord6_1, &patchCord7_1, &patchCord8_1, &patchCordMix2 },
+  { &patchCord1_2, &patchCord1_2b, &patchCord2_2, &patchCord3_2, &patchCord4_2, &patchCord5_2, &patchCord6_2, &patchCord7_2, &patchCord8_2, &patchCordMix3 },
+  { &patchCord1_3, &patchCord1_3b, &patchCord2_3, &patchCord3_3, &patchCord4_3, &patchCord5_3, &patchCord6_3, &patchCord7_3, &patchCord8_3, &patchCordMix4 },
+  { &patchCord1_4, &patchCord1_4b, &patchCord2_4, &patchCord3_4, &patchCord4_4, &patchCord5_4, &patchCord6_4, &patchCord7_4, &patchCord8_4, &patchCordMix5 },
+  { &patchCord1_5, &patchCord1_5b, &patchCord2_5, &patchCord3_5, &patchCord4_5, &patchCord5_5, &patchCord6_5, &patchCord7_5, &patchCord8_5, &patchCordMix6 }
+};
+bool voiceAwake[VOICES] = { true, true, true, true, true, true };
+#endif
+
 struct PolyVoice {
   int note;
   bool active;
-  unsigned long noteOnTime;
+  unsigned long releaseTime; // millis() at note off, for level estimates
 };
 
 PolyVoice voices[VOICES];
-int currentVoice = 0;  // Round-robin voice allocation
+float voiceLevel(uint8_t v);
+VoiceAllocator<VOICES, VOICE_STEAL_RELEASE_FIRST> voiceAllocator(voiceLevel);  // Steals quietest releasing voice first
 
 // Mono mode note stack for proper note priority
-int monoNoteStack[16];  // Stack of held notes in mono mode
-int monoStackSize = 0;
+NoteStack<16> monoNotes;  // Stack of held notes in mono mode
 
 // Control values
 float pwmVolume = 0.5;     // PWM volume level (0-1)
@@ -553,6 +557,11 @@ void setup() {
   lfo.amplitude(1.0);
   
   pinMode(MENU_ENCODER_SW, INPUT_PULLUP);
+
+  encoderBank.begin(encoderPins);
+#ifdef USE_ENCODER_ACCELERATION
+  encoderBank.setAcceleration(true);
+#endif
   
   // Initialize encoder values
   for (int i = 0; i < 20; i++) {
@@ -622,7 +631,7 @@ void setup() {
     // Initialize voice state
     voices[v].note = 0;
     voices[v].active = false;
-    voices[v].noteOnTime = 0;
+    voices[v].releaseTime = 0;
     
     // Initialize glide state
     targetFreq[v] = 0.0;
@@ -687,57 +696,43 @@ void setup() {
   Serial.println(" Ready!");
 }
 
-void readDirectEncoders() {
-  encoderValues[0] = enc1.read() / 4;   // enc1
-  encoderValues[1] = enc2.read() / 4;   // enc2
-  encoderValues[2] = enc3.read() / 4;   // enc3
-  encoderValues[3] = enc4.read() / 4;   // enc4
-  encoderValues[4] = enc5.read() / 4;   // enc5
-  encoderValues[5] = enc6.read() / 4;   // enc6
-  encoderValues[6] = enc7.read() / 4;   // enc7
-  encoderValues[7] = enc8.read() / 4;   // enc8
-  encoderValues[8] = enc9.read() / 4;   // enc9
-  encoderValues[9] = enc10.read() / 4;  // enc10
-  encoderValues[10] = enc11.read() / 4; // enc11
-  // encoderValues[11] handled separately for cutoff (uses menuEncoder hardware) in MenuNavigation.cpp
-  encoderValues[12] = enc13.read() / 4; // enc13 (note: no enc12)
-  encoderValues[13] = enc14.read() / 4; // enc14
-  encoderValues[14] = enc15.read() / 4; // enc15
-  encoderValues[15] = enc16.read() / 4; // enc16
-  encoderValues[16] = enc17.read() / 4; // enc17
-  encoderValues[17] = enc18.read() / 4; // enc18
-  encoderValues[18] = enc19.read() / 4; // enc19
-  encoderValues[19] = enc20.read() / 4; // enc20
-}
+void readAllControls() {
+  // Only visit the encoders the bank saw move
+  uint32_t moved = encoderBank.takeDirty();
+  // Slot 11 is the menu encoder, written into encoderValues[] by MenuNavigation.cpp
+  if (encoderValues[11] != lastEncoderValues[11]) moved |= 1UL << 11;
+
+  while (moved) {
+    int i = __builtin_ctz(moved);
+    moved &= moved - 1;
+
+    int change;
+    if (encoderBank.exists(i)) {
+      change = encoderBank.change(i);
+      if (change == 0) continue; // turned less than a detent
+      encoderValues[i] = encoderBank.read(i);
+    } else {
+      change = encoderValues[i] - lastEncoderValues[i];
+    }
 
+    // If any physical knob is turned, exit menu mode
+    if (inMenu) {
+      inMenu = false;
+    }
 
-void readAllControls() {
-  // Read all encoders
-  readDirectEncoders();
-  
-  // Check for encoder changes and update parameters using configurable mapping
-  for (int i = 0; i < 20; i++) {
-    if (encoderValues[i] != lastEncoderValues[i]) {
-      // If any physical knob is turned, exit menu mode
-      if (inMenu) {
-        inMenu = false;
-      }
-      
-      int change = encoderValues[i] - lastEncoderValues[i];
-      int paramIndex = encoderMapping[i]; // Use configurable mapping
-      
-      // Only update if encoder is mapped to a valid parameter (not -1)
-      if (paramIndex >= 0 && paramIndex < NUM_PARAMETERS) {
-        int targetParam = paramIndex;
-        if (macroMode && paramIndex == 14) targetParam = 5;   // Filter Attack -> LFO Rate  
-        if (macroMode && paramIndex == 15) targetParam = 22;  // Filter Decay -> Chorus Mode
-        if (macroMode && paramIndex == 16) targetParam = 26;  // Filter Sustain -> Glide Time
-        
-        updateEncoderParameter(targetParam, change);
-      }
-      
-      lastEncoderValues[i] = encoderValues[i];
+    int paramIndex = encoderMapping[i]; // Use configurable mapping
+
+    // Only update if encoder is mapped to a valid parameter (not -1)
+    if (paramIndex >= 0 && paramIndex < NUM_PARAMETERS) {
+      int targetParam = paramIndex;
+      if (macroMode && paramIndex == 14) targetParam = 5;   // Filter Attack -> LFO Rate  
+      if (macroMode && paramIndex == 15) targetParam = 22;  // Filter Decay -> Chorus Mode
+      if (macroMode && paramIndex == 16) targetParam = 26;  // Filter Sustain -> Glide Time
+
+      updateEncoderParameter(targetParam, change);
     }
+
+    lastEncoderValues[i] = encoderValues[i];
   }
 }
 
@@ -842,11 +837,17 @@ void updateSynthParameter(int paramIndex, float val) {
       break;
     case 24: // Reserved
       break;
-    case 25: // Play Mode
-      if (val < 0.33) playMode = 0; // Mono
-      else if (val < 0.66) playMode = 1; // Poly
-      else playMode = 2; // Legato
+    case 25: { // Play Mode
+      int mode;
+      if (val < 0.33) mode = 0; // Mono
+      else if (val < 0.66) mode = 1; // Poly
+      else mode = 2; // Legato
+      if (mode != playMode) {
+        releaseAllVoices();
+        playMode = mode;
+      }
       break;
+    }
     case 26: // Glide Time
       glideTime = val; // 0.0 to 1.0
       break;
@@ -936,66 +937,73 @@ void updateEnvelopes() {
   }
 }
 
-// Find next voice using round-robin allocation
-int findAvailableVoice() {
-  // Start from current voice and look for next available
-  for (int i = 0; i < VOICES; i++) {
-    int v = (currentVoice + i) % VOICES;
-    if (!voices[v].active) {
-      currentVoice = (v + 1) % VOICES; // Set next voice for next time
-      return v;
+// Estimated amp envelope level of a voice, used to find the quietest releasing voice
+float voiceLevel(uint8_t v) {
+  switch (envelopePhase(ampEnv[v], voices[v].active)) {
+    case ENV_IDLE:
+      return 0.0;
+    case ENV_RELEASE: {
+      // The envelope releases linearly from (roughly) the sustain level
+      float releaseMs = max(ampRelease, 1.0f);
+      float remaining = 1.0 - (millis() - voices[v].releaseTime) / releaseMs;
+      return ampSustain * max(remaining, 0.0f);
     }
+    case ENV_SUSTAIN:
+      return ampSustain;
+    default:
+      return 1.0;
   }
-  
-  // If all voices are active, use round-robin for voice stealing
-  int voiceToSteal = currentVoice;
-  currentVoice = (currentVoice + 1) % VOICES; // Advance for next time
-  return voiceToSteal;
 }
 
-// Find voice playing a specific note
-int findVoiceForNote(int note) {
+// Return released voices to the free list once their amp envelope has finished
+void updateVoiceStates() {
   for (int v = 0; v < VOICES; v++) {
-    if (voices[v].active && voices[v].note == note) {
-      return v;
+    if (voiceAllocator.voiceState(v) == VOICE_RELEASING && !ampEnv[v].isActive()) {
+      voiceAllocator.voiceIdle(v);
     }
   }
-  return -1; // Note not found
 }
 
-// Mono mode note stack management
-void addToMonoStack(int note) {
-  // Don't add if already in stack
-  for (int i = 0; i < monoStackSize; i++) {
-    if (monoNoteStack[i] == note) return;
-  }
-  // Add to top of stack
-  if (monoStackSize < 16) {
-    monoNoteStack[monoStackSize] = note;
-    monoStackSize++;
+// Release every voice and start the allocator over, so a note held across a
+// play mode change can't keep its voice allocated in the new mode
+void releaseAllVoices() {
+  for (int v = 0; v < VOICES; v++) {
+    if (voices[v].active) {
+      ampEnv[v].noteOff();
+      filtEnv[v].noteOff();
+      voices[v].active = false;
+      voices[v].releaseTime = millis();
+    }
+    gliding[v] = false;
   }
+  monoNotes.clear();
+  voiceAllocator.reset();
 }
 
-void removeFromMonoStack(int note) {
-  // Find and remove note from stack
-  for (int i = 0; i < monoStackSize; i++) {
-    if (monoNoteStack[i] == note) {
-      // Shift remaining notes down
-      for (int j = i; j < monoStackSize - 1; j++) {
-        monoNoteStack[j] = monoNoteStack[j + 1];
-      }
-      monoStackSize--;
-      break;
-    }
+#ifdef USE_VOICE_SLEEP
+// Reconnect a sleeping voice before its envelopes are triggered
+void wakeVoice(int v) {
+  if (voiceAwake[v]) return;
+  for (int c = 0; c < VOICE_CORDS; c++) {
+    voiceCords[v][c]->connect();
   }
+  voiceAwake[v] = true;
 }
 
-int getTopMonoNote() {
-  if (monoStackSize > 0) {
-    return monoNoteStack[monoStackSize - 1]; // Return most recent note
+// Disconnect voices whose note is released and whose amp envelope has finished.
+// With no connections left their objects go inactive and update() is skipped;
+// the voice mixers treat the missing input as silence.
+void sleepIdleVoices() {
+  for (int v = 0; v < VOICES; v++) {
+    if (voiceAwake[v] && !voices[v].active && !ampEnv[v].isActive()) {
+      for (int c = 0; c < VOICE_CORDS; c++) {
+        voiceCords[v][c]->disconnect();
+      }
+      voiceAwake[v] = false;
+    }
   }
-  return -1; // No notes in stack
 }
+#endif
 
 void noteOn(int note, int velocity) {
   lfoStartTime = millis();
@@ -1005,7 +1013,7 @@ void noteOn(int note, int velocity) {
   
   if (playMode == 0) {
     // Mono mode - use note stack but retrigger envelope for every new note
-    addToMonoStack(note);
+    monoNotes.push(note);
     
     // Turn off other voices if they're somehow active
     for (int v = 1; v < VOICES; v++) {
@@ -1013,6 +1021,8 @@ void noteOn(int note, int velocity) {
         ampEnv[v].noteOff();
         filtEnv[v].noteOff();
         voices[v].active = false;
+        voices[v].releaseTime = millis();
+        voiceAllocator.voiceOff(v);
       }
     }
     
@@ -1020,7 +1030,7 @@ void noteOn(int note, int velocity) {
     voiceNum = 0;
     
     // If this is not the top note, don't trigger it yet
-    if (getTopMonoNote() != note) {
+    if (monoNotes.top() != note) {
       return; // Wait until this becomes the top note
     }
     
@@ -1036,7 +1046,7 @@ void noteOn(int note, int velocity) {
     // Set up the voice
     voices[0].note = note;
     voices[0].active = true;
-    voices[0].noteOnTime = millis();
+    voiceAllocator.voiceOn(0, note);
     
     // Calculate and set frequencies
     float baseFreq = 440.0 * pow(2.0, (note - 69) / 12.0);
@@ -1058,12 +1068,15 @@ void noteOn(int note, int velocity) {
     }
     
     // Always trigger envelopes in mono mode (retrigger for every note)
+#ifdef USE_VOICE_SLEEP
+    wakeVoice(0);
+#endif
     ampEnv[0].noteOn();
     filtEnv[0].noteOn();
   } 
   else if (playMode == 2) {
     // Legato mode - use note stack for smooth transitions without envelope retrigger
-    addToMonoStack(note);
+    monoNotes.push(note);
     
     // Always use voice 0 for legato mode
     voiceNum = 0;
@@ -1074,11 +1087,13 @@ void noteOn(int note, int velocity) {
         ampEnv[v].noteOff();
         filtEnv[v].noteOff();
         voices[v].active = false;
+        voices[v].releaseTime = millis();
+        voiceAllocator.voiceOff(v);
       }
     }
     
     // If this is not the top note, don't trigger it yet
-    if (getTopMonoNote() != note) {
+    if (monoNotes.top() != note) {
       return; // Wait until this becomes the top note
     }
     
@@ -1086,7 +1101,7 @@ void noteOn(int note, int velocity) {
     bool wasActive = voices[0].active;
     voices[0].note = note;
     voices[0].active = true;
-    voices[0].noteOnTime = millis();
+    voiceAllocator.voiceOn(0, note);
     
     // Calculate and set frequencies
     float baseFreq = 440.0 * pow(2.0, (note - 69) / 12.0);
@@ -1109,13 +1124,16 @@ void noteOn(int note, int velocity) {
     
     // Only trigger envelopes if no note was previously active
     if (!wasActive) {
+#ifdef USE_VOICE_SLEEP
+      wakeVoice(0);
+#endif
       ampEnv[0].noteOn();
       filtEnv[0].noteOn();
     }
   } 
   else {
     // Poly mode - normal polyphonic behavior
-    voiceNum = findAvailableVoice();
+    voiceNum = voiceAllocator.noteOn(note);
     
     // Check if voice was active before stealing (for glide)
     bool wasActive = voices[voiceNum].active;
@@ -1129,7 +1147,6 @@ void noteOn(int note, int velocity) {
     // Set up the voice
     voices[voiceNum].note = note;
     voices[voiceNum].active = true;
-    voices[voiceNum].noteOnTime = millis();
     
     // Calculate and set frequencies
     float baseFreq = 440.0 * pow(2.0, (note - 69) / 12.0);
@@ -1151,6 +1168,9 @@ void noteOn(int note, int velocity) {
     }
     
     // Always trigger envelopes in poly mode
+#ifdef USE_VOICE_SLEEP
+    wakeVoice(voiceNum);
+#endif
     ampEnv[voiceNum].noteOn();
     filtEnv[voiceNum].noteOn();
   }
@@ -1159,7 +1179,7 @@ void noteOn(int note, int velocity) {
 void noteOff(int note) {
   if (playMode == 0) {
     // Mono mode - use note stack and retrigger envelope for next note
-    removeFromMonoStack(note);
+    monoNotes.remove(note);
     
     // If the released note was the currently playing note
     if (voices[0].active && voices[0].note == note) {
@@ -1167,10 +1187,11 @@ void noteOff(int note) {
       ampEnv[0].noteOff();
       filtEnv[0].noteOff();
       
-      int nextNote = getTopMonoNote();
+      int nextNote = monoNotes.top();
       if (nextNote != -1) {
         // Play the next note in the stack WITH envelope retrigger (mono behavior)
         voices[0].note = nextNote;
+        voiceAllocator.voiceOn(0, nextNote);
         float baseFreq = 440.0 * pow(2.0, (nextNote - 69) / 12.0);
         float pitchWheelMultiplier = pow(2.0, pitchWheelValue * 2.0 / 12.0);
         
@@ -1190,24 +1211,30 @@ void noteOff(int note) {
         }
         
         // Retrigger envelopes for the next note (mono behavior)
+#ifdef USE_VOICE_SLEEP
+        wakeVoice(0);
+#endif
         ampEnv[0].noteOn();
         filtEnv[0].noteOn();
       } else {
         // No more notes - voice stays off
         voices[0].active = false;
+        voices[0].releaseTime = millis();
+        voiceAllocator.voiceOff(0);
       }
     }
   } 
   else if (playMode == 2) {
     // Legato mode - use note stack for proper priority
-    removeFromMonoStack(note);
+    monoNotes.remove(note);
     
     // If the released note was the currently playing note
     if (voices[0].active && voices[0].note == note) {
-      int nextNote = getTopMonoNote();
+      int nextNote = monoNotes.top();
       if (nextNote != -1) {
         // Play the next note in the stack without retriggering envelopes
         voices[0].note = nextNote;
+        voiceAllocator.voiceOn(0, nextNote);
         float baseFreq = 440.0 * pow(2.0, (nextNote - 69) / 12.0);
         float pitchWheelMultiplier = pow(2.0, pitchWheelValue * 2.0 / 12.0);
         
@@ -1230,17 +1257,20 @@ void noteOff(int note) {
         ampEnv[0].noteOff();
         filtEnv[0].noteOff();
         voices[0].active = false;
+        voices[0].releaseTime = millis();
+        voiceAllocator.voiceOff(0);
       }
     }
   } 
   else {
     // Poly mode - normal note off behavior
-    int voiceNum = findVoiceForNote(note);
+    int voiceNum = voiceAllocator.noteOff(note);
     if (voiceNum >= 0) {
       // Turn off envelopes
       ampEnv[voiceNum].noteOff();
       filtEnv[voiceNum].noteOff();
       voices[voiceNum].active = false;
+      voices[voiceNum].releaseTime = millis();
     }
   }
 }
@@ -1272,6 +1302,10 @@ void loop() {
   handleEncoder();
   updateLFOModulation();
   updateGlide();
+  updateVoiceStates();
+#ifdef USE_VOICE_SLEEP
+  sleepIdleVoices();
+#endif
   
   // Update display if parameter changed during this loop iteration
   if (parameterChanged) {
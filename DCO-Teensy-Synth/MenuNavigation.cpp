@@ -8,6 +8,7 @@
 #include <Arduino.h>
 #include <String.h>
 #include <Encoder.h>
+#include "EncoderBank.h"
 
 #ifdef USE_LCD_DISPLAY
   #include <LiquidCrystal_I2C.h>
@@ -57,7 +58,7 @@ const char* settingsMenuItems[] = {"Macro Knobs", "MIDI Channel", "< Back"};
 extern long encoderValues[];
 extern long lastEncoderValues[];
 extern Encoder menuEncoder;
-extern Encoder enc1, enc2, enc3, enc4, enc5, enc6, enc7, enc8, enc9, enc10, enc11, enc13, enc14, enc15, enc16, enc17, enc18, enc19, enc20;
+extern EncoderBank<20> encoderBank;
 extern void updateSynthParameter(int paramIndex, float val);
 extern int currentPreset;
 
@@ -36,6 +36,21 @@
 // #define USE_TEENSY_DAC        // Use Teensy Audio Shield or other I2S DAC
 #define USE_USB_AUDIO      // Use USB Audio output (default)
 
+// • VOICE SLEEP
+// Idle voices (amp envelope finished) are disconnected from the audio graph so their
+// oscillators, envelopes and filters stop rendering. Needs Teensyduino 1.54 or newer.
+#define USE_VOICE_SLEEP
+
+// • VOICE FILTER (Mini and MacroOSC)
+// Replaces each voice's float ladder filter and its DC + envelope control chain with one
+// fixed-point state variable filter that runs its envelope inline (Shared/VoiceFilter.h).
+// Far cheaper per voice, at 12 dB/oct instead of 24 and without self-oscillation.
+// #define USE_SVF_VOICE_FILTER
+
+// • ENCODER ACCELERATION
+// Fast knob turns move parameters 2x or 4x per detent. Comment out for one step per detent.
+#define USE_ENCODER_ACCELERATION
+
 // ============================================================================
 // Hardware Configuration - Multi-Teensy Standard Layout
 // ============================================================================
@@ -89,6 +104,15 @@
 #define ENC_20_CLK   40     // enc20 pins
 #define ENC_20_DT    39
 
+// Encoder bank pin tables ({CLK, DT} pairs in panel order; enc12 is the menu encoder)
+#define ENCODER_PINS_1_11  {ENC_1_CLK, ENC_1_DT}, {ENC_2_CLK, ENC_2_DT}, {ENC_3_CLK, ENC_3_DT}, \
+                           {ENC_4_CLK, ENC_4_DT}, {ENC_5_CLK, ENC_5_DT}, {ENC_6_CLK, ENC_6_DT}, \
+                           {ENC_7_CLK, ENC_7_DT}, {ENC_8_CLK, ENC_8_DT}, {ENC_9_CLK, ENC_9_DT}, \
+                           {ENC_10_CLK, ENC_10_DT}, {ENC_11_CLK, ENC_11_DT}
+#define ENCODER_PINS_13_20 {ENC_13_CLK, ENC_13_DT}, {ENC_14_CLK, ENC_14_DT}, {ENC_15_CLK, ENC_15_DT}, \
+                           {ENC_16_CLK, ENC_16_DT}, {ENC_17_CLK, ENC_17_DT}, {ENC_18_CLK, ENC_18_DT}, \
+                           {ENC_19_CLK, ENC_19_DT}, {ENC_20_CLK, ENC_20_DT}
+
 
 // Standard MIDI CCs (shared across all projects)
 #define CC_MODWHEEL      1    // Standard mod wheel
@@ -170,6 +194,12 @@
 // Menu Encoder Configuration
 #define MENU_ENCODER_PARAM  -1  // Menu-only mode
 
+// • ENGINE STATS
+// EPIANO_STATS_REPORT_MS prints the engine's counters to Serial (0 = off): renders that overran
+// the block time, renders dropped because the audio pool was empty, the longest render and the
+// peak audio memory use.
+#define EPIANO_STATS_REPORT_MS 0
+
 #endif // PROJECT_EPIANO
 
 #ifdef PROJECT_DCO
@@ -325,6 +355,61 @@
 // Menu Encoder Configuration
 #define MENU_ENCODER_PARAM  -1  // Algorithm
 
+// • DX7 PATCH LIBRARY
+// Extra banks are read from 32-voice .syx dumps in PATCH_LIBRARY_DIR and listed after the
+// built-in ROM banks. Voices stay packed on the card and are unpacked into a small cache.
+#define USE_PATCH_LIBRARY
+#define PATCH_LIBRARY_SD                         // Teensy 4.1 built-in SD slot; comment out for LittleFS
+#define PATCH_LIBRARY_FLASH_SIZE (1024 * 1024)   // LittleFS program flash reserved for banks
+#define PATCH_LIBRARY_DIR        "/dx7"
+#define PATCH_LIBRARY_MAX_BANKS  512             // index entries (32 bytes each, in RAM2)
+#define PATCH_CACHE_VOICES       8               // unpacked voices kept in RAM (156 bytes each)
+
+// • PROGRAM CHANGE
+// Notes held through a program change finish on the patch they started with while new notes
+// use the new one. Comment out to cut every note on a program change (classic Dexed behaviour).
+#define DEXED_KEEP_HELD_NOTES
+
+// • MULTITIMBRAL PARTS
+// 1 = classic single patch. With 2-4 parts every part has its own patch and MIDI channel and
+// they share the voice pool. Part 1 is the one the panel and menus edit; a program change on
+// another part's channel loads that part (bank * 32 + patch, as for part 1).
+#define DEXED_PARTS          1
+#define DEXED_PART_CHANNELS  { 1, 2, 3, 4 }
+
+// • STEREO
+// Voices are panned while they are mixed, so FM pads get width without a chorus.
+// DEXED_PAN_VOICE fans chords out by voice, DEXED_PAN_NOTE spreads low notes left and high
+// notes right. Comment out USE_DEXED_STEREO for the classic mono output on both channels.
+#define USE_DEXED_STEREO
+#define DEXED_PAN_MODE       DEXED_PAN_VOICE
+#define DEXED_STEREO_WIDTH   0.6   // 0.0 (mono) - 1.0 (hard left/right)
+
+// • UNISON
+// Every key plays DEXED_UNISON_VOICES detuned copies (1 = off, up to 4). The copies share one
+// set of envelopes, so the extra cost is the operator rendering only. In stereo they are pulled
+// apart by DEXED_UNISON_SPREAD either side of the voice.
+#define DEXED_UNISON_VOICES  1
+#define DEXED_UNISON_DETUNE  7     // cents either side, 0-50
+#define DEXED_UNISON_SPREAD  0.5   // 0.0 - 1.0
+
+// • EFFECTS BUS
+// Chorus -> delay -> reverb behind Dexed (needs Teensyduino 1.54+). Levels are set from the
+// Effects menu or the CCs below. An effect at level 0 is unplugged from the audio graph, so it
+// costs no CPU. FX_CPU_REPORT_MS prints each effect's CPU cost to Serial (0 = off).
+#define USE_FX_BUS
+#define FX_REVERB_TYPE       FX_REVERB_PLATE  // or FX_REVERB_PLATE_Q15 (int16 lines, RAM1; not yet timed on the board), FX_REVERB_FREEVERB
+#define FX_CHORUS_LEVEL      0.0   // 0.0 (bypassed) - 1.0
+#define FX_DELAY_LEVEL       0.0
+#define FX_REVERB_LEVEL      0.0
+#define FX_DELAY_MS          300   // each ms costs ~180 bytes of AudioMemory
+#define FX_DELAY_FEEDBACK    0.35
+#define FX_REVERB_SIZE       0.7
+#define CC_FX_CHORUS         93    // GM chorus send
+#define CC_FX_DELAY          94
+#define CC_FX_REVERB         91    // GM reverb send
+#define FX_CPU_REPORT_MS     0
+
 #endif // PROJECT_FM
 
 #ifdef PROJECT_MINI
@@ -471,7 +556,7 @@
 #define ENC_23_PARAM   -1   //
 
 //MacroOscillator (Braids) Parameters (22 total):
-// 0: Shape (0-42) - Braids synthesis algorithm
+// 0: Shape (0-46) - Braids synthesis algorithm
 // 1: Timbre (0-127) - Timbral control
 // 2: Color (0-127) - Color/tone control
 // 3: Coarse (±48 semitones) - Transpose
@@ -498,6 +583,43 @@
 // Menu Encoder Configuration
 #define MENU_ENCODER_PARAM  8  // Menu-only
 
+// • SHAPE CPU BUDGET
+// Every Braids shape has a known render cost per voice (ShapeCost.cpp, calibrated at boot).
+// Once the voices sounding would use more than BRAIDS_CPU_BUDGET percent of an audio block,
+// new notes steal instead of taking another voice, so heavy shapes play with fewer voices
+// rather than overloading. 0 = no limit. USE_SHAPE_BENCHMARK times every shape at boot
+// (about a second) and prints the cycle table to Serial.
+// Off by default: the shape weights were measured on a host, not on the board, and leave
+// out the sub-block stepping overhead. Set a budget once the board's USE_SHAPE_BENCHMARK
+// numbers have replaced the table in ShapeCost.cpp.
+#define BRAIDS_CPU_BUDGET    0
+// #define USE_SHAPE_BENCHMARK
+
+// • VOICE MODE
+// BRAIDS_VOICE_POLY gives every note its own oscillator, envelopes and ladder filter.
+// BRAIDS_VOICE_PARAPHONIC gives every note an oscillator but sums them into one shared
+// envelope and filter, which trigger on the first note held and release with the last.
+// BRAIDS_VOICE_UNISON stacks BRAIDS_UNISON_VOICES oscillators (2-6) on the last note held,
+// spread across BRAIDS_UNISON_DETUNE cents either side, through the same single chain.
+// BRAIDS_UNISON_SYNC above 0 hard-syncs the other unison oscillators to the first and
+// plays them that many semitones up (the classic sync sweep; shapes without a sync
+// input, such as the physical models, ignore it).
+// BRAIDS_VOICE_DRUMS plays the pads in DrumKit.cpp (General MIDI drum notes): each note
+// fires a one-shot hit with its own shape, tuning and decay, and the voice frees itself
+// once the hit has died away. Shape, timbre, color and the amp envelope are per pad.
+#define BRAIDS_VOICE_MODE    BRAIDS_VOICE_POLY
+#define BRAIDS_UNISON_VOICES 4
+#define BRAIDS_UNISON_DETUNE 10    // cents either side, 0-50
+#define BRAIDS_UNISON_SYNC   0     // semitones, 0 = no sync
+
+// • SHAPE GROUPS
+// Shape groups built into the firmware (BRAIDS_GROUP_* in src/shape_groups.h). A group left
+// out has its render code and wave tables dropped from flash; tools/braids_resources.py
+// reports what each one saves (WAVETABLE is the big one, 33 KB). Shapes built out still
+// show in the shape menu and still load from presets, and silently play as CSAW instead.
+// e.g. (BRAIDS_GROUP_ALL & ~BRAIDS_GROUP_WAVETABLE)
+#define BRAIDS_SHAPE_GROUPS  BRAIDS_GROUP_ALL
+
 #endif // PROJECT_MACRO
 
 // ============================================================================
@@ -445,7 +445,17 @@ void handleEncoder() {
   lastMenuButtonState = menuButtonPressed;
 }
 
-
+// Engine counters since boot: overruns, renders dropped for want of a block
+void printEngineStats() {
+  Serial.print("EPiano: xruns ");
+  Serial.print(ep.xrun);
+  Serial.print(", alloc fails ");
+  Serial.print(ep.alloc_fail);
+  Serial.print(", render max ");
+  Serial.print(ep.render_time_max);
+  Serial.print(" us, audio memory max ");
+  Serial.println(AudioMemoryUsageMax());
+}
 
 void loop() {
   // Handle USB Device MIDI
@@ -472,6 +482,14 @@ void loop() {
   
   readAllControls();
   handleEncoder();
+
+#if EPIANO_STATS_REPORT_MS > 0
+  static unsigned long lastStatsReport = 0;
+  if (millis() - lastStatsReport >= EPIANO_STATS_REPORT_MS) {
+    lastStatsReport = millis();
+    printEngineStats();
+  }
+#endif
   
   // Update display if parameter changed during this loop iteration
   if (parameterChanged) {
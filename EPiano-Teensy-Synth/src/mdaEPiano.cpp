@@ -423,6 +423,16 @@ FLASHMEM void mdaEPiano::process(int16_t* outputs_r, int16_t* outputs_l)
       voice[v] = voice[--activevoices];
 }
 
+void mdaEPiano::idle(void)  // no active voices: keep LFO running, skip rendering
+{
+  for (int16_t frame = 0; frame < AUDIO_BLOCK_SAMPLES; frame++)
+  {
+    lfo0 += dlfo * lfo1;
+    lfo1 -= dlfo * lfo0;
+  }
+  tl = tr = 0.0f; //treble filter tail is below SILENCE once the last voice is choked
+}
+
 FLASHMEM void mdaEPiano::noteOn(int32_t note, int32_t velocity)
 {
   float * param = programs[ 0].param;
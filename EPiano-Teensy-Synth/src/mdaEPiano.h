@@ -130,6 +130,7 @@ class mdaEPiano
 
   protected:
     void process(int16_t *outputs_r, int16_t *outputs_l);
+    void idle(void);
     void update();
     void fillpatch(int32_t p, char *name, float p0, float p1, float p2, float p3, float p4,
                    float p5, float p6, float p7, float p8, float p9, float p10, float p11);
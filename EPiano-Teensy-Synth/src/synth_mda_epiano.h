@@ -6,10 +6,15 @@
 #include <AudioStream.h>
 #include "mdaEPiano.h"
 
+#ifndef EPIANO_RESERVED_BLOCKS
+#define EPIANO_RESERVED_BLOCKS 2 // blocks held back from the pool so the engine can always render
+#endif
+
 class AudioSynthEPiano : public AudioStream, public mdaEPiano {
   public:
     const uint16_t audio_block_time_us = 1000000 / (AUDIO_SAMPLE_RATE / AUDIO_BLOCK_SAMPLES);
     uint32_t xrun = 0;
+    uint32_t alloc_fail = 0;
     uint16_t render_time_max = 0;
 
     AudioSynthEPiano(uint8_t nvoices) : AudioStream(0, NULL), mdaEPiano(nvoices) { };
@@ -24,15 +29,28 @@ class AudioSynthEPiano : public AudioStream, public mdaEPiano {
       else
         in_update = true;
 
+      // Nothing sounding: transmit nothing. Downstream objects receive NULL
+      // and treat it as a silent block, so an idle piano holds no audio
+      // memory beyond its EPIANO_RESERVED_BLOCKS reserve.
+      if (activevoices == 0)
+      {
+        idle();
+        in_update = false;
+        return;
+      }
+
       elapsedMicros render_time;
       audio_block_t *lblock;
       audio_block_t *rblock;
 
-      lblock = allocate();
-      rblock = allocate();
+      lblock = allocateBlock();
+      rblock = allocateBlock();
 
       if (!lblock || !rblock)
       {
+        alloc_fail++;
+        if (lblock) release(lblock);
+        if (rblock) release(rblock);
         in_update = false;
         return;
       }
@@ -50,9 +68,38 @@ class AudioSynthEPiano : public AudioStream, public mdaEPiano {
       release(lblock);
       release(rblock);
 
+      refillReserve();
+
       in_update = false;
     };
 
   private:
     volatile bool in_update = false;
+    audio_block_t *reserve[EPIANO_RESERVED_BLOCKS] = { NULL };
+    uint8_t reserved = 0;
+
+    // Take a block from the pool; if the pool is exhausted, hand one of our
+    // reserved blocks back to it so this allocation cannot fail.
+    audio_block_t *allocateBlock(void)
+    {
+      audio_block_t *block = allocate();
+      if (!block && reserved > 0)
+      {
+        release(reserve[--reserved]);
+        reserve[reserved] = NULL;
+        block = allocate();
+      }
+      return (block);
+    }
+
+    void refillReserve(void)
+    {
+      while (reserved < EPIANO_RESERVED_BLOCKS)
+      {
+        audio_block_t *block = allocate();
+        if (!block)
+          break;
+        reserve[reserved++] = block;
+      }
+    }
 };
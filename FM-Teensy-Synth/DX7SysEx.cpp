@@ -0,0 +1,192 @@
+#include "config.h"
+#include "DX7SysEx.h"
+#include "PatchLibrary.h"
+
+#define SYSEX_START 0xF0
+#define SYSEX_END 0xF7
+#define YAMAHA_ID 0x43
+
+#define DX7_VOICE_BYTES 155     // format 0, byte count 0x01 0x1B
+#define DX7_BANK_BYTES 4096     // format 9, byte count 0x20 0x00
+
+DX7SysEx::DX7SysEx(Dexed& synth)
+  : dexed(synth), deviceChannel(0), state(STATE_IDLE), kind(KIND_PARAMETER),
+    headerCount(0), dest(NULL), expected(0), received(0), sum(0),
+    checksumOk(false), parameter(0) {
+}
+
+DX7SysEx::Event DX7SysEx::feed(const uint8_t* data, uint16_t length) {
+  Event last = SYSEX_NONE;
+  for (uint16_t i = 0; i < length; i++) {
+    Event e = byte(data[i]);
+    if (e != SYSEX_NONE) last = e;
+  }
+  return last;
+}
+
+DX7SysEx::Event DX7SysEx::byte(uint8_t b) {
+  if (b >= 0xF8) return SYSEX_NONE; // real-time bytes may be interleaved anywhere
+
+  if (b == SYSEX_START) {
+    // A new message while one is still open means the old one was cut short
+    Event e = (state == STATE_IDLE || state == STATE_SKIP) ? SYSEX_NONE : abort();
+    state = STATE_HEADER;
+    headerCount = 0;
+    return e;
+  }
+
+  if (b == SYSEX_END) {
+    if (state == STATE_END) return finish();
+    if (state == STATE_IDLE || state == STATE_SKIP) {
+      state = STATE_IDLE;
+      return SYSEX_NONE;
+    }
+    return abort();
+  }
+
+  if (b & 0x80) {
+    // Any other status byte terminates SysEx
+    if (state == STATE_IDLE || state == STATE_SKIP) {
+      state = STATE_IDLE;
+      return SYSEX_NONE;
+    }
+    return abort();
+  }
+
+  switch (state) {
+    case STATE_HEADER:
+      return header(b);
+
+    case STATE_DATA:
+      dest[received++] = b;
+      sum += b;
+      if (received == expected) state = STATE_CHECKSUM;
+      return SYSEX_NONE;
+
+    case STATE_CHECKSUM:
+      checksumOk = ((uint8_t)(-sum) & 0x7F) == b;
+      state = STATE_END;
+      return SYSEX_NONE;
+
+    case STATE_END:
+      return abort(); // data where F7 should be
+
+    default:
+      return SYSEX_NONE;
+  }
+}
+
+DX7SysEx::Event DX7SysEx::header(uint8_t b) {
+  headerBytes[headerCount++] = b;
+
+  if (headerCount == 1 && b != YAMAHA_ID) {
+    state = STATE_SKIP;
+  } else if (headerCount == 2) {
+    uint8_t subStatus = b & 0x70;
+    uint8_t channel = (b & 0x0F) + 1;
+    if ((subStatus != 0x00 && subStatus != 0x10) ||
+        (deviceChannel != 0 && channel != deviceChannel)) {
+      state = STATE_SKIP;
+    }
+    kind = (subStatus == 0x10) ? KIND_PARAMETER : KIND_VOICE;
+  } else if (headerCount == 5) {
+    if (kind == KIND_PARAMETER) {
+      state = STATE_END; // gg pp vv collected
+      return SYSEX_NONE;
+    }
+
+    uint8_t format = headerBytes[2];
+    uint16_t count = (headerBytes[3] << 7) | headerBytes[4];
+    if (format == 0 && count == DX7_VOICE_BYTES) {
+      kind = KIND_VOICE;
+      dest = voice;
+    } else if (format == 9 && count == DX7_BANK_BYTES) {
+      kind = KIND_BANK;
+      dest = patchLibrary.beginReceivedBank();
+    } else {
+      state = STATE_SKIP;
+      return SYSEX_NONE;
+    }
+    expected = count;
+    received = 0;
+    sum = 0;
+    checksumOk = false;
+    state = STATE_DATA;
+  }
+  return SYSEX_NONE;
+}
+
+DX7SysEx::Event DX7SysEx::finish() {
+  state = STATE_IDLE;
+
+  switch (kind) {
+    case KIND_PARAMETER: {
+      uint8_t group = (headerBytes[2] & 0x7C) >> 2;
+      uint16_t address = headerBytes[3] + (headerBytes[2] & 0x03) * 128;
+      uint8_t value = headerBytes[4];
+      if (group == 0 && address < DX7_VOICE_BYTES) {
+        dexed.setVoiceDataElement(address, PatchLibrary::clampVoiceByte(address, value));
+      } else if (group == 0 && address == DX7_VOICE_BYTES) {
+        dexed.setOPAll(value);
+      } else if (group == 2 && address >= 64 && address <= 77) {
+        applyFunctionParameter(address, value);
+        address += 256;
+      } else {
+        return SYSEX_NONE; // valid, but nothing we map
+      }
+      parameter = address;
+      return SYSEX_PARAMETER;
+    }
+
+    case KIND_VOICE:
+      if (!checksumOk) {
+        Serial.println("SysEx: voice checksum error");
+        return SYSEX_ERROR;
+      }
+      // A valid checksum still lets any 7-bit value through
+      for (int i = 0; i < DX7_VOICE_BYTES; i++) {
+        voice[i] = PatchLibrary::clampVoiceByte(i, voice[i]);
+      }
+      dexed.loadVoiceParameters(voice);
+      return SYSEX_VOICE;
+
+    case KIND_BANK:
+      if (!checksumOk) {
+        patchLibrary.discardReceivedBank();
+        Serial.println("SysEx: bank checksum error");
+        return SYSEX_ERROR;
+      }
+      patchLibrary.commitReceivedBank();
+      return SYSEX_BANK;
+  }
+  return SYSEX_NONE;
+}
+
+DX7SysEx::Event DX7SysEx::abort() {
+  if (state != STATE_HEADER && kind == KIND_BANK) {
+    patchLibrary.discardReceivedBank();
+  }
+  state = STATE_IDLE;
+  Serial.println("SysEx: message truncated");
+  return SYSEX_ERROR;
+}
+
+// DX7 function parameters 64-77
+void DX7SysEx::applyFunctionParameter(uint8_t number, uint8_t value) {
+  switch (number) {
+    case 64: dexed.setMonoMode(value != 0); break;
+    case 65: dexed.setPitchbendRange(value); break;
+    case 66: dexed.setPitchbendStep(value); break;
+    case 67: dexed.setPortamentoMode(value); break;
+    case 68: dexed.setPortamentoGlissando(value); break;
+    case 69: dexed.setPortamentoTime(value); break;
+    case 70: dexed.setModWheelRange(value); break;
+    case 71: dexed.setModWheelTarget(value); break;
+    case 72: dexed.setFootControllerRange(value); break;
+    case 73: dexed.setFootControllerTarget(value); break;
+    case 74: dexed.setBreathControllerRange(value); break;
+    case 75: dexed.setBreathControllerTarget(value); break;
+    case 76: dexed.setAftertouchRange(value); break;
+    case 77: dexed.setAftertouchTarget(value); break;
+  }
+}
@@ -0,0 +1,84 @@
+#ifndef DX7_SYSEX_H
+#define DX7_SYSEX_H
+
+#include "config.h"
+#include <Arduino.h>
+#include "src/Synth_Dexed/dexed.h"
+
+// ============================================================================
+// DX7 SysEx Receiver
+// ============================================================================
+// Incremental parser for Yamaha DX7 system exclusive messages. Bytes can be
+// fed in whatever chunks the MIDI transport delivers them (USB device, USB
+// host or DIN); nothing waits for the complete message:
+//   - parameter changes (F0 43 1n gg pp vv F7) are applied the moment they
+//     end, voice parameters through Dexed::setVoiceDataElement
+//   - single voices (163 bytes) are checksummed on the fly and loaded into
+//     Dexed once the checksum and F7 arrive
+//   - 32-voice bulk dumps (4104 bytes) are streamed straight into the patch
+//     library's received-bank slot and only listed once they check out, so
+//     the 4 KB of voice data is never held twice
+
+class DX7SysEx {
+public:
+  enum Event {
+    SYSEX_NONE,          // nothing finished in this chunk
+    SYSEX_PARAMETER,     // voice or function parameter changed
+    SYSEX_VOICE,         // single voice loaded into Dexed
+    SYSEX_BANK,          // 32-voice bank received
+    SYSEX_ERROR          // bad checksum, truncated or malformed message
+  };
+
+  DX7SysEx(Dexed& synth);
+
+  // Device channel: 0 = omni, 1-16 only accept messages for that channel
+  void setChannel(uint8_t channel) { deviceChannel = channel; }
+
+  // Feed the next chunk of a SysEx stream. Returns the last event completed
+  // within the chunk.
+  Event feed(const uint8_t* data, uint16_t length);
+
+  // Last parameter changed: 0-155 voice address, or 256 + function number (64-77)
+  uint16_t lastParameter() const { return parameter; }
+
+private:
+  enum State {
+    STATE_IDLE,          // waiting for F0
+    STATE_HEADER,        // manufacturer, sub-status and format/group bytes
+    STATE_DATA,          // voice or bank data, summed as it arrives
+    STATE_CHECKSUM,
+    STATE_END,           // waiting for F7
+    STATE_SKIP           // not ours, drop everything up to F7
+  };
+
+  enum Kind {
+    KIND_PARAMETER,
+    KIND_VOICE,
+    KIND_BANK
+  };
+
+  Event byte(uint8_t b);
+  Event header(uint8_t b);
+  Event finish();
+  Event abort();
+  void applyFunctionParameter(uint8_t number, uint8_t value);
+
+  Dexed& dexed;
+  uint8_t deviceChannel;
+
+  State state;
+  Kind kind;
+  uint8_t headerBytes[5];
+  uint8_t headerCount;
+
+  uint8_t* dest;             // where data bytes go (voice buffer or bank slot)
+  uint16_t expected;
+  uint16_t received;
+  uint8_t sum;
+  bool checksumOk;
+
+  uint16_t parameter;
+  uint8_t voice[155];
+};
+
+#endif // DX7_SYSEX_H
@@ -10,6 +10,7 @@
 
 #include "config.h"
 #include "MenuNavigation.h"
+#include "EncoderBank.h"
 
 // Project strings
 const char* PROJECT_NAME = "FM Synth";
@@ -23,6 +24,11 @@ const char* PROJECT_SUBTITLE = "Frequency Modulation";
 #define DX7_IMPLEMENTATION
 #include "src/Synth_Dexed/synth_dexed.h"
 #include "roms_unpacked.h"
+#include "PatchLibrary.h"
+#include "DX7SysEx.h"
+#ifdef USE_FX_BUS
+#include "FXBus.h"
+#endif
 
 #ifdef USE_LCD_DISPLAY
   #include <LiquidCrystal_I2C.h>
@@ -47,26 +53,11 @@ MIDIDevice midi1(myusb);
 MIDI_CREATE_INSTANCE(HardwareSerial, Serial1, MIDI);
 #endif
 
-// All 19 Mini-Teensy Encoders (using configurable pin definitions from config.h)
-Encoder enc1(ENC_1_CLK, ENC_1_DT);
-Encoder enc2(ENC_2_CLK, ENC_2_DT);
-Encoder enc3(ENC_3_CLK, ENC_3_DT);
-Encoder enc4(ENC_4_CLK, ENC_4_DT);
-Encoder enc5(ENC_5_CLK, ENC_5_DT);
-Encoder enc6(ENC_6_CLK, ENC_6_DT);
-Encoder enc7(ENC_7_CLK, ENC_7_DT);
-Encoder enc8(ENC_8_CLK, ENC_8_DT);
-Encoder enc9(ENC_9_CLK, ENC_9_DT);
-Encoder enc10(ENC_10_CLK, ENC_10_DT);
-Encoder enc11(ENC_11_CLK, ENC_11_DT);
-Encoder enc13(ENC_13_CLK, ENC_13_DT);  
-Encoder enc14(ENC_14_CLK, ENC_14_DT);
-Encoder enc15(ENC_15_CLK, ENC_15_DT);
-Encoder enc16(ENC_16_CLK, ENC_16_DT);
-Encoder enc17(ENC_17_CLK, ENC_17_DT);
-Encoder enc18(ENC_18_CLK, ENC_18_DT);
-Encoder enc19(ENC_19_CLK, ENC_19_DT);
-Encoder enc20(ENC_20_CLK, ENC_20_DT);
+// All 19 panel encoders, built from the config.h pin tables and indexed like encoderMapping
+const EncoderPins encoderPins[19] = {
+  ENCODER_PINS_1_11, ENCODER_PINS_13_20
+};
+EncoderBank<19> encoderBank;
 Encoder menuEncoder(MENU_ENCODER_DT, MENU_ENCODER_CLK);
 
 // Configurable encoder to parameter mapping (defined in config.h)
@@ -82,9 +73,10 @@ long encoderValues[19] = {0};
 long lastEncoderValues[19] = {0};
 
 int currentPreset = 0;  // Currently loaded preset (0-31)
-int currentBank = 0;    // Currently loaded bank (0-7)
+int currentBank = 0;    // Currently loaded bank (ROM banks first, then card banks)
 int BankIndex = 0;      // Bank browser index
 int PatchIndex = 0;     // Patch browser index
+PatchLibrary patchLibrary;
 
 // Default parameter values for FM synthesis (0.0-1.0 normalized)
 float allParameterValues[NUM_PARAMETERS] = {
@@ -103,6 +95,12 @@ float allParameterValues[NUM_PARAMETERS] = {
 // FM synthesis objects
 AudioSynthDexed       dexed(VOICES, AUDIO_SAMPLE_RATE); 
 
+// Between dexed and the outputs: objects update in declaration order, so
+// declared after the outputs the bus would reach them a block late
+#ifdef USE_FX_BUS
+FXBus fxBus;                           // chorus -> delay -> reverb, patched in behind dexed
+#endif
+
 #ifdef USE_USB_AUDIO
 AudioOutputUSB        usb1;            // USB audio output (stereo)
 #endif
@@ -113,14 +111,26 @@ AudioControlSGTL5000  sgtl5000_1;
 #endif
 
 // Audio connections
+#ifdef USE_FX_BUS
+#ifdef USE_USB_AUDIO
+AudioConnection patchCord1(fxBus.outL, 0, usb1, 0); // Left channel
+AudioConnection patchCord2(fxBus.outR, 0, usb1, 1); // Right channel
+#endif
+
+#ifdef USE_TEENSY_DAC
+AudioConnection patchCord3(fxBus.outL, 0, i2s1, 0); // Left channel
+AudioConnection patchCord4(fxBus.outR, 0, i2s1, 1); // Right channel
+#endif
+#else
 #ifdef USE_USB_AUDIO
 AudioConnection patchCord1(dexed, 0, usb1, 0); // Left channel
-AudioConnection patchCord2(dexed, 0, usb1, 1); // Right channel (mono to stereo)
+AudioConnection patchCord2(dexed, 1, usb1, 1); // Right channel (same as left in mono)
 #endif
 
 #ifdef USE_TEENSY_DAC
 AudioConnection patchCord3(dexed, 0, i2s1, 0); // Left channel
-AudioConnection patchCord4(dexed, 0, i2s1, 1); // Right channel (mono to stereo)
+AudioConnection patchCord4(dexed, 1, i2s1, 1); // Right channel (same as left in mono)
+#endif
 #endif
 
 // Control parameter names for menu display
@@ -155,10 +165,51 @@ float lastChangedValue = 0.0;
 String lastChangedName = "";
 bool parameterChanged = false;
 
+// DX7 SysEx reception (bulk dumps, single voices, live parameter edits)
+DX7SysEx sysexReceiver(dexed);
+bool sysexEdited = false;  // voice changed by SysEx, encoders need a resync
+
 
 
 
+#if DEXED_PARTS > 1
+const uint8_t partChannels[DEXED_MAX_PARTS] = DEXED_PART_CHANNELS;
+
+// Load a program into one of the extra parts without moving the panel off part 1
+void loadPartProgram(uint8_t part, int program) {
+  const uint8_t* voiceData = patchLibrary.voice(program / 32, program % 32);
+  if (voiceData == NULL) return;
+  dexed.setEditPart(part);
+  dexed.loadVoiceParameters(voiceData);
+  dexed.setEditPart(0);
+}
+#endif
+
 void processMidiMessage(byte type, byte channel, byte data1, byte data2) {
+#if DEXED_PARTS > 1
+  // Notes go to every part on this channel; program changes on the channels
+  // of parts 2-4 load those parts
+  switch (type) {
+    case 0x90:
+    case 0x80:
+      if (type == 0x90 && data2 > 0) {
+        dexed.midiNoteOn(channel, data1, data2);
+      } else {
+        dexed.midiNoteOff(channel, data1);
+      }
+      return;
+
+    case 0xC0:
+      for (uint8_t part = 1; part < DEXED_PARTS; part++) {
+        if (partChannels[part] == channel) {
+          loadPartProgram(part, data1);
+          return;
+        }
+      }
+      break;
+  }
+#endif
+
   // Filter by MIDI channel (0 = omni, 1-16 = specific channel)
   if (midiChannel != 0 && channel != midiChannel) return;
   
@@ -210,6 +261,22 @@ void handleControlChange(int cc, int value) {
     return;
   }
   
+#ifdef USE_FX_BUS
+  // Effect levels; 0 takes the effect out of the audio graph
+  int fx = -1;
+  if (cc == CC_FX_CHORUS) fx = FXBus::FX_CHORUS;
+  else if (cc == CC_FX_DELAY) fx = FXBus::FX_DELAY;
+  else if (cc == CC_FX_REVERB) fx = FXBus::FX_REVERB;
+  if (fx >= 0) {
+    fxBus.setLevel((FXBus::Effect)fx, paramValue);
+    lastChangedParam = -1;
+    lastChangedName = FXBus::name((FXBus::Effect)fx);
+    lastChangedValue = value;
+    parameterChanged = true;
+    return;
+  }
+#endif
+
   // Handle FM parameter CCs
   int paramIndex = -1;
   
@@ -252,11 +319,11 @@ void handleProgramChange(int program) {
   // Only accept valid program change values (0-255 for 8 banks * 32 patches)
   if (program < 0 || program > 255) return; // Ignore out-of-range program changes
   
-  int bankIndex = program / 32;    // 8 banks available (0-7)
+  int bankIndex = program / 32;    // 32 patches per bank
   int patchIndex = program % 32;   // 32 patches per bank (0-31)
   
   // Ensure we don't exceed available banks
-  if (bankIndex >= 8) return; // Only banks 0-7 available
+  if (bankIndex >= patchLibrary.bankCount()) return;
   
   // Set the bank and load the patch
   currentBank = bankIndex;
@@ -269,25 +336,56 @@ void handleProgramChange(int program) {
   Serial.println(patchIndex);
   
   // Update display to show preset name
-  String line1 = String(BankNames[currentBank]);
+  String line1 = String(patchLibrary.bankName(currentBank));
   
-  // Extract patch name for display
   char voice_name[11];
-  memset(voice_name, 0, 11);
-  memcpy(voice_name, &progmem_bank[currentBank][patchIndex][144], 10);
-  // Clean up non-printable characters
-  for (int i = 0; i < 10; i++) {
-    if (voice_name[i] < 32 || voice_name[i] > 126) voice_name[i] = ' ';
-  }
-  String line2 = String(patchIndex + 1) + ". " + String(voice_name).trim();
+  patchLibrary.voiceName(currentBank, patchIndex, voice_name);
+  String line2 = String(patchIndex + 1) + ". " + String(voice_name);
   displayText(line1, line2);
 }
 
+// SysEx arrives in transport-sized chunks; the receiver tracks message
+// boundaries itself, so the complete flag is not needed
+void handleSysExChunk(const uint8_t* data, uint16_t length, bool complete) {
+  (void)complete;
+  sysexReceiver.setChannel(midiChannel);
+
+  switch (sysexReceiver.feed(data, length)) {
+    case DX7SysEx::SYSEX_PARAMETER:
+      sysexEdited = true;
+      break;
+
+    case DX7SysEx::SYSEX_VOICE: {
+      sysexEdited = true;
+      char voice_name[11];
+      dexed.getName(voice_name);
+      displayText("SysEx Voice", String(voice_name));
+      break;
+    }
+
+    case DX7SysEx::SYSEX_BANK:
+      displayText("SysEx Bank", "32 voices in");
+      Serial.println("SysEx: 32-voice bank received");
+      break;
+
+    case DX7SysEx::SYSEX_ERROR:
+      displayText("SysEx", "Receive error");
+      break;
+
+    default:
+      break;
+  }
+}
+
 void setup() {
   Serial.begin(115200);
   
   // Audio setup
+#ifdef USE_FX_BUS
+  AudioMemory(40 + FX_AUDIO_MEMORY); // the delay lines live in audio blocks
+#else
   AudioMemory(40);
+#endif
   
 #ifdef USE_TEENSY_DAC
   sgtl5000_1.enable();
@@ -295,8 +393,13 @@ void setup() {
   Serial.println("Teensy Audio Shield initialized");
 #endif
 
+#ifdef USE_USB_DEVICE_MIDI
+  usbMIDI.setHandleSystemExclusive(handleSysExChunk);
+#endif
+
 #ifdef USE_MIDI_HOST
   myusb.begin();
+  midi1.setHandleSystemExclusive(handleSysExChunk);
   Serial.println("USB Host MIDI initialized");
 #endif
 
@@ -319,10 +422,23 @@ void setup() {
     byte data2 = (bend >> 7) & 0x7F; // MSB
     processMidiMessage(0xE0, channel, data1, data2);
   });
+  MIDI.setHandleSystemExclusive([](byte* data, unsigned size) {
+    // Dumps longer than the library's SysEx buffer come in pieces: follow-on
+    // pieces start with F7 and all but the last end with F0. Strip those
+    // markers so the receiver sees one continuous message.
+    if (size > 1 && data[0] == 0xF7) { data++; size--; }
+    if (size > 1 && data[size - 1] == 0xF0) size--;
+    handleSysExChunk(data, size, true);
+  });
   Serial.println("DIN MIDI initialized");
 #endif
   
   pinMode(MENU_ENCODER_SW, INPUT_PULLUP);
+
+  encoderBank.begin(encoderPins);
+#ifdef USE_ENCODER_ACCELERATION
+  encoderBank.setAcceleration(true);
+#endif
   
   // Initialize encoder values
   for (int i = 0; i < 19; i++) {
@@ -331,18 +447,47 @@ void setup() {
   }
   
   dexed.setEngineType(0); // MSFA engine (warmest, no pops)
+#ifdef DEXED_KEEP_HELD_NOTES
+  dexed.setKeepHeldNotes(true);
+#endif
+#ifdef USE_DEXED_STEREO
+  dexed.setPanMode(DEXED_PAN_MODE);
+  dexed.setStereoWidth(DEXED_STEREO_WIDTH);
+  dexed.setStereo(true);
+#endif
+  dexed.setUnison(DEXED_UNISON_VOICES, DEXED_UNISON_DETUNE);
+  dexed.setUnisonSpread(DEXED_UNISON_SPREAD);
   dexed.loadInitVoice();
   dexed.setTranspose(12); // Center at middle C
+
+#ifdef USE_FX_BUS
+  fxBus.begin(dexed);
+  fxBus.setLevel(FXBus::FX_CHORUS, FX_CHORUS_LEVEL);
+  fxBus.setLevel(FXBus::FX_DELAY, FX_DELAY_LEVEL);
+  fxBus.setLevel(FXBus::FX_REVERB, FX_REVERB_LEVEL);
+#endif
   
   // Initialize FM parameters
   for (int i = 0; i < NUM_PARAMETERS; i++) {
     updateSynthParameter(i, allParameterValues[i]);
   }
 
+  // Index the DX7 banks on the SD card / flash (ROM banks are always available)
+  patchLibrary.begin();
+
   // Load first preset from ROM (bank 0, patch 0)
   currentBank = 0;
   currentPreset = 0;
   loadPreset(0);
+
+#if DEXED_PARTS > 1
+  // Extra parts start on the next ROM patches
+  dexed.setParts(DEXED_PARTS);
+  for (uint8_t part = 0; part < DEXED_PARTS; part++) {
+    dexed.setPartChannel(part, partChannels[part]);
+    if (part > 0) loadPartProgram(part, part);
+  }
+#endif
   
   delay(100);
   
@@ -382,49 +527,30 @@ void setup() {
   Serial.println(" Ready!");
 }
 
-void readDirectEncoders() {
-  encoderValues[0] = enc1.read() / 4;   // enc1
-  encoderValues[1] = enc2.read() / 4;   // enc2
-  encoderValues[2] = enc3.read() / 4;   // enc3
-  encoderValues[3] = enc4.read() / 4;   // enc4
-  encoderValues[4] = enc5.read() / 4;   // enc5
-  encoderValues[5] = enc6.read() / 4;   // enc6
-  encoderValues[6] = enc7.read() / 4;   // enc7
-  encoderValues[7] = enc8.read() / 4;   // enc8
-  encoderValues[8] = enc9.read() / 4;   // enc9
-  encoderValues[9] = enc10.read() / 4;  // enc10
-  encoderValues[10] = enc11.read() / 4; // enc11
-  encoderValues[11] = enc13.read() / 4; // enc13 (note: no enc12)
-  encoderValues[12] = enc14.read() / 4; // enc14
-  encoderValues[13] = enc15.read() / 4; // enc15
-  encoderValues[14] = enc16.read() / 4; // enc16
-  encoderValues[15] = enc17.read() / 4; // enc17
-  encoderValues[16] = enc18.read() / 4; // enc18
-  encoderValues[17] = enc19.read() / 4; // enc19
-  encoderValues[18] = enc20.read() / 4; // enc20
-}
-
 void readAllControls() {
-  readDirectEncoders();
-  
-  // Check for encoder changes and update parameters using configurable mapping
-  for (int i = 0; i < 19; i++) {
-    if (encoderValues[i] != lastEncoderValues[i]) {
-      // If any physical knob is turned, exit menu mode
-      if (inMenu) {
-        inMenu = false;
-      }
-      
-      int change = encoderValues[i] - lastEncoderValues[i];
-      int paramIndex = encoderMapping[i]; // Use configurable mapping
-      
-      // Only update if encoder is mapped to a valid parameter (not -1 for disabled)
-      if (paramIndex >= 0 && paramIndex < NUM_PARAMETERS) {
-        updateEncoderParameter(paramIndex, change);
-      }
-      
-      lastEncoderValues[i] = encoderValues[i];
+  // Only visit the encoders the bank saw move
+  uint32_t moved = encoderBank.takeDirty();
+  while (moved) {
+    int i = __builtin_ctz(moved);
+    moved &= moved - 1;
+
+    int change = encoderBank.change(i);
+    if (change == 0) continue; // turned less than a detent
+    encoderValues[i] = encoderBank.read(i);
+
+    // If any physical knob is turned, exit menu mode
+    if (inMenu) {
+      inMenu = false;
+    }
+
+    int paramIndex = encoderMapping[i]; // Use configurable mapping
+
+    // Only update if encoder is mapped to a valid parameter (not -1 for disabled)
+    if (paramIndex >= 0 && paramIndex < NUM_PARAMETERS) {
+      updateEncoderParameter(paramIndex, change);
     }
+
+    lastEncoderValues[i] = encoderValues[i];
   }
   
   // Handle menu encoder parameter control (if configured)
@@ -484,16 +610,15 @@ void updateSynthParameter(int paramIndex, float val) {
 void loadPreset(int presetNum) {
   presetNum = constrain(presetNum, 0, 31);
   currentPreset = presetNum;
-  dexed.loadVoiceParameters(progmem_bank[currentBank][presetNum]);
+  const uint8_t* voiceData = patchLibrary.voice(currentBank, presetNum);
+  if (voiceData == NULL) {
+    Serial.println("Patch could not be read");
+    return;
+  }
+  dexed.loadVoiceParameters(voiceData);
   
-  // Extract patch name for display
   char voice_name[11];
-  memset(voice_name, 0, 11);
-  memcpy(voice_name, &progmem_bank[currentBank][presetNum][144], 10);
-  // Clean up non-printable characters
-  for (int i = 0; i < 10; i++) {
-    if (voice_name[i] < 32 || voice_name[i] > 126) voice_name[i] = ' ';
-  }
+  patchLibrary.voiceName(currentBank, presetNum, voice_name);
   Serial.println(voice_name);
   
   // Sync encoder positions to match loaded preset values
@@ -516,52 +641,31 @@ void syncEncodersToPreset() {
   allParameterValues[8] = dexed.getOPOutputLevel(4) / 99.0f;   // OP5 Output Level (0-99)
   allParameterValues[9] = dexed.getOPOutputLevel(5) / 99.0f;   // OP6 Output Level (0-99)
   
-  // Now sync encoder positions to the updated parameter values
+  // Now sync encoder positions to the updated parameter values in one batch
+  long positions[19];
   for (int i = 0; i < 19; i++) {
+    positions[i] = encoderBank.read(i); // unmapped encoders keep their position
     int paramIndex = encoderMapping[i];
     if (paramIndex >= 0 && paramIndex < NUM_PARAMETERS) {
-      // Convert parameter value (0.0-1.0) to encoder position
+      // Convert parameter value (0.0-1.0) to encoder detents
       float paramValue = allParameterValues[paramIndex];
-      long newEncoderPosition;
       
       // Scale encoder position based on parameter type
       if (paramIndex == 0) {
         // Algorithm: 0-31 (32 steps)
-        newEncoderPosition = (long)(paramValue * 31.0f) * 4;
+        positions[i] = (long)(paramValue * 31.0f);
       } else if (paramIndex == 1) {
         // Feedback: 0-7 (8 steps) 
-        newEncoderPosition = (long)(paramValue * 7.0f) * 4;
+        positions[i] = (long)(paramValue * 7.0f);
       } else {
         // Other parameters: 0-127 equivalent
-        newEncoderPosition = (long)(paramValue * 127.0f) * 4;
+        positions[i] = (long)(paramValue * 127.0f);
       }
-      
-      // Update encoder position to match parameter value
-      switch(i) {
-        case 0: enc1.write(newEncoderPosition); break;
-        case 1: enc2.write(newEncoderPosition); break;
-        case 2: enc3.write(newEncoderPosition); break;
-        case 3: enc4.write(newEncoderPosition); break;
-        case 4: enc5.write(newEncoderPosition); break;
-        case 5: enc6.write(newEncoderPosition); break;
-        case 6: enc7.write(newEncoderPosition); break;
-        case 7: enc8.write(newEncoderPosition); break;
-        case 8: enc9.write(newEncoderPosition); break;
-        case 9: enc10.write(newEncoderPosition); break;
-        case 10: enc11.write(newEncoderPosition); break;
-        case 11: enc13.write(newEncoderPosition); break;
-        case 12: enc14.write(newEncoderPosition); break;
-        case 13: enc15.write(newEncoderPosition); break;
-        case 14: enc16.write(newEncoderPosition); break;
-        case 15: enc17.write(newEncoderPosition); break;
-        case 16: enc18.write(newEncoderPosition); break;
-        case 17: enc19.write(newEncoderPosition); break;
-        case 18: enc20.write(newEncoderPosition); break;
-      }
-      encoderValues[i] = newEncoderPosition / 4;
-      lastEncoderValues[i] = encoderValues[i];
+      encoderValues[i] = positions[i];
+      lastEncoderValues[i] = positions[i];
     }
   }
+  encoderBank.sync(positions);
 }
 
 void loop() {
@@ -581,12 +685,36 @@ void loop() {
   }
 #endif
   
-#ifdef ENABLE_DIN_MIDI
+#ifdef USE_DIN_MIDI
   MIDI.read();
 #endif
+
+  // Coalesce a burst of SysEx edits into one encoder resync
+  if (sysexEdited) {
+    sysexEdited = false;
+    syncEncodersToPreset();
+  }
   
   readAllControls();
   handleEncoder();
+
+#ifdef USE_FX_BUS
+  fxBus.update();
+
+  // Keep the FX CPU page live
+  static unsigned long lastFxDisplay = 0;
+  if (inMenu && currentMenuState == EFFECT_CPU && millis() - lastFxDisplay >= 500) {
+    lastFxDisplay = millis();
+    updateDisplay();
+  }
+#if FX_CPU_REPORT_MS > 0
+  static unsigned long lastFxReport = 0;
+  if (millis() - lastFxReport >= FX_CPU_REPORT_MS) {
+    lastFxReport = millis();
+    fxBus.printUsage();
+  }
+#endif
+#endif
   
   // Update display if parameter changed during this loop iteration
   if (parameterChanged) {
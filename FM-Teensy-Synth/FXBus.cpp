@@ -0,0 +1,281 @@
+#include "config.h"
+#include "FXBus.h"
+
+#define FX_CHORUS_SAMPLES (FX_CHORUS_DELAY_MS * 45 * 2)  // modulated delay sits mid-line
+
+// Time a muted stage is left running before it is unplugged
+#define FX_DELAY_DRAIN_MS (FX_DELAY_MS + 20)
+#if FX_REVERB_TYPE == FX_REVERB_FREEVERB
+#define FX_REVERB_DRAIN_MS 2500      // let the comb tails ring out
+#else
+#define FX_REVERB_DRAIN_MS 20        // bypass clears the plate on its first block
+#endif
+
+static DMAMEM int16_t chorusLine[2][FX_CHORUS_SAMPLES];
+
+static const char* const effectNames[FXBus::FX_COUNT] = { "Chorus", "Delay", "Reverb" };
+
+FXBus::FXBus() : source(NULL), wired(0), draining(0), numCords(0) {
+  for (int i = 0; i < FX_COUNT; i++) {
+    levels[i] = 0.0f;
+    drainStart[i] = 0;
+  }
+}
+
+void FXBus::begin(AudioStream& src) {
+  source = &src;
+
+  chorusLfo.frequency(FX_CHORUS_RATE);
+  chorusLfo.amplitude(FX_CHORUS_DEPTH);
+
+  delayL.delay(0, FX_DELAY_MS);
+  delayR.delay(0, FX_DELAY_MS);
+
+#if FX_REVERB_TYPE == FX_REVERB_FREEVERB
+  reverb.roomsize(FX_REVERB_SIZE);
+  reverb.damping(FX_REVERB_DAMPING);
+#else
+  reverb.size(FX_REVERB_SIZE);
+  reverb.hidamp(FX_REVERB_DAMPING);
+  reverb.lodamp(0.0f);
+  reverb.lowpass(0.7f);
+  reverb.diffusion(0.65f);
+#endif
+
+  applyGains();
+  rebuild();
+}
+
+const char* FXBus::name(Effect fx) {
+  return effectNames[fx];
+}
+
+void FXBus::setLevel(Effect fx, float level) {
+  level = constrain(level, 0.0f, 1.0f);
+  levels[fx] = level;
+  uint8_t bit = 1 << fx;
+
+  if (level > 0.0f) {
+    draining &= ~bit;
+    if (!(wired & bit)) {
+      // Start from a clean line; nothing runs it while it is unplugged
+      if (fx == FX_CHORUS) chorus.begin(chorusLine[0], chorusLine[1], FX_CHORUS_SAMPLES);
+      wired |= bit;
+      applyGains();
+      rebuild();
+      return;
+    }
+  } else if (wired & bit) {
+    if (fx == FX_CHORUS) {
+      // No tail worth keeping, unplug straight away
+      wired &= ~bit;
+      applyGains();
+      rebuild();
+      return;
+    }
+    // Mute the feed and the return, unplug once the tail has drained
+    draining |= bit;
+    drainStart[fx] = millis();
+  }
+  applyGains();
+}
+
+void FXBus::update() {
+  if (!draining) return;
+
+  uint32_t now = millis();
+  uint8_t done = 0;
+  if ((draining & (1 << FX_DELAY)) && now - drainStart[FX_DELAY] >= FX_DELAY_DRAIN_MS) {
+    done |= 1 << FX_DELAY;
+  }
+  if ((draining & (1 << FX_REVERB)) && now - drainStart[FX_REVERB] >= FX_REVERB_DRAIN_MS) {
+    done |= 1 << FX_REVERB;
+  }
+  if (!done) return;
+
+  draining &= ~done;
+  wired &= ~done;
+  applyGains();
+  rebuild();
+}
+
+// Mixer gains follow the levels; a draining stage gets no input and no return
+void FXBus::applyGains() {
+  float chorus = levels[FX_CHORUS];
+  chorusMixL.gain(0, 1.0f - 0.5f * chorus);
+  chorusMixL.gain(1, 0.5f * chorus);
+  chorusMixR.gain(0, 1.0f - 0.5f * chorus);
+  chorusMixR.gain(1, 0.5f * chorus);
+
+  bool delayOn = !(draining & (1 << FX_DELAY));
+  delayFeedL.gain(0, delayOn ? 1.0f : 0.0f);
+  delayFeedL.gain(1, delayOn ? FX_DELAY_FEEDBACK : 0.0f);
+  delayFeedR.gain(0, delayOn ? 1.0f : 0.0f);
+  delayFeedR.gain(1, delayOn ? FX_DELAY_FEEDBACK : 0.0f);
+  delayMixL.gain(0, 1.0f);
+  delayMixL.gain(1, levels[FX_DELAY]);
+  delayMixR.gain(0, 1.0f);
+  delayMixR.gain(1, levels[FX_DELAY]);
+
+  bool reverbOn = !(draining & (1 << FX_REVERB));
+#if FX_REVERB_TYPE == FX_REVERB_FREEVERB
+  reverbSum.gain(0, reverbOn ? 0.5f : 0.0f);
+  reverbSum.gain(1, reverbOn ? 0.5f : 0.0f);
+#else
+  reverb.set_bypass(!reverbOn);
+#endif
+  outL.gain(0, 1.0f);
+  outL.gain(1, levels[FX_REVERB]);
+  outR.gain(0, 1.0f);
+  outR.gain(1, levels[FX_REVERB]);
+}
+
+void FXBus::connect(AudioStream& src, uint8_t srcOut, AudioStream& dst, uint8_t dstIn) {
+  if (numCords < FX_MAX_CORDS) cords[numCords++].connect(src, srcOut, dst, dstIn);
+}
+
+// Re-patch the whole chain with only the wired stages in it. Objects left
+// without connections go inactive and drop out of the audio update.
+void FXBus::rebuild() {
+  if (source == NULL) return;
+
+  AudioNoInterrupts();
+  for (uint8_t i = 0; i < numCords; i++) cords[i].disconnect();
+  numCords = 0;
+
+  AudioStream* left = source;
+  AudioStream* right = source;
+  uint8_t leftOut = 0;
+  uint8_t rightOut = 1;
+
+  if (wired & (1 << FX_CHORUS)) {
+    connect(chorusLfo, 0, chorus, 2);
+    connect(*left, leftOut, chorus, 0);
+    connect(*right, rightOut, chorus, 1);
+    connect(*left, leftOut, chorusMixL, 0);
+    connect(chorus, 0, chorusMixL, 1);
+    connect(*right, rightOut, chorusMixR, 0);
+    connect(chorus, 1, chorusMixR, 1);
+    left = &chorusMixL;
+    right = &chorusMixR;
+    leftOut = rightOut = 0;
+  }
+
+  if (wired & (1 << FX_DELAY)) {
+    connect(*left, leftOut, delayFeedL, 0);
+    connect(delayL, 0, delayFeedL, 1);
+    connect(delayFeedL, 0, delayL, 0);
+    connect(*left, leftOut, delayMixL, 0);
+    connect(delayL, 0, delayMixL, 1);
+    connect(*right, rightOut, delayFeedR, 0);
+    connect(delayR, 0, delayFeedR, 1);
+    connect(delayFeedR, 0, delayR, 0);
+    connect(*right, rightOut, delayMixR, 0);
+    connect(delayR, 0, delayMixR, 1);
+    left = &delayMixL;
+    right = &delayMixR;
+    leftOut = rightOut = 0;
+  }
+
+  connect(*left, leftOut, outL, 0);
+  connect(*right, rightOut, outR, 0);
+
+  if (wired & (1 << FX_REVERB)) {
+#if FX_REVERB_TYPE == FX_REVERB_FREEVERB
+    connect(*left, leftOut, reverbSum, 0);
+    connect(*right, rightOut, reverbSum, 1);
+    connect(reverbSum, 0, reverb, 0);
+#else
+    connect(*left, leftOut, reverb, 0);
+    connect(*right, rightOut, reverb, 1);
+#endif
+    connect(reverb, 0, outL, 1);
+    connect(reverb, 1, outR, 1);
+  }
+  AudioInterrupts();
+}
+
+float FXBus::stageUsage(Effect fx, bool worst) {
+  if (!(wired & (1 << fx))) return 0.0f;
+
+  AudioStream* stage[6];
+  uint8_t count = 0;
+  switch (fx) {
+    case FX_CHORUS:
+      stage[count++] = &chorusLfo;
+      stage[count++] = &chorus;
+      stage[count++] = &chorusMixL;
+      stage[count++] = &chorusMixR;
+      break;
+    case FX_DELAY:
+      stage[count++] = &delayFeedL;
+      stage[count++] = &delayL;
+      stage[count++] = &delayFeedR;
+      stage[count++] = &delayR;
+      stage[count++] = &delayMixL;
+      stage[count++] = &delayMixR;
+      break;
+    default:
+#if FX_REVERB_TYPE == FX_REVERB_FREEVERB
+      stage[count++] = &reverbSum;
+#endif
+      stage[count++] = &reverb;
+      break;
+  }
+
+  float total = 0.0f;
+  for (uint8_t i = 0; i < count; i++) {
+    total += worst ? stage[i]->processorUsageMax() : stage[i]->processorUsage();
+  }
+  return total;
+}
+
+float FXBus::usage(Effect fx) {
+  return stageUsage(fx, false);
+}
+
+float FXBus::usageMax(Effect fx) {
+  return stageUsage(fx, true);
+}
+
+void FXBus::resetUsage() {
+  AudioStream* all[] = { &chorusLfo, &chorus, &chorusMixL, &chorusMixR,
+                         &delayFeedL, &delayFeedR, &delayL, &delayR, &delayMixL, &delayMixR,
+#if FX_REVERB_TYPE == FX_REVERB_FREEVERB
+                         &reverbSum,
+#endif
+                         &reverb, &outL, &outR };
+  for (uint8_t i = 0; i < sizeof(all) / sizeof(all[0]); i++) all[i]->processorUsageMaxReset();
+  AudioProcessorUsageMaxReset();
+}
+
+void FXBus::printUsage() {
+  // Cycles per audio block, from the percentage the library keeps
+  const float cyclesPerPercent = F_CPU_ACTUAL / (AUDIO_SAMPLE_RATE_EXACT / AUDIO_BLOCK_SAMPLES) / 100.0f;
+
+  Serial.println("FX bus CPU (% now / max, cycles per block):");
+  for (int fx = 0; fx < FX_COUNT; fx++) {
+    float now = usage((Effect)fx);
+    Serial.print("  ");
+    Serial.print(effectNames[fx]);
+    if (!(wired & (1 << fx))) {
+      Serial.println(": bypassed");
+      continue;
+    }
+    Serial.print(": ");
+    Serial.print(now, 2);
+    Serial.print(" / ");
+    Serial.print(usageMax((Effect)fx), 2);
+    Serial.print("  ");
+    Serial.print((uint32_t)(now * cyclesPerPercent));
+    Serial.println(draining & (1 << fx) ? " (draining)" : "");
+  }
+  if (source) {
+    Serial.print("  Source: ");
+    Serial.print(source->processorUsage(), 2);
+    Serial.print("  Audio total: ");
+    Serial.print(AudioProcessorUsage(), 2);
+    Serial.print(" / ");
+    Serial.println(AudioProcessorUsageMax(), 2);
+  }
+}
@@ -0,0 +1,129 @@
+#ifndef FX_BUS_H
+#define FX_BUS_H
+
+#include "config.h"
+#include <Arduino.h>
+#include <Audio.h>
+#include "src/Synth_Dexed/effect_modulated_delay.h"
+#include "src/Synth_Dexed/effect_platervbstereo.h"
+#include "src/Synth_Dexed/effect_platervbstereo_q15.h"
+#include "src/Synth_Dexed/effect_freeverbf.h"
+
+// ============================================================================
+// FM Effects Bus
+// ============================================================================
+// Chorus -> delay -> reverb behind Dexed. It uses the effects bundled with
+// Synth_Dexed (modulated delay, plate reverb in float or fixed point, or
+// freeverb) plus the Teensy Audio delay. An effect is only patched into the
+// graph while its level is above zero. A bypassed effect has no connections,
+// so the audio library never runs its update() and it costs nothing. The
+// delay and reverb hold a tail, so they are muted first and unplugged once it
+// has died away; they come back silent.
+//
+// The patching uses AudioConnection::connect()/disconnect() (Teensyduino 1.54+).
+
+#define FX_REVERB_PLATE     0
+#define FX_REVERB_FREEVERB  1
+#define FX_REVERB_PLATE_Q15 2      // same plate, int16 lines in RAM1
+
+#ifndef FX_REVERB_TYPE
+#define FX_REVERB_TYPE FX_REVERB_PLATE
+#endif
+#ifndef FX_CHORUS_DELAY_MS
+#define FX_CHORUS_DELAY_MS 15      // centre of the modulated delay
+#endif
+#ifndef FX_CHORUS_RATE
+#define FX_CHORUS_RATE 0.6         // Hz
+#endif
+#ifndef FX_CHORUS_DEPTH
+#define FX_CHORUS_DEPTH 0.3        // share of the delay swept by the LFO
+#endif
+#ifndef FX_DELAY_MS
+#define FX_DELAY_MS 300
+#endif
+#ifndef FX_DELAY_FEEDBACK
+#define FX_DELAY_FEEDBACK 0.35
+#endif
+#ifndef FX_REVERB_SIZE
+#define FX_REVERB_SIZE 0.7
+#endif
+#ifndef FX_REVERB_DAMPING
+#define FX_REVERB_DAMPING 0.5
+#endif
+
+// Audio blocks held by the two delay lines, to add to AudioMemory()
+#define FX_AUDIO_MEMORY (2 * ((FX_DELAY_MS * 45) / AUDIO_BLOCK_SAMPLES + 2))
+
+#define FX_MAX_CORDS 24
+
+class FXBus {
+public:
+  enum Effect {
+    FX_CHORUS,
+    FX_DELAY,
+    FX_REVERB,
+    FX_COUNT
+  };
+
+  FXBus();
+
+  // Patch the bus in behind a stereo source (outputs 0 and 1)
+  void begin(AudioStream& source);
+
+  // Wet level 0.0-1.0; 0 bypasses the effect and takes it out of the graph
+  void setLevel(Effect fx, float level);
+  float getLevel(Effect fx) const { return levels[fx]; }
+
+  // Unplug muted effects once their tail has drained; call from loop()
+  void update();
+
+  // CPU use of one effect in percent, as AudioProcessorUsage() reports it,
+  // and the worst seen since resetUsage(). Unplugged effects report 0.
+  float usage(Effect fx);
+  float usageMax(Effect fx);
+  void resetUsage();
+
+  // Per-effect cost next to the source and the whole audio graph
+  void printUsage();
+
+  static const char* name(Effect fx);
+
+private:
+  void rebuild();
+  void connect(AudioStream& src, uint8_t srcOut, AudioStream& dst, uint8_t dstIn);
+  void applyGains();
+  float stageUsage(Effect fx, bool worst);
+
+  AudioStream* source;
+  float levels[FX_COUNT];
+  uint8_t wired;                  // effects patched into the graph, one bit each
+  uint8_t draining;               // muted, waiting for the tail to die away
+  uint32_t drainStart[FX_COUNT];
+
+  // Declared in signal order: the audio library runs objects in construction
+  // order, so each stage sees this block's output of the one before
+  AudioSynthWaveformSine chorusLfo;
+  AudioEffectModulatedDelayStereo chorus;
+  AudioMixer4 chorusMixL, chorusMixR;
+  AudioMixer4 delayFeedL, delayFeedR;
+  AudioEffectDelay delayL, delayR;
+  AudioMixer4 delayMixL, delayMixR;
+#if FX_REVERB_TYPE == FX_REVERB_FREEVERB
+  AudioMixer4 reverbSum;
+  AudioEffectFreeverbStereoFloat reverb;
+#elif FX_REVERB_TYPE == FX_REVERB_PLATE_Q15
+  AudioEffectPlateReverbQ15 reverb;
+#else
+  AudioEffectPlateReverb reverb;
+#endif
+
+  AudioConnection cords[FX_MAX_CORDS];
+  uint8_t numCords;
+
+public:
+  // Bus outputs (dry path plus reverb return), to patch into the outputs
+  AudioMixer4 outL;
+  AudioMixer4 outR;
+};
+
+#endif // FX_BUS_H
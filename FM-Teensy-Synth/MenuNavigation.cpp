@@ -5,10 +5,14 @@
 #define VOICES 16
 
 #include "MenuNavigation.h"
-#include "roms_unpacked.h"
+#include "PatchLibrary.h"
 #include <Arduino.h>
 #include <String.h>
 #include <Encoder.h>
+#include "EncoderBank.h"
+#ifdef USE_FX_BUS
+#include "FXBus.h"
+#endif
 
 #ifdef USE_LCD_DISPLAY
   #include <LiquidCrystal_I2C.h>
@@ -39,19 +43,37 @@ extern int currentBank;
 extern int BankIndex;
 extern int PatchIndex;
 
+#ifdef USE_FX_BUS
+const char* parentMenuItems[] = {"Presets", "Parameters", "Settings", "Effects", "< Exit"};
+const char* effectsMenuItems[] = {"Chorus", "Delay", "Reverb", "FX CPU", "< Back"};
+#define PARENT_MENU_LAST 4
+extern FXBus fxBus;
+#else
 const char* parentMenuItems[] = {"Presets", "Parameters", "Settings", "< Exit"};
+#define PARENT_MENU_LAST 3
+#endif
 const char* fmMenuItems[] = {"Algorithm", "Feedback", "LFO Speed", "Master Vol", "OP1 Level", "OP2 Level", "OP3 Level", "OP4 Level", "OP5 Level", "OP6 Level", "< Back"};
 const char* settingsMenuItems[] = {"MIDI Channel", "< Back"};
 
 extern long encoderValues[];
 extern long lastEncoderValues[];
 extern Encoder menuEncoder;
-extern Encoder enc1, enc2, enc3, enc4, enc5, enc6, enc7, enc8, enc9, enc10, enc11, enc13, enc14, enc15, enc16, enc17, enc18, enc19, enc20;
+extern EncoderBank<19> encoderBank;
 extern void updateSynthParameter(int paramIndex, float val);
 extern const int encoderMapping[19];
 
-extern const char* BankNames[8];
-extern uint8_t progmem_bank[8][32][156];
+
+#ifdef USE_FX_BUS
+// Effect edited by a menu state, or -1
+static int effectForState(MenuState state) {
+  switch (state) {
+    case EFFECT_CHORUS: return FXBus::FX_CHORUS;
+    case EFFECT_DELAY: return FXBus::FX_DELAY;
+    case EFFECT_REVERB: return FXBus::FX_REVERB;
+    default: return -1;
+  }
+}
+#endif
 
 void displayText(String line1, String line2) {
 #ifdef USE_LCD_DISPLAY
@@ -89,26 +111,21 @@ void updateDisplay() {
     if (currentMenuState == BANKS) {
       // Bank selection menu
       line1 = "Banks";
-      if (BankIndex < NUM_BANKS) {
-        line2 = String(BankIndex + 1) + ". " + String(BankNames[BankIndex]);
+      if (BankIndex < patchLibrary.bankCount()) {
+        line2 = String(BankIndex + 1) + ". " + String(patchLibrary.bankName(BankIndex));
       } else {
         line2 = "< Back";
       }
     } else if (currentMenuState == PATCHES) {
       // Patch selection menu
-      line1 = String(BankNames[currentBank]) + " Patches";
+      line1 = String(patchLibrary.bankName(currentBank)) + " Patches";
       if (PatchIndex == 32) {
         line2 = "< Back";
       } else {
-        // Extract and display patch name being browsed
+        // Display patch name being browsed
         char voice_name[11];
-        memset(voice_name, 0, 11);
-        memcpy(voice_name, &progmem_bank[currentBank][PatchIndex][144], 10);
-        // Clean up non-printable characters
-        for (int i = 0; i < 10; i++) {
-          if (voice_name[i] < 32 || voice_name[i] > 126) voice_name[i] = ' ';
-        }
-        line2 = String(PatchIndex + 1) + ". " + String(voice_name).trim();
+        patchLibrary.voiceName(currentBank, PatchIndex, voice_name);
+        line2 = String(PatchIndex + 1) + ". " + String(voice_name);
       }
     } else {
       switch(currentMenuState) {
@@ -128,6 +145,28 @@ void updateDisplay() {
           line1 = "MIDI Channel:";
           line2 = (midiChannel == 0) ? "Omni" : String(midiChannel);
           break;
+#ifdef USE_FX_BUS
+        case EFFECTS_MENU:
+          line1 = "Effects";
+          line2 = effectsMenuItems[menuIndex];
+          break;
+        case EFFECT_CHORUS:
+        case EFFECT_DELAY:
+        case EFFECT_REVERB:
+          {
+            FXBus::Effect fx = (FXBus::Effect)effectForState(currentMenuState);
+            line1 = FXBus::name(fx);
+            int percent = (int)(fxBus.getLevel(fx) * 100 + 0.5f);
+            line2 = (percent == 0) ? "Off" : String(percent) + "%";
+          }
+          break;
+        case EFFECT_CPU:
+          line1 = "FX CPU %";
+          line2 = "C" + String(fxBus.usage(FXBus::FX_CHORUS), 1) +
+                  " D" + String(fxBus.usage(FXBus::FX_DELAY), 1) +
+                  " R" + String(fxBus.usage(FXBus::FX_REVERB), 1);
+          break;
+#endif
         default:
           {
             int paramIndex = getParameterIndex(currentMenuState);
@@ -197,13 +236,14 @@ void handleEncoder() {
     
     if (inMenu) {
       if (currentMenuState == BANKS) {
-        // Navigate banks (0 to NUM_BANKS-1, then Back)
+        // Navigate banks (0 to bankCount-1, then Back)
+        int numBanks = patchLibrary.bankCount();
         if (newMenuValue > oldMenuValue) {
           BankIndex++;
-          if (BankIndex > NUM_BANKS) BankIndex = 0; // 0 to NUM_BANKS-1, then Back
+          if (BankIndex > numBanks) BankIndex = 0; // 0 to bankCount-1, then Back
         } else {
           BankIndex--;
-          if (BankIndex < 0) BankIndex = NUM_BANKS;
+          if (BankIndex < 0) BankIndex = numBanks;
         }
         updateDisplay();
       } else if (currentMenuState == PATCHES) {
@@ -216,6 +256,16 @@ void handleEncoder() {
           if (PatchIndex < 0) PatchIndex = 32;
         }
         updateDisplay();
+#ifdef USE_FX_BUS
+      } else if (effectForState(currentMenuState) >= 0) {
+        // Effect level in 2% steps; turning it down to 0 bypasses the effect
+        FXBus::Effect fx = (FXBus::Effect)effectForState(currentMenuState);
+        float step = (newMenuValue > oldMenuValue) ? 0.02f : -0.02f;
+        fxBus.setLevel(fx, fxBus.getLevel(fx) + step);
+        updateDisplay();
+      } else if (currentMenuState == EFFECT_CPU) {
+        updateDisplay();
+#endif
       } else if (getParameterIndex(currentMenuState) >= 0) {
         int paramIndex = getParameterIndex(currentMenuState);
         float increment = 1.0/128.0; // Standard increment
@@ -273,7 +323,7 @@ void handleEncoder() {
             printCurrentPresetValues();
       updateDisplay();
     } else if (currentMenuState == BANKS) {
-      if (BankIndex == NUM_BANKS) {
+      if (BankIndex == patchLibrary.bankCount()) {
         // Back button pressed
         currentMenuState = PARENT_MENU;
         menuIndex = 0; // Return to Presets position
@@ -294,6 +344,11 @@ void handleEncoder() {
       }
       updateDisplay();
     } else {
+#ifdef USE_FX_BUS
+      if (effectForState(currentMenuState) >= 0 || currentMenuState == EFFECT_CPU) {
+        backMenuAction();
+      } else
+#endif
       if (getParameterIndex(currentMenuState) >= 0) {
         backMenuAction();
       } else {
@@ -316,7 +371,10 @@ void navigateMenuForward() {
       }
       else if (menuIndex == 1) currentMenuState = FM_MENU;
       else if (menuIndex == 2) currentMenuState = SETTINGS;
-      else if (menuIndex == 3) {
+#ifdef USE_FX_BUS
+      else if (menuIndex == 3) currentMenuState = EFFECTS_MENU;
+#endif
+      else if (menuIndex == PARENT_MENU_LAST) {
         inMenu = false;
         return;
       }
@@ -347,6 +405,22 @@ void navigateMenuForward() {
         return;
       }
       break;
+#ifdef USE_FX_BUS
+    case EFFECTS_MENU:
+      if (menuIndex == 0) currentMenuState = EFFECT_CHORUS;
+      else if (menuIndex == 1) currentMenuState = EFFECT_DELAY;
+      else if (menuIndex == 2) currentMenuState = EFFECT_REVERB;
+      else if (menuIndex == 3) {
+        currentMenuState = EFFECT_CPU;
+        fxBus.printUsage();
+      }
+      else if (menuIndex == 4) {
+        currentMenuState = PARENT_MENU;
+        menuIndex = 3;
+        return;
+      }
+      break;
+#endif
     default:
       break;
   }
@@ -356,7 +430,7 @@ void incrementMenuIndex() {
   switch(currentMenuState) {
     case PARENT_MENU:
       menuIndex++;
-      if (menuIndex > 3) menuIndex = 0; // FM parent menu: Presets, Parameters, Settings, Exit
+      if (menuIndex > PARENT_MENU_LAST) menuIndex = 0; // FM parent menu: Presets, Parameters, Settings, (Effects,) Exit
       break;
     case BANKS:
     case PATCHES:
@@ -370,6 +444,12 @@ void incrementMenuIndex() {
       menuIndex++;
       if (menuIndex > 1) menuIndex = 0; // Settings has 2 items (0-1) including Back
       break;
+#ifdef USE_FX_BUS
+    case EFFECTS_MENU:
+      menuIndex++;
+      if (menuIndex > 4) menuIndex = 0; // Effects has 5 items (0-4) including Back
+      break;
+#endif
     default:
       break;
   }
@@ -379,7 +459,7 @@ void decrementMenuIndex() {
   switch(currentMenuState) {
     case PARENT_MENU:
       menuIndex--;
-      if (menuIndex < 0) menuIndex = 3; // FM parent menu: Presets, Parameters, Settings, Exit
+      if (menuIndex < 0) menuIndex = PARENT_MENU_LAST; // FM parent menu: Presets, Parameters, Settings, (Effects,) Exit
       break;
     case BANKS:
     case PATCHES:
@@ -393,6 +473,12 @@ void decrementMenuIndex() {
       menuIndex--;
       if (menuIndex < 0) menuIndex = 1; // Settings has 2 items (0-1) including Back
       break;
+#ifdef USE_FX_BUS
+    case EFFECTS_MENU:
+      menuIndex--;
+      if (menuIndex < 0) menuIndex = 4; // Effects has 5 items (0-4) including Back
+      break;
+#endif
     default:
       break;
   }
@@ -408,6 +494,12 @@ void navigateMenuBackward() {
       currentMenuState = PARENT_MENU;
       menuIndex = 2; // SETTINGS position
       break;
+#ifdef USE_FX_BUS
+    case EFFECTS_MENU:
+      currentMenuState = PARENT_MENU;
+      menuIndex = 3; // EFFECTS_MENU position
+      break;
+#endif
     default:
       break;
   }
@@ -454,6 +546,15 @@ void backMenuAction() {
       currentMenuState = SETTINGS;
       menuIndex = 0;
       break;
+#ifdef USE_FX_BUS
+    case EFFECT_CHORUS:
+    case EFFECT_DELAY:
+    case EFFECT_REVERB:
+    case EFFECT_CPU:
+      menuIndex = (int)currentMenuState - (int)EFFECT_CHORUS;
+      currentMenuState = EFFECTS_MENU;
+      break;
+#endif
     default:
       navigateMenuBackward();
       break;
@@ -538,37 +639,20 @@ void updateEncoderParameter(int paramIndex, int change) {
 
 
 void resetEncoderBaselines() {
+  long positions[19];
   for (int i = 0; i < 19; i++) {
+    positions[i] = encoderBank.read(i); // unmapped encoders keep their position
     int paramIndex = encoderMapping[i]; // Use configurable mapping
     
     // Only reset encoders that are mapped to valid parameters
     if (paramIndex >= 0 && paramIndex < NUM_PARAMETERS) {
       long targetEncoderValue = (long)(allParameterValues[paramIndex] * 100);
-      switch(i) {
-        case 0: enc1.write(targetEncoderValue * 4); break;
-        case 1: enc2.write(targetEncoderValue * 4); break;
-        case 2: enc3.write(targetEncoderValue * 4); break;
-        case 3: enc4.write(targetEncoderValue * 4); break;
-        case 4: enc5.write(targetEncoderValue * 4); break;
-        case 5: enc6.write(targetEncoderValue * 4); break;
-        case 6: enc7.write(targetEncoderValue * 4); break;
-        case 7: enc8.write(targetEncoderValue * 4); break;
-        case 8: enc9.write(targetEncoderValue * 4); break;
-        case 9: enc10.write(targetEncoderValue * 4); break;
-        case 10: enc11.write(targetEncoderValue * 4); break;
-        case 11: enc13.write(targetEncoderValue * 4); break;
-        case 12: enc14.write(targetEncoderValue * 4); break;
-        case 13: enc15.write(targetEncoderValue * 4); break;
-        case 14: enc16.write(targetEncoderValue * 4); break;
-        case 15: enc17.write(targetEncoderValue * 4); break;
-        case 16: enc18.write(targetEncoderValue * 4); break;
-        case 17: enc19.write(targetEncoderValue * 4); break;
-        case 18: enc20.write(targetEncoderValue * 4); break;
-      }
+      positions[i] = targetEncoderValue;
       encoderValues[i] = targetEncoderValue;
       lastEncoderValues[i] = targetEncoderValue;
     }
   }
+  encoderBank.sync(positions);
 }
 
 void updateParameterFromMenu(int paramIndex, float val) {
@@ -31,7 +31,14 @@ enum MenuState {
   FM_OP6_LEVEL,
   
   // Settings sub-menus
-  MIDI_CHANNEL
+  MIDI_CHANNEL,
+
+  // Effects bus sub-menus
+  EFFECTS_MENU,
+  EFFECT_CHORUS,
+  EFFECT_DELAY,
+  EFFECT_REVERB,
+  EFFECT_CPU
 };
 
 // ============================================================================
@@ -79,7 +86,6 @@ void resetEncoderBaselines();
 extern int currentBank;    
 extern int BankIndex;      
 extern int PatchIndex;     // Patch browser index (0-32)
-extern const char* BankNames[];   // Bank names (size determined by sysex2c.py)
 
 extern void loadPreset(int presetIndex);
 void printCurrentPresetValues();
@@ -0,0 +1,265 @@
+#include "config.h"
+#include "PatchLibrary.h"
+#include "roms_unpacked.h"
+#include "src/Synth_Dexed/dexed.h"
+
+#ifdef USE_PATCH_LIBRARY
+  #ifdef PATCH_LIBRARY_SD
+    #include <SD.h>
+    #define PATCH_FS SD
+  #else
+    #include <LittleFS.h>
+    static LittleFS_Program patchFlash;
+    #define PATCH_FS patchFlash
+  #endif
+#endif
+
+#define SYX_BULK_SIZE 4104   // F0 43 0n 09 20 00, 4096 data bytes, checksum, F7
+#define SYX_RAW_SIZE 4096    // bare packed voice data
+
+struct PatchBankEntry {
+  char file[PATCH_FILE_NAME_LENGTH];
+  uint8_t dataOffset;        // 6 for a bulk dump, 0 for raw voice data
+};
+
+// The index lives in RAM2 so it doesn't compete with voices and audio blocks
+static DMAMEM PatchBankEntry bankIndex[PATCH_LIBRARY_MAX_BANKS];
+static DMAMEM uint8_t receivedData[32 * PATCH_PACKED_SIZE];
+
+// Highest legal value of every unpacked voice byte (same table as sysex/sysex2c.py)
+static const uint8_t voiceMax[PATCH_VOICE_SIZE] = {
+  99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 3, 3, 7, 3, 7, 99, 1, 31, 99, 14,  // OP6
+  99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 3, 3, 7, 3, 7, 99, 1, 31, 99, 14,  // OP5
+  99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 3, 3, 7, 3, 7, 99, 1, 31, 99, 14,  // OP4
+  99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 3, 3, 7, 3, 7, 99, 1, 31, 99, 14,  // OP3
+  99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 3, 3, 7, 3, 7, 99, 1, 31, 99, 14,  // OP2
+  99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 3, 3, 7, 3, 7, 99, 1, 31, 99, 14,  // OP1
+  99, 99, 99, 99, 99, 99, 99, 99,                                                // Pitch EG
+  31, 7, 1, 99, 99, 99, 99, 1, 5, 7, 48,                                         // Algorithm ... transpose
+  126, 126, 126, 126, 126, 126, 126, 126, 126, 126,                              // Name
+  127                                                                            // Operator enable
+};
+
+static void cleanName(char* name, const uint8_t* raw) {
+  for (int i = 0; i < 10; i++) {
+    char c = (char)raw[i];
+    name[i] = (c < 32 || c > 126) ? ' ' : c;
+  }
+  name[10] = '\0';
+  for (int i = 9; i >= 0 && name[i] == ' '; i--) name[i] = '\0';
+}
+
+#ifdef USE_PATCH_LIBRARY
+static bool isSyxName(const char* name) {
+  size_t len = strlen(name);
+  return len > 4 && strcasecmp(name + len - 4, ".syx") == 0;
+}
+
+static int compareBanks(const void* a, const void* b) {
+  return strcasecmp(((const PatchBankEntry*)a)->file, ((const PatchBankEntry*)b)->file);
+}
+#endif
+
+PatchLibrary::PatchLibrary() : fileBanks(0), hasReceivedBank(false), useCounter(0), hits(0), misses(0), namesBank(-1) {
+  for (int i = 0; i < PATCH_CACHE_VOICES; i++) {
+    cache[i].bank = -1;
+    cache[i].patch = 0;
+    cache[i].lastUse = 0;
+  }
+  bankNameBuffer[0] = '\0';
+}
+
+void PatchLibrary::begin() {
+#ifdef USE_PATCH_LIBRARY
+  fileBanks = 0;
+
+#ifdef PATCH_LIBRARY_SD
+  if (!SD.begin(BUILTIN_SDCARD)) {
+    Serial.println("Patch library: no SD card, ROM banks only");
+    return;
+  }
+#else
+  if (!patchFlash.begin(PATCH_LIBRARY_FLASH_SIZE)) {
+    Serial.println("Patch library: LittleFS mount failed, ROM banks only");
+    return;
+  }
+#endif
+
+  File dir = PATCH_FS.open(PATCH_LIBRARY_DIR);
+  if (!dir || !dir.isDirectory()) {
+    Serial.println("Patch library: " PATCH_LIBRARY_DIR " not found, ROM banks only");
+    return;
+  }
+
+  while (fileBanks < PATCH_LIBRARY_MAX_BANKS) {
+    File f = dir.openNextFile();
+    if (!f) break;
+
+    const char* name = f.name();
+    uint32_t size = f.size();
+    if (f.isDirectory() || !isSyxName(name) || strlen(name) >= PATCH_FILE_NAME_LENGTH) {
+      f.close();
+      continue;
+    }
+
+    // Accept 32-voice bulk dumps and bare 4096-byte voice data
+    uint8_t offset;
+    if (size == SYX_BULK_SIZE) {
+      uint8_t header[6];
+      if (f.read(header, 6) != 6 || header[0] != 0xF0 || header[1] != 0x43 || header[3] != 0x09) {
+        f.close();
+        continue;
+      }
+      offset = 6;
+    } else if (size == SYX_RAW_SIZE) {
+      offset = 0;
+    } else {
+      f.close();
+      continue;
+    }
+
+    strcpy(bankIndex[fileBanks].file, name);
+    bankIndex[fileBanks].dataOffset = offset;
+    fileBanks++;
+    f.close();
+  }
+  dir.close();
+
+  qsort(bankIndex, fileBanks, sizeof(PatchBankEntry), compareBanks);
+
+  Serial.print("Patch library: ");
+  Serial.print(fileBanks);
+  Serial.println(" banks indexed from " PATCH_LIBRARY_DIR);
+#endif
+}
+
+int PatchLibrary::bankCount() const {
+  return NUM_BANKS + fileBanks + (hasReceivedBank ? 1 : 0);
+}
+
+const char* PatchLibrary::bankName(int bank) {
+  if (bank < NUM_BANKS) return BankNames[bank];
+  if (bank >= bankCount()) return "";
+  if (bank == NUM_BANKS + fileBanks) return "SysEx In";
+
+  strcpy(bankNameBuffer, bankIndex[bank - NUM_BANKS].file);
+  bankNameBuffer[strlen(bankNameBuffer) - 4] = '\0'; // drop ".syx"
+  return bankNameBuffer;
+}
+
+void PatchLibrary::voiceName(int bank, int patch, char* name) {
+  name[0] = '\0';
+  if (bank < 0 || bank >= bankCount() || patch < 0 || patch > 31) return;
+
+  if (bank < NUM_BANKS) {
+    cleanName(name, &progmem_bank[bank][patch][145]);
+    return;
+  }
+
+  if (namesBank != bank) loadVoiceNames(bank);
+  memcpy(name, names[patch], 11);
+}
+
+const uint8_t* PatchLibrary::voice(int bank, int patch) {
+  if (bank < 0 || bank >= bankCount() || patch < 0 || patch > 31) return NULL;
+  if (bank < NUM_BANKS) return progmem_bank[bank][patch];
+
+  // Cached? Otherwise evict the least recently used slot
+  int slot = 0;
+  for (int i = 0; i < PATCH_CACHE_VOICES; i++) {
+    if (cache[i].bank == bank && cache[i].patch == patch) {
+      cache[i].lastUse = ++useCounter;
+      hits++;
+      return cache[i].data;
+    }
+    if (cache[i].bank < 0 || cache[i].lastUse < cache[slot].lastUse) slot = i;
+  }
+
+  uint8_t packed[PATCH_PACKED_SIZE];
+  if (!readPacked(bank, patch, 0, packed, PATCH_PACKED_SIZE)) return NULL;
+  misses++;
+
+  CachedVoice& entry = cache[slot];
+  Dexed::unpackVoice(entry.data, packed);
+  entry.data[PATCH_VOICE_SIZE - 1] = 0x3F; // all operators on
+  for (int i = 0; i < PATCH_VOICE_SIZE; i++) {
+    entry.data[i] = clampVoiceByte(i, entry.data[i]);
+  }
+  entry.bank = bank;
+  entry.patch = patch;
+  entry.lastUse = ++useCounter;
+  return entry.data;
+}
+
+uint8_t PatchLibrary::clampVoiceByte(uint16_t address, uint8_t value) {
+  if (address >= PATCH_VOICE_SIZE) return value;
+  return value > voiceMax[address] ? voiceMax[address] : value;
+}
+
+// patch < 0 reads the same span from all 32 voices into consecutive slots of dest
+bool PatchLibrary::readPacked(int bank, int patch, uint16_t offset, uint8_t* dest, uint16_t length) {
+  int first = (patch < 0) ? 0 : patch;
+  int last = (patch < 0) ? 31 : patch;
+
+  if (bank == NUM_BANKS + fileBanks) {
+    for (int p = first; p <= last; p++, dest += length) {
+      memcpy(dest, &receivedData[p * PATCH_PACKED_SIZE + offset], length);
+    }
+    return true;
+  }
+
+#ifdef USE_PATCH_LIBRARY
+  const PatchBankEntry& entry = bankIndex[bank - NUM_BANKS];
+  char path[sizeof(PATCH_LIBRARY_DIR) + PATCH_FILE_NAME_LENGTH + 1];
+  snprintf(path, sizeof(path), "%s/%s", PATCH_LIBRARY_DIR, entry.file);
+
+  File f = PATCH_FS.open(path);
+  if (!f) return false;
+  bool ok = true;
+  for (int p = first; ok && p <= last; p++, dest += length) {
+    ok = f.seek(entry.dataOffset + p * PATCH_PACKED_SIZE + offset) &&
+         f.read(dest, length) == length;
+  }
+  f.close();
+  return ok;
+#else
+  return false;
+#endif
+}
+
+void PatchLibrary::loadVoiceNames(int bank) {
+  uint8_t raw[32][10];
+  bool ok = readPacked(bank, -1, 118, &raw[0][0], 10);
+  for (int patch = 0; patch < 32; patch++) {
+    if (ok) {
+      cleanName(names[patch], raw[patch]);
+    } else {
+      strcpy(names[patch], "?");
+    }
+  }
+  namesBank = ok ? bank : -1;
+}
+
+// Drop cached voices and names of a bank whose contents are about to change
+void PatchLibrary::forgetBank(int bank) {
+  for (int i = 0; i < PATCH_CACHE_VOICES; i++) {
+    if (cache[i].bank == bank) cache[i].bank = -1;
+  }
+  if (namesBank == bank) namesBank = -1;
+}
+
+uint8_t* PatchLibrary::beginReceivedBank() {
+  hasReceivedBank = false;
+  forgetBank(NUM_BANKS + fileBanks);
+  return receivedData;
+}
+
+void PatchLibrary::commitReceivedBank() {
+  forgetBank(NUM_BANKS + fileBanks);
+  hasReceivedBank = true;
+}
+
+void PatchLibrary::discardReceivedBank() {
+  hasReceivedBank = false;
+  forgetBank(NUM_BANKS + fileBanks);
+}
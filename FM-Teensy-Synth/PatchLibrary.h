@@ -0,0 +1,88 @@
+#ifndef PATCH_LIBRARY_H
+#define PATCH_LIBRARY_H
+
+#include "config.h"
+#include <Arduino.h>
+
+// ============================================================================
+// DX7 Patch Library
+// ============================================================================
+// Banks 0..NUM_BANKS-1 are the ROM banks compiled in from roms_unpacked.h
+// (const, so they stay in flash). With USE_PATCH_LIBRARY, every 32-voice
+// .syx dump found in PATCH_LIBRARY_DIR on the SD card (or LittleFS flash) is
+// appended after them. Card banks stay in the packed 128-byte format on disk;
+// only an index of file names is kept in RAM, and voices are unpacked on
+// demand into a small LRU cache.
+
+#ifndef PATCH_LIBRARY_DIR
+#define PATCH_LIBRARY_DIR "/dx7"
+#endif
+#ifndef PATCH_LIBRARY_MAX_BANKS
+#define PATCH_LIBRARY_MAX_BANKS 512
+#endif
+#ifndef PATCH_CACHE_VOICES
+#define PATCH_CACHE_VOICES 8
+#endif
+
+#define PATCH_FILE_NAME_LENGTH 31   // longest .syx file name the index can hold
+#define PATCH_VOICE_SIZE 156        // unpacked voice, as used by Dexed
+#define PATCH_PACKED_SIZE 128       // packed voice inside a bulk dump
+
+class PatchLibrary {
+public:
+  PatchLibrary();
+
+  // Mount the card and index its banks (no-op without USE_PATCH_LIBRARY)
+  void begin();
+
+  int bankCount() const;
+
+  // Bank name for menus (file name without extension for card banks)
+  const char* bankName(int bank);
+
+  // Printable, trimmed voice name; name must hold 11 bytes
+  void voiceName(int bank, int patch, char* name);
+
+  // Unpacked 156-byte voice ready for Dexed::loadVoiceParameters, or NULL
+  const uint8_t* voice(int bank, int patch);
+
+  // A byte of an unpacked voice limited to its legal range, so data from
+  // outside (SysEx) can't index past the engine's tables
+  static uint8_t clampVoiceByte(uint16_t address, uint8_t value);
+
+  // SysEx bank reception: a 32-voice dump is streamed straight into one
+  // packed 4096-byte slot, listed as the last bank once it checks out
+  uint8_t* beginReceivedBank();
+  void commitReceivedBank();
+  void discardReceivedBank();
+
+  uint32_t cacheHits() const { return hits; }
+  uint32_t cacheMisses() const { return misses; }
+
+private:
+  struct CachedVoice {
+    int16_t bank;             // -1 = empty slot
+    int8_t patch;
+    uint32_t lastUse;
+    uint8_t data[PATCH_VOICE_SIZE];
+  };
+
+  bool readPacked(int bank, int patch, uint16_t offset, uint8_t* dest, uint16_t length);
+  void loadVoiceNames(int bank);
+  void forgetBank(int bank);
+
+  int fileBanks;
+  bool hasReceivedBank;
+  CachedVoice cache[PATCH_CACHE_VOICES];
+  uint32_t useCounter;
+  uint32_t hits, misses;
+
+  // Names of the card bank last browsed, so scrolling patches doesn't hit the card
+  int namesBank;
+  char names[32][11];
+  char bankNameBuffer[PATCH_FILE_NAME_LENGTH + 1];
+};
+
+extern PatchLibrary patchLibrary;
+
+#endif // PATCH_LIBRARY_H
@@ -10,10 +10,10 @@
 // External declarations
 extern const char* BankNames[8];
 
-extern uint8_t progmem_bank[8][32][156];
+extern const uint8_t progmem_bank[8][32][156];
 
 #ifdef DX7_IMPLEMENTATION
-uint8_t progmem_bank[8][32][156] PROGMEM =
+const uint8_t progmem_bank[8][32][156] PROGMEM =
 {
 	{	// ROM1A.syx
 		{	// 1: BRASS   1 
@@ -27,6 +27,7 @@
 #include <cstdlib>
 #include <stdint.h>
 #include <unistd.h>
+#include <atomic>
 #include "dexed.h"
 #include "synth.h"
 #include "fm_core.h"
@@ -58,13 +59,36 @@ Dexed::Dexed(uint8_t maxnotes, uint32_t rate)
   Env::init_sr(samplerate);
   Porta::init_sr(samplerate);
   fx.init(samplerate);
+  fxRight.init(samplerate);
 
   currentNote = 0;
   resetControllers();
   controllers.masterTune = 0;
   controllers.opSwitch = 0x3f; // enable all operators
   lastKeyDown = -1;
-  lfo.reset(data + 137);
+  refreshVoice = 0;
+  refreshLevels = 0;
+  voiceLoading = false;
+  programChanged = 0;
+  keepHeldNotes = false;
+  refreshNext = 0;
+  refreshParts = 0;
+  panMode = DEXED_PAN_CENTER;
+  stereoWidth = 0.5f;
+  unisonVoices = 1;
+  unisonDetune = 0;
+  unisonSpread = 0.5f;
+  numParts = 1;
+  editPart = 0;
+  data = partData[0];
+  for (uint8_t p = 0; p < DEXED_MAX_PARTS; p++)
+  {
+    partChannel[p] = 0;
+    partLowKey[p] = 0;
+    partHighKey[p] = 127;
+    partGain[p] = 1.0f;
+  }
+  lfo.reset(init_voice + 137);
   sustain = false;
   sostenuto = false;
   hold = false;
@@ -77,11 +101,19 @@ Dexed::Dexed(uint8_t maxnotes, uint32_t rate)
     for (uint8_t i = 0; i < max_notes; i++)
     {
       voices[i].dx7_note = new Dx7Note; // sizeof(Dx7Note) = 692
+      voices[i].part = 0;
+      voices[i].key = 0;
+      voices[i].pan_l = 1.0f;
+      voices[i].pan_r = 1.0f;
+      voices[i].pan2_l = 1.0f;
+      voices[i].pan2_r = 1.0f;
+      voices[i].unison_gain = 1.0f;
       voices[i].keydown = false;
       voices[i].sustained = false;
       voices[i].sostenuted = false;
       voices[i].held = false;
       voices[i].live = false;
+      voices[i].old_patch = false;
       voices[i].key_pressed_timer = 0;
     }
   }
@@ -90,7 +122,11 @@ Dexed::Dexed(uint8_t maxnotes, uint32_t rate)
 
   used_notes=max_notes;
   setMonoMode(false);
-  loadInitVoice();
+  for (uint8_t p = DEXED_MAX_PARTS; p-- > 0; )
+  {
+    setEditPart(p);
+    loadInitVoice();
+  }
 
   xrun = 0;
   render_time_max = 0;
@@ -179,26 +215,99 @@ void Dexed::deactivate(void)
 
 void Dexed::getSamples(float* buffer, uint16_t n_samples)
 {
-  if (refreshVoice)
+  getSamples(buffer, NULL, n_samples);
+}
+
+// Mono when right is NULL. In stereo every voice is panned while it is mixed
+// into the float buffers, so width costs no extra pass over the block.
+void Dexed::getSamples(float* left, float* right, uint16_t n_samples)
+{
+  // The main loop edits partData[]; sounding notes are only ever refreshed
+  // from partPlayData[], which is swapped in here at a block boundary. A voice
+  // that is still being copied in by loadVoiceParameters() waits a block.
+  if ((refreshVoice || refreshLevels) && !voiceLoading)
   {
-    for (uint8_t i = 0; i < used_notes; i++)
+    for (uint8_t p = 0; p < numParts; p++)
+    {
+      uint8_t bit = 1 << p;
+      if (!((refreshVoice | refreshLevels) & bit))
+        continue;
+
+      memcpy(partPlayData[p], partData[p], NUM_VOICE_PARAMETERS);
+
+      if (refreshVoice & bit)
+      {
+        refreshVoice &= ~bit;
+
+        // Notes of the outgoing patch either finish on it or, classic Dexed
+        // style, are cut now; notes started since the load are kept either way
+        if (programChanged & bit)
+        {
+          programChanged &= ~bit;
+          if (!keepHeldNotes)
+          {
+            for (uint8_t i = 0; i < max_notes; i++)
+            {
+              if (voices[i].live && voices[i].old_patch && voices[i].part == p)
+              {
+                voices[i].keydown = false;
+                voices[i].live = false;
+                voices[i].sustained = false;
+                voices[i].sostenuted = false;
+                voices[i].held = false;
+                voices[i].key_pressed_timer = 0;
+                voices[i].dx7_note->oscSync();
+              }
+            }
+          }
+        }
+
+        if (p == 0)
+          lfo.reset(partPlayData[0] + 137);
+        refreshParts |= bit;
+        refreshNext = 0;
+      }
+
+      if (refreshLevels & bit)
+      {
+        refreshLevels &= ~bit;
+
+        for (uint8_t i = 0; i < used_notes; i++)
+        {
+          if (voices[i].live && !voices[i].old_patch && voices[i].part == p)
+            voices[i].dx7_note->updateLevels(partPlayData[p], voices[i].midi_note, voices[i].velocity);
+        }
+      }
+    }
+  }
+
+  // Bring the sounding notes up to date a few at a time, so a voice edit
+  // doesn't run Dx7Note::update() for every note inside one block
+  for (uint8_t budget = DEXED_REFRESH_VOICES_PER_BLOCK; budget > 0 && refreshNext < used_notes; refreshNext++)
+  {
+    ProcessorVoice& voice = voices[refreshNext];
+    if (voice.live && !voice.old_patch && (refreshParts & (1 << voice.part)))
     {
-      if ( voices[i].live )
-        voices[i].dx7_note->update(data, voices[i].midi_note, voices[i].velocity, voices[i].porta, &controllers);
+      voice.dx7_note->update(partPlayData[voice.part], voice.midi_note, voice.velocity, voice.porta, &controllers);
+      budget--;
     }
-    lfo.reset(data + 137);
-    refreshVoice = false;
   }
+  if (refreshNext >= used_notes)
+    refreshParts = 0;
 
-  arm_fill_f32(0.0, buffer, n_samples);
+  arm_fill_f32(0.0, left, n_samples);
+  if (right)
+    arm_fill_f32(0.0, right, n_samples);
 
   for (uint16_t i = 0; i < n_samples; i += _N_)
   {
     AlignedBuf<int32_t, _N_> audiobuf;
+    AlignedBuf<int32_t, _N_> audiobuf2;
 
     for (uint8_t j = 0; j < _N_; ++j)
     {
       audiobuf.get()[j] = 0;
+      audiobuf2.get()[j] = 0;
     }
 
     int32_t lfovalue = lfo.getsample();
@@ -208,22 +317,73 @@ void Dexed::getSamples(float* buffer, uint16_t n_samples)
     {
       if (voices[note].live)
       {
-        voices[note].dx7_note->compute(audiobuf.get(), lfovalue, lfodelay, &controllers);
+        const float gain = partGain[voices[note].part] / 32768.0f;
+        // Unison copies are summed before saturating, so they are scaled
+        // down to the level of one voice first
+        const float unison = voices[note].unison_gain;
+        if (right && voices[note].dx7_note->getUnison() > 1)
+        {
+          // Even and odd unison copies are panned apart
+          voices[note].dx7_note->compute(audiobuf.get(), lfovalue, lfodelay, &controllers, audiobuf2.get());
+          const float gain_l = gain * voices[note].pan_l;
+          const float gain_r = gain * voices[note].pan_r;
+          const float gain2_l = gain * voices[note].pan2_l;
+          const float gain2_r = gain * voices[note].pan2_r;
+          for (uint8_t j = 0; j < _N_; ++j)
+          {
+            int32_t sample = signed_saturate_rshift(int32_t(audiobuf.get()[j] * unison) >> 4, 24, 9);
+            int32_t sample2 = signed_saturate_rshift(int32_t(audiobuf2.get()[j] * unison) >> 4, 24, 9);
+            left[i + j] += sample * gain_l + sample2 * gain2_l;
+            right[i + j] += sample * gain_r + sample2 * gain2_r;
+            audiobuf.get()[j] = 0;
+            audiobuf2.get()[j] = 0;
+          }
+          continue;
+        }
 
-        for (uint8_t j = 0; j < _N_; ++j)
+        voices[note].dx7_note->compute(audiobuf.get(), lfovalue, lfodelay, &controllers);
+        if (unison != 1.0f)
+        {
+          for (uint8_t j = 0; j < _N_; ++j)
+            audiobuf.get()[j] = int32_t(audiobuf.get()[j] * unison);
+        }
+        if (right)
+        {
+          const float gain_l = gain * voices[note].pan_l;
+          const float gain_r = gain * voices[note].pan_r;
+          for (uint8_t j = 0; j < _N_; ++j)
+          {
+            int32_t sample = signed_saturate_rshift(audiobuf.get()[j] >> 4, 24, 9);
+            left[i + j] += sample * gain_l;
+            right[i + j] += sample * gain_r;
+            audiobuf.get()[j] = 0;
+          }
+        }
+        else
         {
-          buffer[i + j] += signed_saturate_rshift(audiobuf.get()[j] >> 4, 24, 9) / 32768.0;
-          audiobuf.get()[j] = 0;
+          for (uint8_t j = 0; j < _N_; ++j)
+          {
+            left[i + j] += signed_saturate_rshift(audiobuf.get()[j] >> 4, 24, 9) * gain;
+            audiobuf.get()[j] = 0;
+          }
         }
       }
     }
   }
 
-  fx.process(buffer, n_samples); // Needed for fx.Gain()!!!
+  fx.process(left, n_samples); // Needed for fx.Gain()!!!
+  if (right)
+  {
+    // The right channel runs its own filter state with the same settings
+    fxRight.Cutoff = fx.Cutoff;
+    fxRight.Reso = fx.Reso;
+    fxRight.Gain = fx.Gain;
+    fxRight.process(right, n_samples);
+  }
 
 #ifndef TEENSYDUINO
-  if (use_compressor == true)
-    compressor->doCompression(buffer, n_samples);
+  if (use_compressor == true && !right)
+    compressor->doCompression(left, n_samples);
 #endif
 }
 
@@ -235,15 +395,54 @@ void Dexed::getSamples(int16_t* buffer, uint16_t n_samples)
   arm_float_to_q15(tmp, (q15_t*)buffer, n_samples);
 }
 
+void Dexed::getSamples(int16_t* left, int16_t* right, uint16_t n_samples)
+{
+  float tmp_l[n_samples];
+  float tmp_r[n_samples];
+
+  getSamples(tmp_l, tmp_r, n_samples);
+  arm_float_to_q15(tmp_l, (q15_t*)left, n_samples);
+  arm_float_to_q15(tmp_r, (q15_t*)right, n_samples);
+}
+
 void Dexed::keydown(uint8_t pitch, uint8_t velo) {
+  keydownPart(0, pitch, velo);
+}
+
+void Dexed::keyup(uint8_t pitch) {
+  keyupPart(0, pitch);
+}
+
+void Dexed::midiNoteOn(uint8_t channel, uint8_t pitch, uint8_t velo) {
+  for (uint8_t p = 0; p < numParts; p++) {
+    if ((partChannel[p] == 0 || partChannel[p] == channel) &&
+        pitch >= partLowKey[p] && pitch <= partHighKey[p])
+      keydownPart(p, pitch, velo);
+  }
+}
+
+void Dexed::midiNoteOff(uint8_t channel, uint8_t pitch) {
+  for (uint8_t p = 0; p < numParts; p++) {
+    if ((partChannel[p] == 0 || partChannel[p] == channel) &&
+        pitch >= partLowKey[p] && pitch <= partHighKey[p])
+      keyupPart(p, pitch);
+  }
+}
+
+void Dexed::keydownPart(uint8_t part, uint8_t pitch, uint8_t velo) {
   if ( velo == 0 ) {
-    keyup(pitch);
+    keyupPart(part, pitch);
     return;
   }
 
+  if (part >= numParts)
+    return;
+  const uint8_t* patch = partData[part];
+
   velo=uint8_t((float(velo)/127.0)*velocity_diff+0.5)+velocity_offset;
 
-  pitch += data[144] - TRANSPOSE_FIX;
+  uint8_t key = pitch;
+  pitch += patch[144] - TRANSPOSE_FIX;
 
   int32_t previousKeyDown = lastKeyDown;
   lastKeyDown = pitch;
@@ -259,18 +458,22 @@ void Dexed::keydown(uint8_t pitch, uint8_t velo) {
   {
     for (uint8_t i = 0; i < used_notes; i++)
     {
-      if (voices[i].midi_note == pitch && voices[i].keydown == false && voices[i].live &&
+      if (voices[i].part == part && voices[i].midi_note == pitch && voices[i].keydown == false && voices[i].live &&
          (voices[i].sustained == true || voices[i].held == true))
       {
         // retrigger or refresh note?
         voices[i].dx7_note->keyup();
+        voices[i].key = key;
         voices[i].midi_note = pitch;
         voices[i].velocity = velo;
         voices[i].keydown = true;
         voices[i].sustained = sustain;
         voices[i].held = hold;
         voices[i].live = true;
-        voices[i].dx7_note->init(data, pitch, velo, pitch, porta, &controllers);
+        voices[i].old_patch = false;
+        voices[i].dx7_note->init(patch, pitch, velo, pitch, porta, &controllers);
+        voices[i].dx7_note->setUnison(unisonVoices, unisonDetune);
+        updateVoicePan(i);
         voices[i].key_pressed_timer = millis();
         return;
       }
@@ -286,10 +489,27 @@ void Dexed::keydown(uint8_t pitch, uint8_t velo) {
       if (monoMode)
         break;
 
-      // no free sound slot found, so use the oldest note slot
+      // no free sound slot found: take one from the part holding the most
+      // sounding (held or releasing) voices, this part on a tie, so one part
+      // can't starve the others, and within it use the oldest note slot
+      uint8_t victim_part = part;
+      if (numParts > 1)
+      {
+        uint8_t part_voices[DEXED_MAX_PARTS] = {0};
+        for (uint8_t n = 0; n < used_notes; n++)
+        {
+          if (voices[n].live)
+            part_voices[voices[n].part]++;
+        }
+        for (uint8_t p = 0; p < numParts; p++)
+        {
+          if (part_voices[p] > part_voices[victim_part])
+            victim_part = p;
+        }
+      }
       for (uint8_t n = 0; n < used_notes; n++)
       {
-        if (voices[n].key_pressed_timer < min_timer)
+        if (voices[n].part == victim_part && voices[n].key_pressed_timer < min_timer)
         {
           min_timer = voices[n].key_pressed_timer;
           note = n;
@@ -332,17 +552,22 @@ void Dexed::keydown(uint8_t pitch, uint8_t velo) {
       currentNote = (note + 1) % used_notes;
       //if (keydown_counter == 0) // Original comment: TODO: should only do this if # keys down was 0
         lfo.keydown();
+      voices[note].part = part;
+      voices[note].key = key;
       voices[note].midi_note = pitch;
       voices[note].velocity = velo;
       voices[note].sustained = sustain;
       voices[note].sostenuted = false;
       voices[note].held = hold;
       voices[note].keydown = true;
+      voices[note].old_patch = false;
       int32_t srcnote = (previousKeyDown >= 0) ? previousKeyDown : pitch;
-      voices[note].dx7_note->init(data, pitch, velo, srcnote, porta, &controllers);
-      if ( data[136] )
+      voices[note].dx7_note->init(patch, pitch, velo, srcnote, porta, &controllers);
+      voices[note].dx7_note->setUnison(unisonVoices, unisonDetune);
+      if ( patch[136] )
         voices[note].dx7_note->oscSync();
-      voices[i].key_pressed_timer = millis();
+      updateVoicePan(note);
+      voices[note].key_pressed_timer = millis();
       keydown_counter++;
       break;
     }
@@ -375,15 +600,15 @@ void Dexed::keydown(uint8_t pitch, uint8_t velo) {
   voices[note].live = true;
 }
 
-void Dexed::keyup(uint8_t pitch) {
+void Dexed::keyupPart(uint8_t part, uint8_t pitch) {
   uint8_t note;
 
   pitch = constrain(pitch, 0, 127);
 
-  pitch += data[144] - TRANSPOSE_FIX;
-
+  // Match on the untransposed key: a note started before a program change
+  // may have been transposed by the previous patch
   for (note = 0; note < used_notes; note++) {
-    if ( voices[note].midi_note == pitch && voices[note].keydown ) {
+    if ( voices[note].part == part && voices[note].key == pitch && voices[note].keydown ) {
       voices[note].keydown = false;
       voices[note].key_pressed_timer = 0;
 
@@ -428,7 +653,160 @@ void Dexed::keyup(uint8_t pitch) {
 
 void Dexed::doRefreshVoice(void)
 {
-  refreshVoice = true;
+  refreshVoice |= 1 << editPart;
+}
+
+// Output level and feedback edits only retarget the ramps of sounding notes
+void Dexed::doRefreshLevels(void)
+{
+  refreshLevels |= 1 << editPart;
+}
+
+void Dexed::setPanMode(uint8_t mode)
+{
+  panMode = constrain(mode, DEXED_PAN_CENTER, DEXED_PAN_VOICE);
+}
+
+uint8_t Dexed::getPanMode(void)
+{
+  return panMode;
+}
+
+void Dexed::setStereoWidth(float width)
+{
+  stereoWidth = constrain(width, 0.0f, 1.0f);
+}
+
+float Dexed::getStereoWidth(void)
+{
+  return stereoWidth;
+}
+
+void Dexed::setUnison(uint8_t voices, uint8_t detune)
+{
+  unisonVoices = constrain(voices, 1, DEXED_UNISON_MAX);
+  unisonDetune = constrain(detune, 0, 50);
+}
+
+uint8_t Dexed::getUnisonVoices(void)
+{
+  return unisonVoices;
+}
+
+uint8_t Dexed::getUnisonDetune(void)
+{
+  return unisonDetune;
+}
+
+void Dexed::setUnisonSpread(float spread)
+{
+  unisonSpread = constrain(spread, 0.0f, 1.0f);
+}
+
+float Dexed::getUnisonSpread(void)
+{
+  return unisonSpread;
+}
+
+// Constant-power pan, scaled so a centred voice keeps its mono level
+void Dexed::updateVoicePan(uint8_t v)
+{
+  float position = 0.0f; // -1 = left, +1 = right
+
+  switch (panMode)
+  {
+    case DEXED_PAN_NOTE:
+      position = (voices[v].midi_note - 60) / 36.0f;
+      break;
+    case DEXED_PAN_VOICE:
+      position = (max_notes > 1) ? (2.0f * v / (max_notes - 1) - 1.0f) : 0.0f;
+      break;
+    default:
+      break;
+  }
+  position = constrain(position * stereoWidth, -1.0f, 1.0f);
+
+  // Stacked copies add up in power, so each gets 1/sqrt(copies); getSamples()
+  // applies it to the summed copies ahead of the saturation
+  uint8_t copies = voices[v].dx7_note->getUnison();
+  voices[v].unison_gain = 1.0f / sqrtf(copies);
+
+  if (copies > 1)
+  {
+    // In stereo the even copies go left of the voice, the odd ones right
+    float position2 = constrain(position + unisonSpread, -1.0f, 1.0f);
+    position = constrain(position - unisonSpread, -1.0f, 1.0f);
+    float angle2 = (position2 + 1.0f) * float(M_PI / 4.0);
+    voices[v].pan2_l = cosf(angle2) * float(M_SQRT2);
+    voices[v].pan2_r = sinf(angle2) * float(M_SQRT2);
+  }
+
+  float angle = (position + 1.0f) * float(M_PI / 4.0);
+  voices[v].pan_l = cosf(angle) * float(M_SQRT2);
+  voices[v].pan_r = sinf(angle) * float(M_SQRT2);
+}
+
+// The LFO is shared by all parts and follows part 0
+void Dexed::resetLfo(void)
+{
+  if (editPart == 0)
+    lfo.reset(data + 137);
+}
+
+void Dexed::setParts(uint8_t parts)
+{
+  parts = constrain(parts, 1, DEXED_MAX_PARTS);
+  if (parts < numParts)
+    panic();
+  numParts = parts;
+  if (editPart >= numParts)
+    setEditPart(0);
+}
+
+uint8_t Dexed::getParts(void)
+{
+  return numParts;
+}
+
+void Dexed::setEditPart(uint8_t part)
+{
+  editPart = constrain(part, 0, DEXED_MAX_PARTS - 1);
+  data = partData[editPart];
+}
+
+uint8_t Dexed::getEditPart(void)
+{
+  return editPart;
+}
+
+void Dexed::setPartChannel(uint8_t part, uint8_t channel)
+{
+  if (part < DEXED_MAX_PARTS)
+    partChannel[part] = constrain(channel, 0, 16);
+}
+
+uint8_t Dexed::getPartChannel(uint8_t part)
+{
+  return part < DEXED_MAX_PARTS ? partChannel[part] : 0;
+}
+
+void Dexed::setPartKeyRange(uint8_t part, uint8_t low, uint8_t high)
+{
+  if (part >= DEXED_MAX_PARTS)
+    return;
+  partLowKey[part] = constrain(low, 0, 127);
+  partHighKey[part] = constrain(high, partLowKey[part], 127);
+}
+
+void Dexed::setPartVolume(uint8_t part, float volume)
+{
+  if (part < DEXED_MAX_PARTS)
+    partGain[part] = constrain(volume, 0.0f, 1.0f);
+}
+
+float Dexed::getPartVolume(uint8_t part)
+{
+  return part < DEXED_MAX_PARTS ? partGain[part] : 0.0f;
 }
 
 void Dexed::setOPAll(uint8_t ops)
@@ -575,6 +953,7 @@ void Dexed::resetControllers(void)
 void Dexed::resetFxState(void)
 {
   fx.resetState();
+  fxRight.resetState();
 }
 
 void Dexed::notesOff(void) {
@@ -641,14 +1020,13 @@ uint8_t Dexed::getNumNotesPlaying(void)
   return (count_playing_voices);
 }
 
-bool Dexed::decodeVoice(uint8_t* new_data, uint8_t* encoded_data)
+// Unpack a 128-byte bulk dump voice into the 156-byte parameter layout.
+// No engine state is touched, so patch libraries can decode into their own buffers.
+void Dexed::unpackVoice(uint8_t* new_data, const uint8_t* encoded_data)
 {
   uint8_t* p_data = new_data;
   uint8_t op;
   uint8_t tmp;
-  char dexed_voice_name[11];
-
-  panic();
 
   for (op = 0; op < 6; op++)
   {
@@ -704,6 +1082,14 @@ bool Dexed::decodeVoice(uint8_t* new_data, uint8_t* encoded_data)
   *(p_data + DEXED_VOICE_OFFSET + DEXED_LFO_SYNC) = (tmp & 0x01);
   *(p_data + DEXED_VOICE_OFFSET + DEXED_TRANSPOSE) = encoded_data[117];
   memcpy(&new_data[DEXED_VOICE_OFFSET + DEXED_NAME], &encoded_data[118], 10);
+}
+
+bool Dexed::decodeVoice(uint8_t* new_data, uint8_t* encoded_data)
+{
+  char dexed_voice_name[11];
+
+  panic();
+  unpackVoice(new_data, encoded_data);
   panic();
   doRefreshVoice();
 
@@ -769,7 +1155,7 @@ bool Dexed::encodeVoice(uint8_t* encoded_data)
 
 bool Dexed::getVoiceData(uint8_t* data_copy)
 {
-  memcpy(data_copy, data, sizeof(data));
+  memcpy(data_copy, data, NUM_VOICE_PARAMETERS);
   return (true);
 }
 
@@ -777,7 +1163,11 @@ void Dexed::setVoiceDataElement(uint8_t address, uint8_t value)
 {
   address = constrain(address, 0, NUM_VOICE_PARAMETERS);
   data[address] = value;
-  doRefreshVoice();
+  if ((address < DEXED_VOICE_OFFSET && address % 21 == DEXED_OP_OUTPUT_LEV) ||
+      address == DEXED_VOICE_OFFSET + DEXED_FEEDBACK)
+    doRefreshLevels();
+  else
+    doRefreshVoice();
 }
 
 uint8_t Dexed::getVoiceDataElement(uint8_t address)
@@ -786,14 +1176,27 @@ uint8_t Dexed::getVoiceDataElement(uint8_t address)
   return (data[address]);
 }
 
-void Dexed::loadVoiceParameters(uint8_t* new_data)
+void Dexed::loadVoiceParameters(const uint8_t* new_data)
 {
 #if defined(MICRODEXED_VERSION) && defined(DEBUG)
   char dexed_voice_name[11];
 #endif
 
-  panic();
-  memcpy(&data, new_data, 155);
+  // This part's sounding notes belong to the outgoing patch and are no longer refreshed
+  for (uint8_t i = 0; i < max_notes; i++)
+  {
+    if (voices[i].live && voices[i].part == editPart)
+      voices[i].old_patch = true;
+  }
+
+  // Keep the renderer from swapping in a half-copied voice; the swap itself
+  // (and cutting the old notes, unless they are kept) happens in getSamples()
+  voiceLoading = true;
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+  memcpy(data, new_data, 155);
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+  voiceLoading = false;
+  programChanged |= 1 << editPart;
   doRefreshVoice();
 #if defined(MICRODEXED_VERSION) && defined(DEBUG)
   strncpy(dexed_voice_name, (char *)&new_data[145], sizeof(dexed_voice_name) - 1);
@@ -804,6 +1207,16 @@ void Dexed::loadVoiceParameters(uint8_t* new_data)
 #endif
 }
 
+void Dexed::setKeepHeldNotes(bool keep)
+{
+  keepHeldNotes = keep;
+}
+
+bool Dexed::getKeepHeldNotes(void)
+{
+  return keepHeldNotes;
+}
+
 void Dexed::loadInitVoice(void)
 {
   loadVoiceParameters(init_voice);
@@ -1553,7 +1966,7 @@ void Dexed::setOPOutputLevel(uint8_t op, uint8_t level)
   level = constrain(level, 0, 99);
 
   data[(op * 21) + DEXED_OP_OUTPUT_LEV] = level;
-  doRefreshVoice();
+  doRefreshLevels();
 }
 
 uint8_t Dexed::getOPOutputLevel(uint8_t op)
@@ -1674,10 +2087,10 @@ uint8_t Dexed::getAlgorithm(void)
 
 void Dexed::setFeedback(uint8_t feedback)
 {
-  feedback  = constrain(feedback, 0, 31);
+  feedback  = constrain(feedback, 0, 7);
 
   data[DEXED_VOICE_OFFSET + DEXED_FEEDBACK] = feedback;
-  doRefreshVoice();
+  doRefreshLevels();
 }
 
 uint8_t Dexed::getFeedback(void)
@@ -1701,7 +2114,7 @@ void Dexed::setLFOSpeed(uint8_t speed)
   speed  = constrain(speed, 0, 99);
 
   data[DEXED_VOICE_OFFSET + DEXED_LFO_SPEED] = speed;
-  lfo.reset(data + 137);
+  resetLfo();
 }
 
 uint8_t Dexed::getLFOSpeed(void)
@@ -1714,7 +2127,7 @@ void Dexed::setLFODelay(uint8_t delay)
   delay  = constrain(delay, 0, 99);
 
   data[DEXED_VOICE_OFFSET + DEXED_LFO_DELAY] = delay;
-  lfo.reset(data + 137);
+  resetLfo();
 }
 
 uint8_t Dexed::getLFODelay(void)
@@ -1727,7 +2140,7 @@ void Dexed::setLFOPitchModulationDepth(uint8_t depth)
   depth = constrain(depth, 0, 99);
 
   data[DEXED_VOICE_OFFSET + DEXED_LFO_PITCH_MOD_DEP] = depth;
-  lfo.reset(data + 137);
+  resetLfo();
 }
 
 uint8_t Dexed::getLFOPitchModulationDepth(void)
@@ -1740,7 +2153,7 @@ void Dexed::setLFOAmpModulationDepth(uint8_t depth)
   depth = constrain(depth, 0, 99);
 
   data[DEXED_VOICE_OFFSET + DEXED_LFO_AMP_MOD_DEP] = depth;
-  lfo.reset(data + 137);
+  resetLfo();
 }
 
 uint8_t Dexed::getLFOAmpModulationDepth(void)
@@ -1756,7 +2169,7 @@ void Dexed::setLFOSync(bool sync)
 bool Dexed::getLFOSync(void)
 {
   return (data[DEXED_VOICE_OFFSET + DEXED_LFO_SYNC]);
-  lfo.reset(data + 137);
+  resetLfo();
 }
 
 void Dexed::setLFOWaveform(uint8_t waveform)
@@ -1764,7 +2177,7 @@ void Dexed::setLFOWaveform(uint8_t waveform)
   waveform = constrain(waveform, 0, 5);
 
   data[DEXED_VOICE_OFFSET + DEXED_LFO_WAVE] = waveform;
-  lfo.reset(data + 137);
+  resetLfo();
 }
 
 uint8_t Dexed::getLFOWaveform(void)
@@ -1777,7 +2190,7 @@ void Dexed::setLFOPitchModulationSensitivity(uint8_t sensitivity)
   sensitivity  = constrain(sensitivity, 0, 5);
 
   data[DEXED_VOICE_OFFSET + DEXED_LFO_PITCH_MOD_SENS] = sensitivity;
-  lfo.reset(data + 137);
+  resetLfo();
 }
 
 uint8_t Dexed::getLFOPitchModulationSensitivity(void)
@@ -50,7 +50,19 @@
 
 #define NUM_VOICE_PARAMETERS 156
 
+// Multitimbral parts sharing the voice pool
+#ifndef DEXED_MAX_PARTS
+#define DEXED_MAX_PARTS 4
+#endif
+
+// Sounding voices brought up to date per audio block after a voice edit
+#ifndef DEXED_REFRESH_VOICES_PER_BLOCK
+#define DEXED_REFRESH_VOICES_PER_BLOCK 4
+#endif
+
 struct ProcessorVoice {
+  uint8_t part;               // multitimbral part that started the note
+  uint8_t key;                // incoming MIDI key, before transpose
   uint8_t midi_note;
   uint8_t velocity;
   int16_t porta;
@@ -59,6 +71,12 @@ struct ProcessorVoice {
   bool sostenuted;
   bool held;
   bool live;
+  bool old_patch;             // started before a program change, no longer refreshed
+  float pan_l;                // stereo gains, set at note on
+  float pan_r;
+  float pan2_l;               // odd unison copies, when spread in stereo
+  float pan2_r;
+  float unison_gain;          // 1/sqrt(copies), applied before saturating
   uint32_t key_pressed_timer;
   Dx7Note *dx7_note;
 };
@@ -154,6 +172,12 @@ enum VELOCITY_SCALES {
   MIDI_VELOCITY_SCALING_DX7II
 };
 
+enum DEXED_PAN_MODES {
+  DEXED_PAN_CENTER,           // every voice in the middle
+  DEXED_PAN_NOTE,             // low notes left, high notes right
+  DEXED_PAN_VOICE             // spread by voice index, so chords fan out
+};
+
 enum ENGINES {
   MSFA,
   MKI,
@@ -178,14 +202,18 @@ class Dexed
     void setNoteRefreshMode(bool mode);
     uint8_t getMaxNotes(void);
     void doRefreshVoice(void);
+    void doRefreshLevels(void);
     void setOPAll(uint8_t ops);
     bool decodeVoice(uint8_t* data, uint8_t* encoded_data);
+    static void unpackVoice(uint8_t* data, const uint8_t* encoded_data);
     bool encodeVoice(uint8_t* encoded_data);
     bool getVoiceData(uint8_t* data_copy);
     void setVoiceDataElement(uint8_t address, uint8_t value);
     uint8_t getVoiceDataElement(uint8_t address);
     void loadInitVoice(void);
-    void loadVoiceParameters(uint8_t* data);
+    void loadVoiceParameters(const uint8_t* data);
+    void setKeepHeldNotes(bool keep);
+    bool getKeepHeldNotes(void);
     uint8_t getNumNotesPlaying(void);
     uint32_t getXRun(void);
     uint16_t getRenderTimeMax(void);
@@ -219,6 +247,41 @@ class Dexed
     // Sound methods
     void keyup(uint8_t pitch);
     void keydown(uint8_t pitch, uint8_t velo);
+
+    // Multitimbral parts: each has its own patch, MIDI channel, key range and
+    // volume, and all of them draw from the one voice pool. Voice setters and
+    // getters work on the edit part; keydown()/keyup() play part 0. The LFO
+    // and controllers are shared and follow part 0.
+    void setParts(uint8_t parts);
+    uint8_t getParts(void);
+    void setEditPart(uint8_t part);
+    uint8_t getEditPart(void);
+    void setPartChannel(uint8_t part, uint8_t channel); // 0 = omni
+    uint8_t getPartChannel(uint8_t part);
+    void setPartKeyRange(uint8_t part, uint8_t low, uint8_t high);
+    void setPartVolume(uint8_t part, float volume);
+    float getPartVolume(uint8_t part);
+    void keydownPart(uint8_t part, uint8_t pitch, uint8_t velo);
+    void keyupPart(uint8_t part, uint8_t pitch);
+    // Play every part listening on this channel whose key range holds the note
+    void midiNoteOn(uint8_t channel, uint8_t pitch, uint8_t velo);
+    void midiNoteOff(uint8_t channel, uint8_t pitch);
+
+    // Stereo rendering (getSamples with two buffers): where each new voice
+    // sits, and how far from the centre (0.0-1.0)
+    void setPanMode(uint8_t mode);
+    uint8_t getPanMode(void);
+    void setStereoWidth(float width);
+    float getStereoWidth(void);
+
+    // Unison: every note plays 1-DEXED_UNISON_MAX copies detuned over
+    // +-detune cents (0-50). In stereo, spread (0.0-1.0) pulls the copies
+    // apart either side of the voice's pan position. Applies to new notes.
+    void setUnison(uint8_t voices, uint8_t detune);
+    uint8_t getUnisonVoices(void);
+    uint8_t getUnisonDetune(void);
+    void setUnisonSpread(float spread);
+    float getUnisonSpread(void);
     void setSustain(bool sustain);
     bool getSustain(void);
     void setSostenuto(bool sostenuto);
@@ -365,10 +428,19 @@ class Dexed
       73, 78, 73, 84, 32, 86, 79, 73, 67, 69                                              // 10 * char for name ("INIT VOICE")
     };
     FRAC_NUM samplerate;
-    uint8_t data[NUM_VOICE_PARAMETERS];
+    uint8_t partData[DEXED_MAX_PARTS][NUM_VOICE_PARAMETERS];     // edit buffers, written from the main loop
+    uint8_t partPlayData[DEXED_MAX_PARTS][NUM_VOICE_PARAMETERS]; // renderer's copies, swapped in at block boundaries
+    uint8_t* data;                                                // edit buffer of the edit part
+    uint8_t numParts;
+    uint8_t editPart;
+    uint8_t partChannel[DEXED_MAX_PARTS];
+    uint8_t partLowKey[DEXED_MAX_PARTS];
+    uint8_t partHighKey[DEXED_MAX_PARTS];
+    float partGain[DEXED_MAX_PARTS];
     uint8_t max_notes;
     uint8_t used_notes;
     PluginFx fx;
+    PluginFx fxRight;
     Controllers controllers;
     int32_t lastKeyDown;
     uint32_t xrun;
@@ -379,7 +451,14 @@ class Dexed
     bool hold;
     bool monoMode;
     bool noteRefreshMode;
-    bool refreshVoice;
+    volatile uint8_t refreshVoice;    // one bit per part
+    volatile uint8_t refreshLevels;
+    volatile bool voiceLoading;
+    volatile uint8_t programChanged;
+    bool keepHeldNotes;
+    uint8_t refreshNext;
+    uint8_t refreshParts;             // parts the refresh cursor is working through
+    void resetLfo(void);
     uint8_t engineType;
     VoiceStatus voiceStatus;
     Lfo lfo;
@@ -387,7 +466,15 @@ class Dexed
     EngineMkI* engineMkI;
     EngineOpl* engineOpl;
     void getSamples(float* buffer, uint16_t n_samples);
+    void getSamples(float* left, float* right, uint16_t n_samples);
     void getSamples(int16_t* buffer, uint16_t n_samples);
+    void getSamples(int16_t* left, int16_t* right, uint16_t n_samples);
+    void updateVoicePan(uint8_t v);
+    uint8_t panMode;
+    float stereoWidth;
+    uint8_t unisonVoices;
+    uint8_t unisonDetune;
+    float unisonSpread;
     void compress(float* wav_in, float* wav_out, uint16_t n, float threshold, float slope, uint16_t sr,  float tla, float twnd, float tatt, float trel);
     bool use_compressor;
     uint8_t velocity_offset;
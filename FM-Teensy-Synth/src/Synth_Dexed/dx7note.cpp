@@ -27,6 +27,11 @@
 
 const int FEEDBACK_BITDEPTH = 8;
 
+// Level ramps move 1/8 of the remaining distance per block (~12 ms at 44.1 kHz)
+const int LEVEL_RAMP_SHIFT = 3;
+// Env never drops below this level; ramp offsets leave such ops alone
+const int32_t ENV_FLOOR = 16 << 16;
+
 int32_t midinote_to_logfreq(int midinote) {
   //const int32_t base = 50857777;  // (1 << 24) * (log(440) / log(2) - 69/12)
   const int32_t base = 50857777;  // (1 << 24) * (LOG_FUNC(440) / LOG_FUNC(2) - 69/12)
@@ -152,9 +157,38 @@ Dx7Note::Dx7Note() {
   for (int op = 0; op < 6; op++) {
     params_[op].phase = 0;
     params_[op].gain_out = 0;
+    envOutlevel_[op] = 0;
+    levelOffset_[op] = 0;
+    levelTarget_[op] = 0;
+  }
+  unison_ = 1;
+  for (int u = 0; u < DEXED_UNISON_MAX; u++) {
+    unisonDetune_[u] = 0;
+  }
+  for (int u = 0; u < DEXED_UNISON_MAX - 1; u++) {
+    for (int op = 0; op < 6; op++) {
+      unisonParams_[u][op].phase = (u + 1) << 22;
+      unisonParams_[u][op].gain_out = 0;
+    }
+    unisonFb_[u][0] = 0;
+    unisonFb_[u][1] = 0;
   }
 }
 
+// Scaled output level of one operator as fed to its envelope
+static int32_t op_outlevel(const uint8_t *patch, int off, int midinote, int velocity) {
+  int outlevel = patch[off + 16];
+  outlevel = Env::scaleoutlevel(outlevel);
+  int level_scaling = ScaleLevel(midinote, patch[off + 8], patch[off + 9],
+                                 patch[off + 10], patch[off + 11], patch[off + 12]);
+  outlevel += level_scaling;
+  outlevel = std::min(127, outlevel);
+  outlevel = outlevel << 5;
+  outlevel += ScaleVelocity(velocity, patch[off + 15]);
+  outlevel = std::max(0, outlevel);
+  return outlevel;
+}
+
 //void Dx7Note::init(const uint8_t patch[156], int midinote, int velocity) {
 void Dx7Note::init(const uint8_t patch[156], int midinote, int velocity, int srcnote, int porta, const Controllers *ctrls) {
   int rates[4];
@@ -165,15 +199,10 @@ void Dx7Note::init(const uint8_t patch[156], int midinote, int velocity, int src
       rates[i] = patch[off + i];
       levels[i] = patch[off + 4 + i];
     }
-    int outlevel = patch[off + 16];
-    outlevel = Env::scaleoutlevel(outlevel);
-    int level_scaling = ScaleLevel(midinote, patch[off + 8], patch[off + 9],
-                                   patch[off + 10], patch[off + 11], patch[off + 12]);
-    outlevel += level_scaling;
-    outlevel = std::min(127, outlevel);
-    outlevel = outlevel << 5;
-    outlevel += ScaleVelocity(velocity, patch[off + 15]);
-    outlevel = std::max(0, outlevel);
+    int outlevel = op_outlevel(patch, off, midinote, velocity);
+    envOutlevel_[op] = outlevel;
+    levelOffset_[op] = 0;
+    levelTarget_[op] = 0;
     int rate_scaling = ScaleRate(midinote, patch[off + 13]);
     env_[op].init((const int32_t*)rates, (const int32_t*)levels, outlevel, rate_scaling);
 
@@ -201,6 +230,7 @@ void Dx7Note::init(const uint8_t patch[156], int midinote, int velocity, int src
   algorithm_ = patch[134];
   int feedback = patch[135];
   fb_shift_ = feedback != 0 ? FEEDBACK_BITDEPTH - feedback : 16;
+  fb_shift_target_ = fb_shift_;
   pitchmoddepth_ = (patch[139] * 165) >> 6;
   pitchmodsens_ = pitchmodsenstab[patch[143] & 7];
   ampmoddepth_ = (patch[140] * 165) >> 6;
@@ -208,7 +238,7 @@ void Dx7Note::init(const uint8_t patch[156], int midinote, int velocity, int src
   porta_gliss_ = ctrls->values_[kControllerPortamentoGlissando];
 }
 
-void Dx7Note::compute(int32_t *buf, int32_t lfo_val, int32_t lfo_delay, const Controllers *ctrls) {
+void Dx7Note::compute(int32_t *buf, int32_t lfo_val, int32_t lfo_delay, const Controllers *ctrls, int32_t *buf2) {
   // ==== PITCH ====
   uint32_t pmd = pitchmoddepth_ * lfo_delay;  // Q32
   int32_t senslfo = pitchmodsens_ * (lfo_val - (1 << 23));
@@ -245,19 +275,34 @@ void Dx7Note::compute(int32_t *buf, int32_t lfo_val, int32_t lfo_delay, const Co
   uint32_t amod_3 = (ctrls->eg_mod + 1) << 17;
   amd_mod = std::max((1 << 24) - amod_3, amd_mod);
 
+  // ==== LEVEL / FEEDBACK RAMPS ====
+  for (int op = 0; op < 6; op++) {
+    int32_t diff = levelTarget_[op] - levelOffset_[op];
+    if (diff != 0) {
+      int32_t step = diff >> LEVEL_RAMP_SHIFT;
+      levelOffset_[op] += step != 0 ? step : diff;
+    }
+  }
+  // Feedback is a shift, so it walks one step (6 dB) per block
+  if (fb_shift_ != fb_shift_target_) {
+    fb_shift_ += fb_shift_ < fb_shift_target_ ? 1 : -1;
+  }
+
   // ==== OP RENDER ====
+  int32_t logfreq[6];
   for (int op = 0; op < 6; op++) {
     // if ( ctrls->opSwitch[op] == '0' )  {
     if (!(ctrls->opSwitch & (1 << op)))  {
       env_[op].getsample(); // advance the envelop even if it is not playing
       params_[op].level_in = 0;
+      logfreq[op] = 0;
     } else {
       //int32_t gain = pow(2, 10 + level * (1.0 / (1 << 24)));
 
       int32_t basepitch = basepitch_[op];
 
       if (opMode[op]) {
-        params_[op].freq = Freqlut::lookup(basepitch + pitch_base);
+        logfreq[op] = basepitch + pitch_base;
       } else {
         // If portamento is enabled but there is no transition, use basepitch_
         if (porta_rateindex_ >= 0) {
@@ -268,10 +313,16 @@ void Dx7Note::compute(int32_t *buf, int32_t lfo_val, int32_t lfo_delay, const Co
           }
           // else: no transition, use basepitch_ as is
         }
-        params_[op].freq = Freqlut::lookup(basepitch + pitch_mod);
+        logfreq[op] = basepitch + pitch_mod;
       }
+      params_[op].freq = Freqlut::lookup(logfreq[op] + unisonDetune_[0]);
 
       int32_t level = env_[op].getsample();
+      // Output level changes since note on: an offset in the log domain is
+      // exactly what a different outlevel would have given the envelope
+      if (levelOffset_[op] != 0 && level > ENV_FLOOR) {
+        level = std::max(level + levelOffset_[op], ENV_FLOOR);
+      }
       if (ampmodsens_[op] != 0) {
         uint32_t sensamp = (uint32_t)(((uint64_t) amd_mod) * ((uint64_t) ampmodsens_[op]) >> 24);
 
@@ -305,6 +356,18 @@ void Dx7Note::compute(int32_t *buf, int32_t lfo_val, int32_t lfo_delay, const Co
   }
 
   ctrls->core->render(buf, params_, algorithm_, fb_buf_, fb_shift_);
+
+  // ==== UNISON ====
+  // The other copies reuse the levels computed above
+  for (int u = 1; u < unison_; u++) {
+    FmOpParams *params = unisonParams_[u - 1];
+    for (int op = 0; op < 6; op++) {
+      params[op].level_in = params_[op].level_in;
+      params[op].freq = Freqlut::lookup(logfreq[op] + unisonDetune_[u]);
+    }
+    int32_t *out = (buf2 != NULL && (u & 1)) ? buf2 : buf;
+    ctrls->core->render(out, params, algorithm_, unisonFb_[u - 1], fb_shift_);
+  }
 }
 
 void Dx7Note::keyup() {
@@ -338,21 +401,17 @@ void Dx7Note::update(const uint8_t patch[156], int midinote, int velocity, int p
       rates[i] = patch[off + i];
       levels[i] = patch[off + 4 + i];
     }
-    int outlevel = patch[off + 16];
-    outlevel = Env::scaleoutlevel(outlevel);
-    int level_scaling = ScaleLevel(midinote, patch[off + 8], patch[off + 9],
-                                   patch[off + 10], patch[off + 11], patch[off + 12]);
-    outlevel += level_scaling;
-    outlevel = std::min(127, outlevel);
-    outlevel = outlevel << 5;
-    outlevel += ScaleVelocity(velocity, patch[off + 15]);
-    outlevel = std::max(0, outlevel);
+    int outlevel = op_outlevel(patch, off, midinote, velocity);
+    envOutlevel_[op] = outlevel;
+    levelOffset_[op] = 0;
+    levelTarget_[op] = 0;
     int rate_scaling = ScaleRate(midinote, patch[off + 13]);
     env_[op].update((const int32_t*)rates, (const int32_t*)levels, (int32_t)outlevel, rate_scaling);
   }
   algorithm_ = patch[134];
   int feedback = patch[135];
   fb_shift_ = feedback != 0 ? FEEDBACK_BITDEPTH - feedback : 16;
+  fb_shift_target_ = fb_shift_;
   pitchmoddepth_ = (patch[139] * 165) >> 6;
   pitchmodsens_ = pitchmodsenstab[patch[143] & 7];
   ampmoddepth_ = (patch[140] * 165) >> 6;
@@ -361,6 +420,15 @@ void Dx7Note::update(const uint8_t patch[156], int midinote, int velocity, int p
 
 }
 
+void Dx7Note::updateLevels(const uint8_t patch[156], int midinote, int velocity) {
+  for (int op = 0; op < 6; op++) {
+    int outlevel = op_outlevel(patch, op * 21, midinote, velocity);
+    levelTarget_[op] = (outlevel - envOutlevel_[op]) << 16;
+  }
+  int feedback = patch[135];
+  fb_shift_target_ = feedback != 0 ? FEEDBACK_BITDEPTH - feedback : 16;
+}
+
 void Dx7Note::peekVoiceStatus(VoiceStatus &status) {
   for (int i = 0; i < 6; i++) {
     status.amp[i] = Exp2::lookup(params_[i].level_in - (14 * (1 << 24)));
@@ -375,9 +443,13 @@ void Dx7Note::peekVoiceStatus(VoiceStatus &status) {
 void Dx7Note::transferState(Dx7Note &src) {
   for (int i = 0; i < 6; i++) {
     env_[i].transfer(src.env_[i]);
+    envOutlevel_[i] = src.envOutlevel_[i];
+    levelOffset_[i] = src.levelOffset_[i];
+    levelTarget_[i] = src.levelTarget_[i];
     params_[i].gain_out = src.params_[i].gain_out;
     params_[i].phase = src.params_[i].phase;
   }
+  transferUnison(src);
 }
 
 void Dx7Note::transferSignal(Dx7Note &src) {
@@ -385,6 +457,18 @@ void Dx7Note::transferSignal(Dx7Note &src) {
     params_[i].gain_out = src.params_[i].gain_out;
     params_[i].phase = src.params_[i].phase;
   }
+  transferUnison(src);
+}
+
+void Dx7Note::transferUnison(Dx7Note &src) {
+  for (int u = 0; u < DEXED_UNISON_MAX - 1; u++) {
+    for (int i = 0; i < 6; i++) {
+      unisonParams_[u][i].gain_out = src.unisonParams_[u][i].gain_out;
+      unisonParams_[u][i].phase = src.unisonParams_[u][i].phase;
+    }
+    unisonFb_[u][0] = src.unisonFb_[u][0];
+    unisonFb_[u][1] = src.unisonFb_[u][1];
+  }
 }
 
 void Dx7Note::transferPortamento(Dx7Note &src) {
@@ -398,4 +482,20 @@ void Dx7Note::oscSync() {
     params_[i].gain_out = 0;
     params_[i].phase = 0;
   }
+  // Copies start a fraction of a cycle apart so the attack doesn't sum in phase
+  for (int u = 0; u < DEXED_UNISON_MAX - 1; u++) {
+    for (int i = 0; i < 6; i++) {
+      unisonParams_[u][i].gain_out = 0;
+      unisonParams_[u][i].phase = (u + 1) << 22;
+    }
+  }
+}
+
+void Dx7Note::setUnison(int voices, int detune) {
+  unison_ = std::max(1, std::min(voices, DEXED_UNISON_MAX));
+  const int32_t cent = (1 << 24) / 1200;
+  for (int u = 0; u < DEXED_UNISON_MAX; u++) {
+    unisonDetune_[u] = (u < unison_ && unison_ > 1) ?
+      detune * cent * (2 * u - (unison_ - 1)) / (unison_ - 1) : 0;
+  }
 }
@@ -29,6 +29,11 @@
 #include "pitchenv.h"
 #include "fm_core.h"
 
+// Most detuned copies one note can stack in unison mode
+#ifndef DEXED_UNISON_MAX
+#define DEXED_UNISON_MAX 4
+#endif
+
 struct VoiceStatus {
   uint32_t amp[6];
   char ampStep[6];
@@ -42,7 +47,8 @@ class Dx7Note {
 
     // Note: this _adds_ to the buffer. Interesting question whether it's
     // worth it...
-    void compute(int32_t *buf, int32_t lfo_val, int32_t lfo_delay, const Controllers *ctrls);
+    // In unison, odd copies go to buf2 when it is given (for stereo spread).
+    void compute(int32_t *buf, int32_t lfo_val, int32_t lfo_delay, const Controllers *ctrls, int32_t *buf2 = NULL);
 
     void keyup();
 
@@ -53,12 +59,24 @@ class Dx7Note {
 
     // PG:add the update
     void update(const uint8_t patch[156], int midinote, int velocity, int porta, const Controllers *ctrls);
+
+    // Cheap real-time path for operator output levels and feedback: sets
+    // targets that compute() ramps towards over the next few blocks,
+    // without touching envelopes or pitch
+    void updateLevels(const uint8_t patch[156], int midinote, int velocity);
     void peekVoiceStatus(VoiceStatus &status);
     void transferState(Dx7Note& src);
     void transferSignal(Dx7Note &src);
     void transferPortamento(Dx7Note &src);
+    void transferUnison(Dx7Note &src);
     void oscSync();
 
+    // Unison: render several copies of the operator stack, spread evenly
+    // over +-detune cents. Envelopes, pitch EG, LFO and amp mod are worked
+    // out once per block and shared, only phases and frequencies differ.
+    void setUnison(int voices, int detune);
+    int getUnison() const { return unison_; }
+
   private:
     Env env_[6];
     FmOpParams params_[6];
@@ -66,9 +84,14 @@ class Dx7Note {
     int32_t basepitch_[6];
     int32_t fb_buf_[2]={0 ,0};
     int32_t fb_shift_;
+    int32_t fb_shift_target_;
     int32_t ampmodsens_[6];
     int32_t opMode[6];
 
+    int32_t envOutlevel_[6];   // outlevel the envelopes were given
+    int32_t levelOffset_[6];   // current level change since then (Q24 log)
+    int32_t levelTarget_[6];
+
     int ampmoddepth_;
     int algorithm_;
     int pitchmoddepth_;
@@ -77,6 +100,11 @@ class Dx7Note {
     int porta_rateindex_;
     int porta_gliss_;
     int32_t porta_curpitch_[6];
+
+    int unison_;
+    int32_t unisonDetune_[DEXED_UNISON_MAX];           // log frequency offset of each copy
+    FmOpParams unisonParams_[DEXED_UNISON_MAX - 1][6]; // copies 1.. (copy 0 is params_)
+    int32_t unisonFb_[DEXED_UNISON_MAX - 1][2];
 };
 
 #endif
@@ -296,9 +296,12 @@ AudioEffectFreeverbStereoFloat::AudioEffectFreeverbStereoFloat() : AudioStream(1
   comb6filterR = 0.0;
   comb7filterR = 0.0;
   comb8filterR = 0.0;
-  combdamp1 = 6553.0;
-  combdamp2 = 26215.0;
-  combfeeback = 27524.0;
+  // roomsize(0.5) and damping(0.5), on the normalised scale update() uses.
+  // These were on the x32768 scale, where a comb feedback of 27524 made the
+  // reverb run away until roomsize() and damping() were first called.
+  combdamp1 = 6553.0f / 32768.0f;
+  combdamp2 = 26215.0f / 32768.0f;
+  combfeeback = 27524.0f / 32768.0f;
   for (unsigned int i = 0; i < sizeof(allpass1bufL) / sizeof(float); i++) allpass1bufL[i] = 0.0;
   for (unsigned int i = 0; i < sizeof(allpass2bufL) / sizeof(float); i++) allpass2bufL[i] = 0.0;
   for (unsigned int i = 0; i < sizeof(allpass3bufL) / sizeof(float); i++) allpass3bufL[i] = 0.0;
@@ -450,47 +453,47 @@ void AudioEffectFreeverbStereoFloat::update()
     outputR = sum;
 
     bufout = allpass1bufL[allpass1indexL];
-    allpass1bufL[allpass1indexL] = outputL + (bufout / 2.0);
-    outputL = (bufout - outputL) / 2.0;
+    allpass1bufL[allpass1indexL] = outputL + (bufout * 0.5f);
+    outputL = (bufout - outputL) * 0.5f;
     if (++allpass1indexL >= sizeof(allpass1bufL) / sizeof(float)) allpass1indexL = 0;
 
     bufout = allpass2bufL[allpass2indexL];
-    allpass2bufL[allpass2indexL] = outputL + (bufout / 2.0);
-    outputL = (bufout - outputL) / 2.0;
+    allpass2bufL[allpass2indexL] = outputL + (bufout * 0.5f);
+    outputL = (bufout - outputL) * 0.5f;
     if (++allpass2indexL >= sizeof(allpass2bufL) / sizeof(float)) allpass2indexL = 0;
 
     bufout = allpass3bufL[allpass3indexL];
-    allpass3bufL[allpass3indexL] = outputL + (bufout / 2.0);
-    outputL = (bufout - outputL) / 2.0;
+    allpass3bufL[allpass3indexL] = outputL + (bufout * 0.5f);
+    outputL = (bufout - outputL) * 0.5f;
     if (++allpass3indexL >= sizeof(allpass3bufL) / sizeof(float)) allpass3indexL = 0;
 
     bufout = allpass4bufL[allpass4indexL];
-    allpass4bufL[allpass4indexL] = outputL + (bufout / 2.0);
-    outputL = (bufout - outputL) / 2.0;
+    allpass4bufL[allpass4indexL] = outputL + (bufout * 0.5f);
+    outputL = (bufout - outputL) * 0.5f;
     if (++allpass4indexL >= sizeof(allpass4bufL) / sizeof(float)) allpass4indexL = 0;
 
     //outblockL->data[i] = sat16i(outputL * 30.0, 0);
     outblockL->data[i] = sat16i(outputL * 32768.0, 0);
 
     bufout = allpass1bufR[allpass1indexR];
-    allpass1bufR[allpass1indexR] = outputR + (bufout / 2.0);
+    allpass1bufR[allpass1indexR] = outputR + (bufout * 0.5f);
     //outputR = sat16(bufout - outputR, 1);
-    outputR = (bufout - outputR) / 2.0;
+    outputR = (bufout - outputR) * 0.5f;
     if (++allpass1indexR >= sizeof(allpass1bufR) / sizeof(float)) allpass1indexR = 0;
 
     bufout = allpass2bufR[allpass2indexR];
-    allpass2bufR[allpass2indexR] = outputR + (bufout / 2.0);
-    outputR = (bufout - outputR) / 2.0;
+    allpass2bufR[allpass2indexR] = outputR + (bufout * 0.5f);
+    outputR = (bufout - outputR) * 0.5f;
     if (++allpass2indexR >= sizeof(allpass2bufR) / sizeof(float)) allpass2indexR = 0;
 
     bufout = allpass3bufR[allpass3indexR];
-    allpass3bufR[allpass3indexR] = outputR + (bufout / 2.0);
-    outputR = (bufout - outputR) / 2.0;
+    allpass3bufR[allpass3indexR] = outputR + (bufout * 0.5f);
+    outputR = (bufout - outputR) * 0.5f;
     if (++allpass3indexR >= sizeof(allpass3bufR) / sizeof(float)) allpass3indexR = 0;
 
     bufout = allpass4bufR[allpass4indexR];
-    allpass4bufR[allpass4indexR] = outputR + (bufout / 2.0);
-    outputR = (bufout - outputR) / 2.0;
+    allpass4bufR[allpass4indexR] = outputR + (bufout * 0.5f);
+    outputR = (bufout - outputR) * 0.5f;
     if (++allpass4indexR >= sizeof(allpass4bufR) / sizeof(float)) allpass4indexR = 0;
 
     //outblockR->data[i] = sat16i(outputR * 30.0, 0);
@@ -0,0 +1,306 @@
+/*  Stereo plate reverb for Teensy 4, fixed-point version
+ *
+ *  Same topology and controls as AudioEffectPlateReverb (effect_platervbstereo),
+ *  which is based on the plate reverbs developed for the SpinSemi FV-1 by
+ *  Piotr Zapart (www.hexefx.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <Arduino.h>
+#include "effect_platervbstereo_q15.h"
+#include "utility/dspinst.h"
+
+#define INP_ALLP_COEFF      (0.65f)             // default input allpass coeff
+#define LOOP_ALLOP_COEFF    (0.65f)             // default loop allpass coeff
+
+#define HI_LOSS_FREQ        (0.3f)              // scaled center freq for the treble loss filter
+#define LO_LOSS_FREQ        (0.06f)             // scaled center freq for the bass loss filter
+
+#define LFO_AMPL_BITS       (5)                         // 2^LFO_AMPL_BITS will be the LFO amplitude
+#define LFO_FRAC_BITS       (16 - LFO_AMPL_BITS)        // fractional part used for linear interpolation
+#define LFO_FRAC_MASK       ((1 << LFO_FRAC_BITS) - 1)  // mask for the above
+
+#define LFO1_FREQ_HZ        (1.37f)             // LFO1 frequency in Hz
+#define LFO2_FREQ_HZ        (1.52f)             // LFO2 frequency in Hz
+
+#define RV_MASTER_LOWPASS_F (0.6f)              // master lowpass scaled frequency coeff.
+
+// Network samples are half scale: an audio sample >> 1, 1.0 = 16384.
+// Filter states carry 8 more bits (Q22) so slow filters don't stall.
+#define STATE_BITS          8
+
+#define sat16(n)            signed_saturate_rshift((n), 16, 0)
+
+extern "C" {
+extern const int16_t AudioWaveformSine[257];
+}
+
+// Tap gains 0.8, 0.7 (L/R tap 1, 2) and 0.6, 0.5 (tap 3, 4), packed for SMLAD
+#define TAP_GAINS_12        pack_16b_16b(26214, 22938)
+#define TAP_GAINS_34        pack_16b_16b(19661, 16384)
+
+// Allpass with a 16 bit line: acc = buf + k*in, buf = in - k*acc, rounded
+// so the loop does not drift on truncation bias
+static inline int32_t allpass(int16_t *buf, uint16_t &idx, uint16_t len, int32_t input, int32_t k)
+{
+    int32_t acc = sat16(buf[idx] + ((input * k + 0x4000) >> 15));
+    buf[idx] = sat16(input - ((k * acc + 0x4000) >> 15));
+    if (++idx >= len) idx = 0;
+    return acc;
+}
+
+// Plain delay line: read the end, write the new sample
+static inline int32_t delay_line(int16_t *buf, uint16_t &idx, uint16_t len, int32_t input)
+{
+    int32_t out = buf[idx];
+    buf[idx] = input;
+    if (++idx >= len) idx = 0;
+    return out;
+}
+
+// Linear interpolated read, lfo_pos sets the offset and lfo_frac the fraction.
+// Offsets are below the line length and the LFO adds +-16, so one wrap test does.
+static inline int32_t tap(const int16_t *buf, uint16_t len, uint32_t pos, int16_t lfo_pos, int16_t lfo_frac)
+{
+    uint32_t i0 = pos + (lfo_pos >> LFO_FRAC_BITS);
+    if (i0 >= len) i0 -= len;
+    uint32_t i1 = i0 + 1;
+    if (i1 >= len) i1 = 0;
+    int32_t f = (lfo_frac & LFO_FRAC_MASK) << (15 - LFO_FRAC_BITS);
+    return multiply_16tx16t_add_16bx16b(pack_16b_16b(buf[i0], buf[i1]), pack_16b_16b(0x7FFF - f, f)) >> 15;
+}
+
+static inline uint32_t wrap(uint32_t pos, uint16_t len)
+{
+    return pos >= len ? pos - len : pos;
+}
+
+// One LFO step, sine and the coarse cosine the float version uses
+static inline void lfo(uint32_t &phase, uint32_t adder, int16_t &out_sin, int16_t &out_cos)
+{
+    phase += adder;
+    uint32_t idx = phase >> 24;                 // 8bit lookup table address
+    int64_t y = (int64_t)AudioWaveformSine[idx] * (0x00FFFFFF - (phase & 0x00FFFFFF));
+    y += (int64_t)AudioWaveformSine[idx + 1] * (phase & 0x00FFFFFF);
+    out_sin = (int32_t)(y >> (32 - 8));
+    idx = ((phase >> 24) + 64) & 0xFF;
+    y = (int64_t)AudioWaveformSine[idx] * (0x00FFFFFF - idx);
+    y += (int64_t)AudioWaveformSine[idx + 1] * idx;
+    out_cos = (int32_t)(y >> (32 - 8));
+}
+
+AudioEffectPlateReverbQ15::AudioEffectPlateReverbQ15() : AudioStream(2, inputQueueArray)
+{
+    clear();
+
+    in_allp_k = q15(INP_ALLP_COEFF);
+    loop_allp_k = q15(LOOP_ALLOP_COEFF);
+
+    lp_hidamp_k = q15(1.0f);
+    lp_lodamp_k = 0;
+
+    lp_lowpass_f = q15(HI_LOSS_FREQ);
+    lp_hipass_f = q15(LO_LOSS_FREQ);
+
+    master_lowpass_f = q15(RV_MASTER_LOWPASS_F);
+
+    rv_time_scaler = 1.0f;
+    rv_time_k = 0.2f;
+    input_attn = q15(0.5f);
+    loop_gain = q15(rv_time_k * rv_time_scaler);
+
+    lfo1_phase_acc = 0;
+    lfo1_adder = (UINT32_MAX + 1) / (AUDIO_SAMPLE_RATE_EXACT * LFO1_FREQ_HZ);
+    lfo2_phase_acc = 0;
+    lfo2_adder = (UINT32_MAX + 1) / (AUDIO_SAMPLE_RATE_EXACT * LFO2_FREQ_HZ);
+}
+
+void AudioEffectPlateReverbQ15::clear(void)
+{
+    memset(in_allp1_bufL, 0, sizeof(in_allp1_bufL));
+    memset(in_allp2_bufL, 0, sizeof(in_allp2_bufL));
+    memset(in_allp3_bufL, 0, sizeof(in_allp3_bufL));
+    memset(in_allp4_bufL, 0, sizeof(in_allp4_bufL));
+    memset(in_allp1_bufR, 0, sizeof(in_allp1_bufR));
+    memset(in_allp2_bufR, 0, sizeof(in_allp2_bufR));
+    memset(in_allp3_bufR, 0, sizeof(in_allp3_bufR));
+    memset(in_allp4_bufR, 0, sizeof(in_allp4_bufR));
+    memset(lp_allp1_buf, 0, sizeof(lp_allp1_buf));
+    memset(lp_allp2_buf, 0, sizeof(lp_allp2_buf));
+    memset(lp_allp3_buf, 0, sizeof(lp_allp3_buf));
+    memset(lp_allp4_buf, 0, sizeof(lp_allp4_buf));
+    memset(lp_dly1_buf, 0, sizeof(lp_dly1_buf));
+    memset(lp_dly2_buf, 0, sizeof(lp_dly2_buf));
+    memset(lp_dly3_buf, 0, sizeof(lp_dly3_buf));
+    memset(lp_dly4_buf, 0, sizeof(lp_dly4_buf));
+
+    in_allp1_idxL = in_allp2_idxL = in_allp3_idxL = in_allp4_idxL = 0;
+    in_allp1_idxR = in_allp2_idxR = in_allp3_idxR = in_allp4_idxR = 0;
+    lp_allp1_idx = lp_allp2_idx = lp_allp3_idx = lp_allp4_idx = 0;
+    lp_dly1_idx = lp_dly2_idx = lp_dly3_idx = lp_dly4_idx = 0;
+    in_allp_out_L = in_allp_out_R = lp_allp_out = 0;
+
+    lpf1 = lpf2 = lpf3 = lpf4 = 0;
+    hpf1 = hpf2 = hpf3 = hpf4 = 0;
+    master_lowpass_l = master_lowpass_r = 0;
+}
+
+// Hi/lo shelving filter and reverb time scaling of one loop delay output
+inline int32_t AudioEffectPlateReverbQ15::shelve(int32_t input, int32_t &lpf, int32_t &hpf)
+{
+    int32_t x = input << STATE_BITS;
+    lpf += signed_multiply_32x16b(x - lpf, lp_lowpass_f) << 1;
+    int32_t hi = (x - lpf) >> STATE_BITS;
+    hpf += signed_multiply_32x16b(lpf - hpf, lp_hipass_f) << 1;
+    // hi band * hidamp + low band * lodamp in one dual multiply
+    int32_t damp = multiply_16tx16t_add_16bx16b(pack_16b_16b(sat16(hi), sat16(hpf >> STATE_BITS)),
+                                                pack_16b_16b(lp_hidamp_k, lp_lodamp_k));
+    int32_t acc = lpf + (damp >> (15 - STATE_BITS));
+    acc = signed_multiply_32x16b(acc, loop_gain) << 1;
+    return (acc + (1 << (STATE_BITS - 1))) >> STATE_BITS;
+}
+
+void AudioEffectPlateReverbQ15::update()
+{
+#if defined(__ARM_ARCH_7EM__)
+    audio_block_t *blockL, *blockR;
+    audio_block_t *outblockL, *outblockR;
+    int16_t lfo1_out_sin, lfo1_out_cos, lfo2_out_sin, lfo2_out_cos;
+    int32_t input, acc;
+
+    // handle bypass, 1st call will clean the buffers to avoid continuing the previous reverb tail
+    if (bypass)
+    {
+        if (!cleanup_done)
+        {
+            clear();
+            cleanup_done = true;
+        }
+        blockL = receiveReadOnly(0);
+        blockR = receiveReadOnly(1);
+        if (blockL)
+        {
+            transmit(blockL, 0);
+            release(blockL);
+        }
+        if (blockR)
+        {
+            transmit(blockR, 1);
+            release(blockR);
+        }
+        return;
+    }
+    cleanup_done = false;
+
+    blockL = receiveReadOnly(0);
+    blockR = receiveReadOnly(1);
+    outblockL = allocate();
+    outblockR = allocate();
+    if (!outblockL || !outblockR)
+    {
+        if (outblockL) release(outblockL);
+        if (outblockR) release(outblockR);
+        if (blockL) release(blockL);
+        if (blockR) release(blockR);
+        return;
+    }
+
+    const int32_t attn = input_attn;
+    const int32_t in_k = in_allp_k;
+    const int32_t lp_k = loop_allp_k;
+    const int16_t master_f = master_lowpass_f;
+
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++)
+    {
+        lfo(lfo1_phase_acc, lfo1_adder, lfo1_out_sin, lfo1_out_cos);
+        lfo(lfo2_phase_acc, lfo2_adder, lfo2_out_sin, lfo2_out_cos);
+
+        // chained input allpasses, channel L; Q15 * Q15 >> 16 lands at half scale
+        input = blockL ? (blockL->data[i] * attn) >> 16 : 0;
+        input = allpass(in_allp1_bufL, in_allp1_idxL, sizeof(in_allp1_bufL) / sizeof(int16_t), input, in_k);
+        input = allpass(in_allp2_bufL, in_allp2_idxL, sizeof(in_allp2_bufL) / sizeof(int16_t), input, in_k);
+        input = allpass(in_allp3_bufL, in_allp3_idxL, sizeof(in_allp3_bufL) / sizeof(int16_t), input, in_k);
+        in_allp_out_L = allpass(in_allp4_bufL, in_allp4_idxL, sizeof(in_allp4_bufL) / sizeof(int16_t), input, in_k);
+
+        // chained input allpasses, channel R
+        input = blockR ? (blockR->data[i] * attn) >> 16 : 0;
+        input = allpass(in_allp1_bufR, in_allp1_idxR, sizeof(in_allp1_bufR) / sizeof(int16_t), input, in_k);
+        input = allpass(in_allp2_bufR, in_allp2_idxR, sizeof(in_allp2_bufR) / sizeof(int16_t), input, in_k);
+        input = allpass(in_allp3_bufR, in_allp3_idxR, sizeof(in_allp3_bufR) / sizeof(int16_t), input, in_k);
+        in_allp_out_R = allpass(in_allp4_bufR, in_allp4_idxR, sizeof(in_allp4_bufR) / sizeof(int16_t), input, in_k);
+
+        // input allpases done, start loop allpases
+        input = sat16(lp_allp_out + in_allp_out_R);
+        input = allpass(lp_allp1_buf, lp_allp1_idx, sizeof(lp_allp1_buf) / sizeof(int16_t), input, lp_k);
+        input = delay_line(lp_dly1_buf, lp_dly1_idx, sizeof(lp_dly1_buf) / sizeof(int16_t), input);
+        acc = shelve(input, lpf1, hpf1);
+
+        input = sat16(acc + in_allp_out_L);
+        input = allpass(lp_allp2_buf, lp_allp2_idx, sizeof(lp_allp2_buf) / sizeof(int16_t), input, lp_k);
+        input = delay_line(lp_dly2_buf, lp_dly2_idx, sizeof(lp_dly2_buf) / sizeof(int16_t), input);
+        acc = shelve(input, lpf2, hpf2);
+
+        input = sat16(acc + in_allp_out_R);
+        input = allpass(lp_allp3_buf, lp_allp3_idx, sizeof(lp_allp3_buf) / sizeof(int16_t), input, lp_k);
+        input = delay_line(lp_dly3_buf, lp_dly3_idx, sizeof(lp_dly3_buf) / sizeof(int16_t), input);
+        acc = shelve(input, lpf3, hpf3);
+
+        input = sat16(acc + in_allp_out_L);
+        input = allpass(lp_allp4_buf, lp_allp4_idx, sizeof(lp_allp4_buf) / sizeof(int16_t), input, lp_k);
+        input = delay_line(lp_dly4_buf, lp_dly4_idx, sizeof(lp_dly4_buf) / sizeof(int16_t), input);
+        lp_allp_out = sat16(shelve(input, lpf4, hpf4));
+
+        // channel L: taps weighted pairwise, then the master lowpass
+        int32_t t1 = lp_dly1_buf[wrap(lp_dly1_idx + lp_dly1_offset_L, sizeof(lp_dly1_buf) / sizeof(int16_t))];
+        int32_t t2 = tap(lp_dly2_buf, sizeof(lp_dly2_buf) / sizeof(int16_t), lp_dly2_idx + lp_dly2_offset_L, lfo1_out_sin, lfo1_out_sin);
+        int32_t t3 = tap(lp_dly3_buf, sizeof(lp_dly3_buf) / sizeof(int16_t), lp_dly3_idx + lp_dly3_offset_L, lfo2_out_cos, lfo2_out_cos);
+        int32_t t4 = tap(lp_dly4_buf, sizeof(lp_dly4_buf) / sizeof(int16_t), lp_dly4_idx + lp_dly4_offset_L, lfo2_out_sin, lfo2_out_sin);
+        acc = multiply_16tx16t_add_16bx16b(pack_16b_16b(t1, sat16(t2)), TAP_GAINS_12);
+        acc = multiply_accumulate_16tx16t_add_16bx16b(acc, pack_16b_16b(sat16(t3), sat16(t4)), TAP_GAINS_34);
+        acc >>= 15 - STATE_BITS;
+        master_lowpass_l += signed_multiply_32x16b(acc - master_lowpass_l, master_f) << 1;
+        outblockL->data[i] = sat16(master_lowpass_l >> (STATE_BITS - 1));
+
+        // channel R
+        t1 = lp_dly1_buf[wrap(lp_dly1_idx + lp_dly1_offset_R, sizeof(lp_dly1_buf) / sizeof(int16_t))];
+        t2 = tap(lp_dly2_buf, sizeof(lp_dly2_buf) / sizeof(int16_t), lp_dly2_idx + lp_dly2_offset_R, lfo1_out_cos, lfo1_out_cos);
+        t3 = tap(lp_dly3_buf, sizeof(lp_dly3_buf) / sizeof(int16_t), lp_dly3_idx + lp_dly3_offset_R, lfo2_out_sin, lfo2_out_sin);
+        t4 = tap(lp_dly4_buf, sizeof(lp_dly4_buf) / sizeof(int16_t), lp_dly4_idx + lp_dly4_offset_R, lfo1_out_sin, lfo2_out_cos);
+        acc = multiply_16tx16t_add_16bx16b(pack_16b_16b(t1, sat16(t2)), TAP_GAINS_12);
+        acc = multiply_accumulate_16tx16t_add_16bx16b(acc, pack_16b_16b(sat16(t3), sat16(t4)), TAP_GAINS_34);
+        acc >>= 15 - STATE_BITS;
+        master_lowpass_r += signed_multiply_32x16b(acc - master_lowpass_r, master_f) << 1;
+        outblockR->data[i] = sat16(master_lowpass_r >> (STATE_BITS - 1));
+    }
+    transmit(outblockL, 0);
+    transmit(outblockR, 1);
+    release(outblockL);
+    release(outblockR);
+    if (blockL) release(blockL);
+    if (blockR) release(blockR);
+
+#elif defined(KINETISL)
+    audio_block_t *block;
+    block = receiveReadOnly(0);
+    if (block) release(block);
+    block = receiveReadOnly(1);
+    if (block) release(block);
+#endif
+}
@@ -0,0 +1,199 @@
+/*  Stereo plate reverb for Teensy 4, fixed-point version
+ *
+ *  Same topology and controls as AudioEffectPlateReverb (effect_platervbstereo),
+ *  which is based on the plate reverbs developed for the SpinSemi FV-1 by
+ *  Piotr Zapart (www.hexefx.com).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/***
+ * Differences to the float version:
+ *
+ * - audio blocks are used as they are, no conversion to float
+ * - all allpass and delay lines are int16, at half scale (1.0 = 16384) for
+ *   6 dB of headroom inside the network; 65 KB instead of 129 KB
+ * - the lines are members, so a global instance sits in RAM1 (DTCM) and
+ *   leaves RAM2 to the audio blocks and voice data
+ * - tap interpolation, damping and the output tap mix are 16x16 dual
+ *   multiplies (SMUAD/SMLAD); filter states are kept in 32 bits
+ * - taps follow the float default: tap 1 fixed, taps 2-4 modulated
+ *
+ * Input parameters are float in range 0.0 to 1.0, as for AudioEffectPlateReverb:
+ * size, hidamp, lodamp, lowpass, diffusion
+ */
+
+#ifndef _EFFECT_PLATERVBSTEREO_Q15_H
+#define _EFFECT_PLATERVBSTEREO_Q15_H
+
+#include <Arduino.h>
+#include "Audio.h"
+#include "AudioStream.h"
+
+class AudioEffectPlateReverbQ15 : public AudioStream
+{
+public:
+    AudioEffectPlateReverbQ15();
+    virtual void update();
+
+    void size(float n)
+    {
+        n = constrain(n, 0.0f, 1.0f);
+        n = map(n, 0.0f, 1.0f, 0.2f, rv_time_k_max);
+        float attn = map(n, 0.0f, rv_time_k_max, 0.5f, 0.25f);
+        __disable_irq();
+        rv_time_k = n;
+        input_attn = q15(attn);
+        loop_gain = q15(rv_time_k * rv_time_scaler);
+        __enable_irq();
+    }
+
+    void hidamp(float n)
+    {
+        n = constrain(n, 0.0f, 1.0f);
+        lp_hidamp_k = q15(1.0f - n);
+    }
+
+    void lodamp(float n)
+    {
+        n = constrain(n, 0.0f, 1.0f);
+        __disable_irq();
+        lp_lodamp_k = -q15(n);
+        rv_time_scaler = 1.0f - n * 0.12f;        // limit the max reverb time, otherwise it will clip
+        loop_gain = q15(rv_time_k * rv_time_scaler);
+        __enable_irq();
+    }
+
+    void lowpass(float n)
+    {
+        n = constrain(n, 0.0f, 1.0f);
+        n = map(n*n*n, 0.0f, 1.0f, 0.05f, 1.0f);
+        master_lowpass_f = q15(n);
+    }
+
+    void diffusion(float n)
+    {
+        n = constrain(n, 0.0f, 1.0f);
+        n = map(n, 0.0f, 1.0f, 0.005f, 0.65f);
+        __disable_irq();
+        in_allp_k = q15(n);
+        loop_allp_k = q15(n);
+        __enable_irq();
+    }
+
+    float get_size(void) {return rv_time_k;}
+    bool get_bypass(void) {return bypass;}
+    void set_bypass(bool state) {bypass = state;};
+    void tgl_bypass(void) {bypass ^=1;}
+
+private:
+    static int16_t q15(float n) { return (int16_t)constrain(n * 32768.0f, -32767.0f, 32767.0f); }
+    void clear(void);
+    int32_t shelve(int32_t input, int32_t &lpf, int32_t &hpf);
+
+    bool bypass = false;
+    bool cleanup_done = false;
+    audio_block_t *inputQueueArray[2];
+
+    int16_t input_attn;
+
+    int16_t in_allp_k;              // input allpass coeff
+    int16_t in_allp1_bufL[224];     // input allpass buffers
+    int16_t in_allp2_bufL[420];
+    int16_t in_allp3_bufL[856];
+    int16_t in_allp4_bufL[1089];
+    uint16_t in_allp1_idxL;
+    uint16_t in_allp2_idxL;
+    uint16_t in_allp3_idxL;
+    uint16_t in_allp4_idxL;
+    int16_t in_allp_out_L;          // L allpass chain output
+
+    int16_t in_allp1_bufR[156];     // input allpass buffers
+    int16_t in_allp2_bufR[520];
+    int16_t in_allp3_bufR[956];
+    int16_t in_allp4_bufR[1289];
+    uint16_t in_allp1_idxR;
+    uint16_t in_allp2_idxR;
+    uint16_t in_allp3_idxR;
+    uint16_t in_allp4_idxR;
+    int16_t in_allp_out_R;          // R allpass chain output
+
+    int16_t lp_allp1_buf[2303];     // loop allpass buffers
+    int16_t lp_allp2_buf[2905];
+    int16_t lp_allp3_buf[3175];
+    int16_t lp_allp4_buf[2398];
+    uint16_t lp_allp1_idx;
+    uint16_t lp_allp2_idx;
+    uint16_t lp_allp3_idx;
+    uint16_t lp_allp4_idx;
+    int16_t loop_allp_k;            // loop allpass coeff
+    int16_t lp_allp_out;
+
+    int16_t lp_dly1_buf[3423];
+    int16_t lp_dly2_buf[4589];
+    int16_t lp_dly3_buf[4365];
+    int16_t lp_dly4_buf[3698];
+    uint16_t lp_dly1_idx;
+    uint16_t lp_dly2_idx;
+    uint16_t lp_dly3_idx;
+    uint16_t lp_dly4_idx;
+
+    const uint16_t lp_dly1_offset_L = 201;      // delay line tap offets
+    const uint16_t lp_dly2_offset_L = 145;
+    const uint16_t lp_dly3_offset_L = 1897;
+    const uint16_t lp_dly4_offset_L = 280;
+
+    const uint16_t lp_dly1_offset_R = 1897;
+    const uint16_t lp_dly2_offset_R = 1245;
+    const uint16_t lp_dly3_offset_R = 487;
+    const uint16_t lp_dly4_offset_R = 780;
+
+    int16_t lp_hidamp_k;            // loop high band damping coeff
+    int16_t lp_lodamp_k;            // loop low band damping coeff
+
+    int32_t lpf1;                   // lowpass filters, Q22
+    int32_t lpf2;
+    int32_t lpf3;
+    int32_t lpf4;
+
+    int32_t hpf1;                   // highpass filters, Q22
+    int32_t hpf2;
+    int32_t hpf3;
+    int32_t hpf4;
+
+    int16_t lp_lowpass_f;           // loop lowpass scaled frequency
+    int16_t lp_hipass_f;            // loop highpass scaled frequency
+
+    int16_t master_lowpass_f;
+    int32_t master_lowpass_l;       // Q22
+    int32_t master_lowpass_r;
+
+    const float rv_time_k_max = 0.95f;
+    float rv_time_k;                // reverb time coeff
+    float rv_time_scaler;           // with high lodamp settings lower the max reverb time to avoid clipping
+    int16_t loop_gain;              // rv_time_k * rv_time_scaler
+
+    uint32_t lfo1_phase_acc;        // LFO 1
+    uint32_t lfo1_adder;
+
+    uint32_t lfo2_phase_acc;        // LFO 2
+    uint32_t lfo2_adder;
+};
+
+#endif // _EFFECT_PLATERVBSTEREO_Q15_H
@@ -38,6 +38,7 @@ void AudioSynthDexed::update(void)
 
   elapsedMicros render_time;
   audio_block_t *block;
+  audio_block_t *block_r = NULL;
 
   block = allocate();
 
@@ -47,7 +48,13 @@ void AudioSynthDexed::update(void)
     return;
   }
 
-  getSamples(block->data, AUDIO_BLOCK_SAMPLES);
+  if (stereo)
+    block_r = allocate();
+
+  if (block_r)
+    getSamples(block->data, block_r->data, AUDIO_BLOCK_SAMPLES);
+  else
+    getSamples(block->data, AUDIO_BLOCK_SAMPLES);
 
   if (render_time > audio_block_time_us) // everything greater audio_block_time_us (2.9ms for buffer size of 128) is a buffer underrun!
     xrun++;
@@ -56,6 +63,13 @@ void AudioSynthDexed::update(void)
     render_time_max = render_time;
 
   transmit(block, 0);
+  if (block_r)
+  {
+    transmit(block_r, 1);
+    release(block_r);
+  }
+  else
+    transmit(block, 1);
   release(block);
 
   in_update = false;
@@ -64,7 +64,12 @@ class AudioSynthDexed : public Dexed, public AudioStream
 
     AudioSynthDexed(uint8_t max_notes, uint16_t sample_rate) : Dexed(max_notes,sample_rate), AudioStream(0, NULL)  { };
 
+    // Output 0 is left, output 1 right. In mono both carry the same block.
+    void setStereo(bool enable) { stereo = enable; }
+    bool getStereo(void) { return stereo; }
+
   protected:
+    volatile bool stereo = false;
     const uint16_t audio_block_time_us = 1000000 / (DEXED_SAMPLE_RATE / AUDIO_BLOCK_SAMPLES);
     volatile bool in_update = false;
     void update(void);
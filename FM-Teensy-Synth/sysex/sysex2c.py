@@ -157,15 +157,15 @@ extern const char* BankNames[{len(sys.argv)}];
 """)
 
 if(decode==True):
-	print("extern uint8_t progmem_bank[%d][32][156];" % int(len(sys.argv)))
+	print("extern const uint8_t progmem_bank[%d][32][156];" % int(len(sys.argv)))
 	print("")
 	print("#ifdef DX7_IMPLEMENTATION")
-	print("uint8_t progmem_bank[%d][32][156] PROGMEM =\n{" % int(len(sys.argv)))
+	print("const uint8_t progmem_bank[%d][32][156] PROGMEM =\n{" % int(len(sys.argv)))
 else:
-	print("extern uint8_t progmem_bank[%d][32][128];" % int(len(sys.argv)))
+	print("extern const uint8_t progmem_bank[%d][32][128];" % int(len(sys.argv)))
 	print("")
 	print("#ifdef DX7_IMPLEMENTATION")
-	print("uint8_t progmem_bank[%d][32][128] PROGMEM =\n{" % int(len(sys.argv)))
+	print("const uint8_t progmem_bank[%d][32][128] PROGMEM =\n{" % int(len(sys.argv)))
 for sysex in sys.argv:
 	if(not os.path.isfile(sysex)):
 		print("* File "+sysex+" does not exists.")
@@ -0,0 +1,106 @@
+// Host comparison of the fixed-point plate reverb against the float one
+//
+//   make plate                        the settings below
+//   ./plate_reverb_compare SIZE HIDAMP LODAMP
+//
+// Feeds the same 4 s of bursts (a noisy sine left, a sine right, on for
+// 8000 samples every second) through AudioEffectPlateReverb and
+// AudioEffectPlateReverbQ15 and prints the SNR of the Q15 output against
+// the float output, the largest sample difference and host time per block.
+// The host times only compare runs of this harness: the stubs emulate the
+// dual multiplies that are single instructions on the Cortex-M7.
+
+#include "effect_platervbstereo.h"
+#include "effect_platervbstereo_q15.h"
+
+#include <chrono>
+#include <cstdlib>
+
+audio_block_t* hostIn[2];
+audio_block_t hostOut[2];
+
+struct Result {
+  double snr;
+  double peak;
+  int maxDiff;
+  double floatNs, q15Ns;
+};
+
+template <class Reverb>
+static void setup(Reverb& reverb, float size, float hidamp, float lodamp) {
+  reverb.size(size);
+  reverb.hidamp(hidamp);
+  reverb.lodamp(lodamp);
+  reverb.lowpass(0.7f);
+  reverb.diffusion(0.65f);
+}
+
+template <class Reverb>
+static double run(Reverb& reverb, audio_block_t* in, audio_block_t* out) {
+  hostIn[0] = &in[0];
+  hostIn[1] = &in[1];
+  auto start = std::chrono::steady_clock::now();
+  reverb.update();
+  auto end = std::chrono::steady_clock::now();
+  out[0] = hostOut[0];
+  out[1] = hostOut[1];
+  return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+static Result compare(float size, float hidamp, float lodamp) {
+  static AudioEffectPlateReverb reference;
+  static AudioEffectPlateReverbQ15 fixed;
+  setup(reference, size, hidamp, lodamp);
+  setup(fixed, size, hidamp, lodamp);
+
+  Result r = { 0, 0, 0, 0, 0 };
+  double signal = 0, error = 0;
+  audio_block_t in[2], outFloat[2], outQ15[2];
+  const int blocks = 44100 * 4 / AUDIO_BLOCK_SAMPLES;
+  srand(1);
+  for (int b = 0; b < blocks; b++) {
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+      int n = b * AUDIO_BLOCK_SAMPLES + i;
+      double env = (n % 44100) < 8000 ? 0.5 : 0.0;
+      double noise = 0.6 + 0.4 * ((rand() % 1000) / 1000.0);
+      in[0].data[i] = (int16_t)(env * 32767 * sin(n * 0.031) * noise);
+      in[1].data[i] = (int16_t)(env * 32767 * sin(n * 0.047 + 1));
+    }
+    r.floatNs += run(reference, in, outFloat);
+    r.q15Ns += run(fixed, in, outQ15);
+    for (int c = 0; c < 2; c++) {
+      for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        double a = outFloat[c].data[i];
+        double d = outQ15[c].data[i] - a;
+        signal += a * a;
+        error += d * d;
+        if (fabs(a) > r.peak) r.peak = fabs(a);
+        if (abs((int)d) > r.maxDiff) r.maxDiff = abs((int)d);
+      }
+    }
+  }
+  r.snr = 10 * log10(signal / error);
+  r.floatNs /= blocks;
+  r.q15Ns /= blocks;
+  return r;
+}
+
+static void print(float size, float hidamp, float lodamp) {
+  Result r = compare(size, hidamp, lodamp);
+  printf("size %.2f hidamp %.2f lodamp %.2f: SNR %5.1f dB, peak %5.0f, max diff %3d, "
+         "float %5.0f ns, q15 %5.0f ns per block\n",
+         size, hidamp, lodamp, r.snr, r.peak, r.maxDiff, r.floatNs, r.q15Ns);
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1) {
+    print(atof(argv[1]), argc > 2 ? atof(argv[2]) : 0.5f, argc > 3 ? atof(argv[3]) : 0.0f);
+    return 0;
+  }
+  print(0.3f, 0.5f, 0.0f);
+  print(0.5f, 0.5f, 0.0f);
+  print(0.7f, 0.5f, 0.0f);
+  print(0.7f, 0.2f, 0.3f);
+  print(1.0f, 0.5f, 0.0f);
+  return 0;
+}
@@ -0,0 +1,18 @@
+// Host stand-in for the parts of the Teensy core the effects use
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <stdio.h>
+
+typedef bool boolean;
+#define DMAMEM
+#define FLASHMEM
+#define F_CPU_ACTUAL 600000000
+#define constrain(a, l, h) ((a) < (l) ? (l) : ((a) > (h) ? (h) : (a)))
+template <class T> T map(T x, T inMin, T inMax, T outMin, T outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+inline unsigned long millis() { return 0; }
+inline void __disable_irq() {}
+inline void __enable_irq() {}
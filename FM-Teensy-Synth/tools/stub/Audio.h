@@ -0,0 +1,3 @@
+// Host stand-in for Audio.h: only what the effect headers name
+#pragma once
+#include <AudioStream.h>
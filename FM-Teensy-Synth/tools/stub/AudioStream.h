@@ -0,0 +1,40 @@
+// Host stand-in for AudioStream: update() reads hostIn[] and transmit()
+// copies into hostOut[], so a harness can drive one object block by block
+#pragma once
+#include <Arduino.h>
+
+#define AUDIO_BLOCK_SAMPLES 128
+#define AUDIO_SAMPLE_RATE_EXACT 44117.64706f
+
+struct audio_block_t {
+  uint8_t ref_count;
+  uint8_t reserved1;
+  uint16_t memory_pool_index;
+  int16_t data[AUDIO_BLOCK_SAMPLES];
+};
+
+extern audio_block_t* hostIn[2];
+extern audio_block_t hostOut[2];
+
+class AudioStream {
+public:
+  AudioStream(int inputs, audio_block_t** queue) { (void)inputs; (void)queue; }
+  virtual ~AudioStream() {}
+  virtual void update() = 0;
+
+protected:
+  audio_block_t* receiveReadOnly(int channel = 0) { return hostIn[channel]; }
+  audio_block_t* receiveWritable(int channel = 0) { return hostIn[channel]; }
+  void transmit(audio_block_t* block, int channel = 0) { hostOut[channel] = *block; }
+  static void release(const audio_block_t*) {}
+  static audio_block_t* allocate() {
+    static audio_block_t pool[4];
+    static int next = 0;
+    return &pool[next++ & 3];
+  }
+};
+
+class AudioConnection {
+public:
+  AudioConnection() {}
+};
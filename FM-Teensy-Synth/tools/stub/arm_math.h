@@ -0,0 +1,17 @@
+// Host stand-in for the CMSIS-DSP calls the effects use
+#pragma once
+#include <stdint.h>
+
+typedef float float32_t;
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+
+inline void arm_q15_to_float(const q15_t* src, float32_t* dst, uint32_t n) {
+  for (uint32_t i = 0; i < n; i++) dst[i] = src[i] / 32768.0f;
+}
+inline void arm_float_to_q15(const float32_t* src, q15_t* dst, uint32_t n) {
+  for (uint32_t i = 0; i < n; i++) {
+    float v = src[i] * 32768.0f;
+    dst[i] = v >= 32767.0f ? 32767 : (v <= -32768.0f ? -32768 : (q15_t)v);
+  }
+}
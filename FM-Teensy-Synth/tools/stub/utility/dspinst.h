@@ -0,0 +1,24 @@
+// Host stand-in for the Cortex-M DSP instructions in Teensy's dspinst.h
+#pragma once
+#include <stdint.h>
+
+static inline int32_t signed_saturate_rshift(int32_t val, int bits, int rshift) {
+  int32_t out = val >> rshift;
+  int32_t max = (1 << (bits - 1)) - 1, min = -(1 << (bits - 1));
+  return out > max ? max : (out < min ? min : out);
+}
+static inline int32_t signed_multiply_32x16b(int32_t a, uint32_t b) {
+  return ((int64_t)a * (int16_t)(b & 0xFFFF)) >> 16;
+}
+static inline int32_t signed_multiply_32x16t(int32_t a, uint32_t b) {
+  return ((int64_t)a * (int16_t)(b >> 16)) >> 16;
+}
+static inline uint32_t pack_16b_16b(int32_t a, int32_t b) {
+  return ((uint32_t)a << 16) | (b & 0xFFFF);
+}
+static inline int32_t multiply_16tx16t_add_16bx16b(uint32_t a, uint32_t b) {
+  return (int32_t)(int16_t)(a >> 16) * (int16_t)(b >> 16) + (int32_t)(int16_t)a * (int16_t)b;
+}
+static inline int32_t multiply_accumulate_16tx16t_add_16bx16b(int32_t sum, uint32_t a, uint32_t b) {
+  return sum + multiply_16tx16t_add_16bx16b(a, b);
+}
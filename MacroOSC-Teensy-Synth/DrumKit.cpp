@@ -0,0 +1,40 @@
+#include "DrumKit.h"
+#include "src/settings.h"
+
+using namespace braids;
+
+// For KICK timbre is the decay of the body and color its tone; for SNARE
+// the tone/noise balance and the snap; for CYMBAL the cutoff and the
+// noise/metal mix; for the struck shapes the damping and brightness.
+const DrumPad drumKit[] = {
+  // note shape                        timbre color pitch decay
+  { 35, MACRO_OSC_SHAPE_KICK,           72,  40,  36,  450 },  // Acoustic bass drum
+  { 36, MACRO_OSC_SHAPE_KICK,           64,  64,  38,  300 },  // Bass drum
+  { 37, MACRO_OSC_SHAPE_STRUCK_DRUM,    20, 110,  72,   60 },  // Side stick
+  { 38, MACRO_OSC_SHAPE_SNARE,          64,  64,  50,  220 },  // Acoustic snare
+  { 39, MACRO_OSC_SHAPE_SNARE,         110, 110,  62,  150 },  // Hand clap
+  { 40, MACRO_OSC_SHAPE_SNARE,          80,  90,  52,  180 },  // Electric snare
+  { 41, MACRO_OSC_SHAPE_STRUCK_DRUM,    70,  50,  41,  450 },  // Low floor tom
+  { 42, MACRO_OSC_SHAPE_CYMBAL,         90,  60,  84,   60 },  // Closed hi-hat
+  { 43, MACRO_OSC_SHAPE_STRUCK_DRUM,    70,  50,  43,  420 },  // High floor tom
+  { 44, MACRO_OSC_SHAPE_CYMBAL,         90,  50,  84,   90 },  // Pedal hi-hat
+  { 45, MACRO_OSC_SHAPE_STRUCK_DRUM,    70,  55,  45,  380 },  // Low tom
+  { 46, MACRO_OSC_SHAPE_CYMBAL,         90,  60,  84,  450 },  // Open hi-hat
+  { 47, MACRO_OSC_SHAPE_STRUCK_DRUM,    70,  55,  47,  350 },  // Low-mid tom
+  { 48, MACRO_OSC_SHAPE_STRUCK_DRUM,    70,  60,  50,  320 },  // Hi-mid tom
+  { 49, MACRO_OSC_SHAPE_CYMBAL,         70, 100,  72, 1500 },  // Crash cymbal 1
+  { 50, MACRO_OSC_SHAPE_STRUCK_DRUM,    70,  60,  52,  300 },  // High tom
+  { 51, MACRO_OSC_SHAPE_STRUCK_BELL,    40,  60,  84, 1200 },  // Ride cymbal 1
+  { 53, MACRO_OSC_SHAPE_STRUCK_BELL,    30,  90,  88,  800 },  // Ride bell
+  { 56, MACRO_OSC_SHAPE_STRUCK_BELL,    20,  30,  79,  300 },  // Cowbell
+  { 57, MACRO_OSC_SHAPE_CYMBAL,         60, 110,  74, 1800 },  // Crash cymbal 2
+};
+
+const uint8_t drumKitSize = sizeof(drumKit) / sizeof(drumKit[0]);
+
+const DrumPad* drumPad(uint8_t note) {
+  for (uint8_t i = 0; i < drumKitSize; i++) {
+    if (drumKit[i].note == note) return &drumKit[i];
+  }
+  return NULL;
+}
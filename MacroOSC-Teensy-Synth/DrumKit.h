@@ -0,0 +1,30 @@
+#ifndef DRUM_KIT_H
+#define DRUM_KIT_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// Braids Drum Kit
+// ============================================================================
+// Pads played in the BRAIDS_VOICE_DRUMS voice mode. Each pad gives a MIDI
+// note its own Braids shape, timbre, color, pitch and decay, so one patch
+// plays a whole kit. The default kit follows the General MIDI drum map
+// (channel 10 layout) with the KICK, SNARE, CYMBAL, STRUCK_DRUM and
+// STRUCK_BELL shapes; notes without a pad are ignored.
+
+struct DrumPad {
+  uint8_t note;                   // MIDI note that plays the pad
+  uint8_t shape;                  // MacroOscillatorShape
+  uint8_t timbre;                 // 0-127, as the Timbre parameter
+  uint8_t color;                  // 0-127, as the Color parameter
+  uint8_t pitch;                  // MIDI note the shape is tuned to
+  uint16_t decayMs;               // time to fall to -60 dB
+};
+
+extern const DrumPad drumKit[];
+extern const uint8_t drumKitSize;
+
+// Pad for a note, or NULL
+const DrumPad* drumPad(uint8_t note);
+
+#endif // DRUM_KIT_H
@@ -10,6 +10,13 @@
 
 #include "config.h"
 #include "MenuNavigation.h"
+#include "EncoderBank.h"
+#include "VoiceAllocator.h"
+#include "ShapeCost.h"
+#include "DrumKit.h"
+#ifdef USE_SVF_VOICE_FILTER
+#include "VoiceFilter.h"
+#endif
 
 const char* PROJECT_NAME = "MacroOSC Synth";
 const char* PROJECT_SUBTITLE = "Macro Oscillator";
@@ -21,6 +28,30 @@ const char* PROJECT_SUBTITLE = "Macro Oscillator";
 
 #include "src/synth_braids.h"
 
+#ifndef BRAIDS_VOICE_MODE
+#define BRAIDS_VOICE_MODE BRAIDS_VOICE_POLY
+#endif
+#ifndef BRAIDS_UNISON_VOICES
+#define BRAIDS_UNISON_VOICES 4
+#endif
+#ifndef BRAIDS_UNISON_DETUNE
+#define BRAIDS_UNISON_DETUNE 10
+#endif
+#ifndef BRAIDS_UNISON_SYNC
+#define BRAIDS_UNISON_SYNC 0
+#endif
+
+// Oscillators summed by braidsStack in the paraphonic and unison modes
+#define BRAIDS_STACKED (BRAIDS_VOICE_MODE == BRAIDS_VOICE_PARAPHONIC || BRAIDS_VOICE_MODE == BRAIDS_VOICE_UNISON)
+#if BRAIDS_VOICE_MODE == BRAIDS_VOICE_UNISON
+#define STACK_VOICES BRAIDS_UNISON_VOICES
+#else
+#define STACK_VOICES VOICES
+#endif
+#if STACK_VOICES > VOICES
+#error "BRAIDS_UNISON_VOICES can't be more than VOICES"
+#endif
+
 #ifdef USE_LCD_DISPLAY
   #include <LiquidCrystal_I2C.h>
 #endif
@@ -47,25 +78,11 @@ MIDIDevice midi1(myusb);
 MIDI_CREATE_INSTANCE(HardwareSerial, Serial1, MIDI);
 #endif
 
-Encoder enc1(ENC_1_CLK, ENC_1_DT);
-Encoder enc2(ENC_2_CLK, ENC_2_DT);
-Encoder enc3(ENC_3_CLK, ENC_3_DT);
-Encoder enc4(ENC_4_CLK, ENC_4_DT);
-Encoder enc5(ENC_5_CLK, ENC_5_DT);
-Encoder enc6(ENC_6_CLK, ENC_6_DT);
-Encoder enc7(ENC_7_CLK, ENC_7_DT);
-Encoder enc8(ENC_8_CLK, ENC_8_DT);
-Encoder enc9(ENC_9_CLK, ENC_9_DT);
-Encoder enc10(ENC_10_CLK, ENC_10_DT);
-Encoder enc11(ENC_11_CLK, ENC_11_DT);
-Encoder enc13(ENC_13_CLK, ENC_13_DT);  
-Encoder enc14(ENC_14_CLK, ENC_14_DT);
-Encoder enc15(ENC_15_CLK, ENC_15_DT);
-Encoder enc16(ENC_16_CLK, ENC_16_DT);
-Encoder enc17(ENC_17_CLK, ENC_17_DT);
-Encoder enc18(ENC_18_CLK, ENC_18_DT);
-Encoder enc19(ENC_19_CLK, ENC_19_DT);
-Encoder enc20(ENC_20_CLK, ENC_20_DT);
+// All 19 panel encoders, built from the config.h pin tables and indexed like encoderMapping
+const EncoderPins encoderPins[19] = {
+  ENCODER_PINS_1_11, ENCODER_PINS_13_20
+};
+EncoderBank<19> encoderBank;
 Encoder menuEncoder(MENU_ENCODER_DT, MENU_ENCODER_CLK);
 
 const int encoderMapping[19] = {
@@ -83,7 +100,7 @@ long lastEncoderValues[19] = {0};
 int currentPreset = 0;
 
 float braidsParameters[NUM_PARAMETERS] = {
-  30.0,   // 0: Shape (0-42)
+  30.0,   // 0: Shape (0-46)
   64.0,   // 1: Timbre (0-127)  
   32.0,   // 2: Color (0-127)
   0.0,    // 3: Coarse (transpose)
@@ -108,11 +125,20 @@ float braidsParameters[NUM_PARAMETERS] = {
 };
 
 // Braids synthesis objects (polyphonic)
+AudioSynthWaveformSine   lfo;                    // Shared LFO, runs ahead of the voices it modulates
 AudioSynthBraids         braidsOsc[VOICES];
+#if BRAIDS_STACKED
+AudioSynthBraidsStack    braidsStack;            // Sums the oscillators into voice 0's chain
+#endif
 AudioEffectEnvelope      braidsEnvelope[VOICES]; 
+#ifdef USE_SVF_VOICE_FILTER
+FilterEnvelope           filtEnv[VOICES];        // Filter envelope per voice, stepped by its filter
+AudioFilterVoiceSvf      braidsFilter[VOICES];   // Fixed-point SVF, sweeps itself from filtEnv
+#else
 AudioSynthWaveformDc     dcFilter[VOICES];       // DC source for filter envelope per voice
 AudioEffectEnvelope      filtEnv[VOICES];        // Filter envelope per voice
 AudioFilterLadder        braidsFilter[VOICES];   // Moog-style ladder filter
+#endif
 AudioMixer4              braidsMix1, braidsMix2; // First 4 voices, voices 4-5
 AudioMixer4              braidsFinalMix;          // Final mono mix of all voices
 
@@ -129,44 +155,74 @@ AudioControlSGTL5000     sgtl5000_1;
 // Voice 0 connections
 AudioConnection patchCord1_0(braidsOsc[0], 0, braidsEnvelope[0], 0);
 AudioConnection patchCord2_0(braidsEnvelope[0], 0, braidsFilter[0], 0);
+#ifndef USE_SVF_VOICE_FILTER
 AudioConnection patchCord3_0(dcFilter[0], filtEnv[0]);
 AudioConnection patchCord4_0(filtEnv[0], 0, braidsFilter[0], 1);
+#endif
 AudioConnection patchCord5_0(braidsFilter[0], 0, braidsMix1, 0);
+AudioConnection patchCord6_0(lfo, 0, braidsOsc[0], 0);  // LFO>Pitch
+AudioConnection patchCord7_0(lfo, 0, braidsOsc[0], 1);  // LFO>Timbre
+AudioConnection patchCord8_0(lfo, 0, braidsOsc[0], 2);  // LFO>Color
 
 // Voice 1 connections  
 AudioConnection patchCord1_1(braidsOsc[1], 0, braidsEnvelope[1], 0);
 AudioConnection patchCord2_1(braidsEnvelope[1], 0, braidsFilter[1], 0);
+#ifndef USE_SVF_VOICE_FILTER
 AudioConnection patchCord3_1(dcFilter[1], filtEnv[1]);
 AudioConnection patchCord4_1(filtEnv[1], 0, braidsFilter[1], 1);
+#endif
 AudioConnection patchCord5_1(braidsFilter[1], 0, braidsMix1, 1);
+AudioConnection patchCord6_1(lfo, 0, braidsOsc[1], 0);  // LFO>Pitch
+AudioConnection patchCord7_1(lfo, 0, braidsOsc[1], 1);  // LFO>Timbre
+AudioConnection patchCord8_1(lfo, 0, braidsOsc[1], 2);  // LFO>Color
 
 // Voice 2 connections
 AudioConnection patchCord1_2(braidsOsc[2], 0, braidsEnvelope[2], 0);
 AudioConnection patchCord2_2(braidsEnvelope[2], 0, braidsFilter[2], 0);
+#ifndef USE_SVF_VOICE_FILTER
 AudioConnection patchCord3_2(dcFilter[2], filtEnv[2]);
 AudioConnection patchCord4_2(filtEnv[2], 0, braidsFilter[2], 1);
+#endif
 AudioConnection patchCord5_2(braidsFilter[2], 0, braidsMix1, 2);
+AudioConnection patchCord6_2(lfo, 0, braidsOsc[2], 0);  // LFO>Pitch
+AudioConnection patchCord7_2(lfo, 0, braidsOsc[2], 1);  // LFO>Timbre
+AudioConnection patchCord8_2(lfo, 0, braidsOsc[2], 2);  // LFO>Color
 
 // Voice 3 connections
 AudioConnection patchCord1_3(braidsOsc[3], 0, braidsEnvelope[3], 0);
 AudioConnection patchCord2_3(braidsEnvelope[3], 0, braidsFilter[3], 0);
+#ifndef USE_SVF_VOICE_FILTER
 AudioConnection patchCord3_3(dcFilter[3], filtEnv[3]);
 AudioConnection patchCord4_3(filtEnv[3], 0, braidsFilter[3], 1);
+#endif
 AudioConnection patchCord5_3(braidsFilter[3], 0, braidsMix1, 3);
+AudioConnection patchCord6_3(lfo, 0, braidsOsc[3], 0);  // LFO>Pitch
+AudioConnection patchCord7_3(lfo, 0, braidsOsc[3], 1);  // LFO>Timbre
+AudioConnection patchCord8_3(lfo, 0, braidsOsc[3], 2);  // LFO>Color
 
 // Voice 4 connections
 AudioConnection patchCord1_4(braidsOsc[4], 0, braidsEnvelope[4], 0);
 AudioConnection patchCord2_4(braidsEnvelope[4], 0, braidsFilter[4], 0);
+#ifndef USE_SVF_VOICE_FILTER
 AudioConnection patchCord3_4(dcFilter[4], filtEnv[4]);
 AudioConnection patchCord4_4(filtEnv[4], 0, braidsFilter[4], 1);
+#endif
 AudioConnection patchCord5_4(braidsFilter[4], 0, braidsMix2, 0);
+AudioConnection patchCord6_4(lfo, 0, braidsOsc[4], 0);  // LFO>Pitch
+AudioConnection patchCord7_4(lfo, 0, braidsOsc[4], 1);  // LFO>Timbre
+AudioConnection patchCord8_4(lfo, 0, braidsOsc[4], 2);  // LFO>Color
 
 // Voice 5 connections
 AudioConnection patchCord1_5(braidsOsc[5], 0, braidsEnvelope[5], 0);
 AudioConnection patchCord2_5(braidsEnvelope[5], 0, braidsFilter[5], 0);
+#ifndef USE_SVF_VOICE_FILTER
 AudioConnection patchCord3_5(dcFilter[5], filtEnv[5]);
 AudioConnection patchCord4_5(filtEnv[5], 0, braidsFilter[5], 1);
+#endif
 AudioConnection patchCord5_5(braidsFilter[5], 0, braidsMix2, 1);
+AudioConnection patchCord6_5(lfo, 0, braidsOsc[5], 0);  // LFO>Pitch
+AudioConnection patchCord7_5(lfo, 0, braidsOsc[5], 1);  // LFO>Timbre
+AudioConnection patchCord8_5(lfo, 0, braidsOsc[5], 2);  // LFO>Color
 
 // Mix the two sub-mixers into final mix, then send to both L and R channels
 AudioConnection patchCord_mix1(braidsMix1, 0, braidsFinalMix, 0); // Voices 0-3
@@ -183,6 +239,40 @@ AudioConnection patchCord_finalL2(braidsFinalMix, 0, i2s1, 0); // Left channel
 AudioConnection patchCord_finalR2(braidsFinalMix, 0, i2s1, 1); // Right channel
 #endif
 
+// Every cord into, inside and out of each voice chain. Disconnecting them all
+// leaves the voice's objects with no connections, so they stop rendering.
+#ifdef USE_SVF_VOICE_FILTER
+#define VOICE_CORDS 6
+AudioConnection* voiceCords[VOICES][VOICE_CORDS] = {
+  { &patchCord1_0, &patchCord2_0, &patchCord5_0, &patchCord6_0, &patchCord7_0, &patchCord8_0 },
+  { &patchCord1_1, &patchCord2_1, &patchCord5_1, &patchCord6_1, &patchCord7_1, &patchCord8_1 },
+  { &patchCord1_2, &patchCord2_2, &patchCord5_2, &patchCord6_2, &patchCord7_2, &patchCord8_2 },
+  { &patchCord1_3, &patchCord2_3, &patchCord5_3, &patchCord6_3, &patchCord7_3, &patchCord8_3 },
+  { &patchCord1_4, &patchCord2_4, &patchCord5_4, &patchCord6_4, &patchCord7_4, &patchCord8_4 },
+  { &patchCord1_5, &patchCord2_5, &patchCord5_5, &patchCord6_5, &patchCord7_5, &patchCord8_5 }
+};
+#else
+#define VOICE_CORDS 8
+AudioConnection* voiceCords[VOICES][VOICE_CORDS] = {
+  { &patchCord1_0, &patchCord2_0, &patchCord3_0, &patchCord4_0, &patchCord5_0,
+    &patchCord6_0, &patchCord7_0, &patchCord8_0 },
+  { &patchCord1_1, &patchCord2_1, &patchCord3_1, &patchCord4_1, &patchCord5_1,
+    &patchCord6_1, &patchCord7_1, &patchCord8_1 },
+  { &patchCord1_2, &patchCord2_2, &patchCord3_2, &patchCord4_2, &patchCord5_2,
+    &patchCord6_2, &patchCord7_2, &patchCord8_2 },
+  { &patchCord1_3, &patchCord2_3, &patchCord3_3, &patchCord4_3, &patchCord5_3,
+    &patchCord6_3, &patchCord7_3, &patchCord8_3 },
+  { &patchCord1_4, &patchCord2_4, &patchCord3_4, &patchCord4_4, &patchCord5_4,
+    &patchCord6_4, &patchCord7_4, &patchCord8_4 },
+  { &patchCord1_5, &patchCord2_5, &patchCord3_5, &patchCord4_5, &patchCord5_5,
+    &patchCord6_5, &patchCord7_5, &patchCord8_5 }
+};
+#endif
+
+#ifdef USE_VOICE_SLEEP
+bool voiceAwake[VOICES] = { true, true, true, true, true, true };
+#endif
+
 // Control parameter names for menu display (removed Filter Mode)
 const char* controlNames[NUM_PARAMETERS] = {
   "Shape", "Timbre", "Color", "Coarse", 
@@ -192,14 +282,14 @@ const char* controlNames[NUM_PARAMETERS] = {
   "Volume", "LFO Rate", "LFO>Timbre", "LFO>Color", "LFO>Pitch", "LFO>Filter", "LFO>Volume"
 };
 
-// Braids shape/algorithm names for display
-const char* shapeNames[48] = {
-  "CSAW", "MORPH", "SAW_SQR", "FOLD", "USAW", "SYNC", "RINGMOD", "FM",
-  "SQR_SUB", "SAW_SUB", "SQR_SYN", "SAW_SYN", "TRIPLE", "SAW_SWM", "SAW_CYC", "SQR_CYC",
-  "SIN_SWM", "SIN_CYC", "BUZZ", "SAW_DIP", "SYN_DIP", "TRIPLE2", "SAW_TRI", "SQR_TRI",
-  "SAW_TRP", "SQR_TRP", "WTBL", "WMAP", "WLIN", "WTx4", "NOIS", "TWNQ",
-  "CLKN", "CLOU", "PRTC", "QPSK", "VOWL", "VFIL", "VDHR", "HARM",
-  "FM2", "WTFM", "PLUK", "BOWD", "BLOW", "FLUT", "BELL", "DRUM"
+// Braids shape/algorithm names for display, in MacroOscillatorShape order
+const char* shapeNames[BRAIDS_SHAPE_MAX + 1] = {
+  "CSAW", "MORPH", "SAW_SQR", "FOLD", "BUZZ", "SQR_SUB", "SAW_SUB", "SQR_SYN",
+  "SAW_SYN", "SAWx3", "SQRx3", "TRIx3", "SINx3", "RING", "SWARM", "SAW_CMB",
+  "TOY", "ZLPF", "ZPKF", "ZBPF", "ZHPF", "VOSM", "VOWL", "VFOF",
+  "HARM", "FM", "FBFM", "WTFM", "PLUK", "BOWD", "BLOW", "FLUT",
+  "BELL", "DRUM", "KICK", "CYMB", "SNAR", "WTBL", "WMAP", "WLIN",
+  "WTx4", "NOIS", "TWNQ", "CLKN", "CLOU", "PRTC", "QPSK"
 };
 
 bool macroMode = false;
@@ -215,11 +305,16 @@ struct Voice {
   bool active;
   uint8_t note;
   uint8_t velocity;
-  unsigned long noteOnTime;
+  unsigned long releaseTime; // millis() at note off, for level estimates
 };
 
 Voice voices[VOICES];
-int currentVoice = 0; // Round-robin voice allocation counter
+float voiceLevel(uint8_t v);
+VoiceAllocator<VOICES, VOICE_STEAL_RELEASE_FIRST> voiceAllocator(voiceLevel); // Steals quietest releasing voice first
+ShapeCost shapeCost;                                   // Per-shape render cost, caps the voice count
+#if BRAIDS_VOICE_MODE == BRAIDS_VOICE_UNISON
+NoteStack<16> unisonNotes;                             // Held notes in unison mode, the last one plays
+#endif
 
 float filtAttack = 100, filtSustain = 0.5, filtDecay = 2500, filtRelease = 2500; // Filter envelope timing
 float filterStrength = 0.5; // DC amplitude for filter envelope
@@ -243,7 +338,6 @@ String lastChangedName = "";
 bool parameterChanged = false;
 
 // LFO variables 
-AudioSynthWaveformSine   lfo;             // LFO for modulation
 float lfoRate = 5.0; // LFO rate in Hz (0.1 - 20Hz)
 float lfoTimbreDepth = 0.0; // LFO>Timbre depth (0-1)
 float lfoColorDepth = 0.0;  // LFO>Color depth (0-1)
@@ -334,9 +428,9 @@ void handleControlChange(int cc, int value) {
   
   // Update parameter if mapped
   if (paramIndex >= 0) {
-    // Special scaling for Shape parameter (0-42 range)
+    // Special scaling for Shape parameter (0-BRAIDS_SHAPE_MAX range)
     if (paramIndex == 0) { // Shape parameter
-      paramValue = map(value, 0, 127, 0, 42); // Scale MIDI 0-127 to Shape 0-42
+      paramValue = map(value, 0, 127, 0, BRAIDS_SHAPE_MAX); // Scale MIDI 0-127 to Shape 0-46
     }
     
     updateBraidsParameter(paramIndex, paramValue);
@@ -442,18 +536,40 @@ void OnUSBHostPitchBend(byte channel, int bend) {
 }
 #endif
 
-// Centralized pitch update function for smooth pitch wheel behavior
-void updatePitch() {
+// Braids pitch of a note with coarse transpose and pitch bend
+int braidsPitch(uint8_t note) {
   // Braids pitch format: 1 semitone = 128 units, so ±2 semitones = ±256 units
   float pitchBendOffset = pitchWheelValue * 256.0f; // ±256 for ±2 semitones
-  
+  float basePitch = (note + (int)braidsParameters[3]) << 7; // Include coarse transpose
+  return (int)(basePitch + pitchBendOffset);
+}
+
+#if BRAIDS_VOICE_MODE == BRAIDS_VOICE_UNISON
+// Unison oscillators are spread evenly across ±BRAIDS_UNISON_DETUNE cents;
+// with BRAIDS_UNISON_SYNC the ones synced to the first sit that many semitones up
+int unisonDetune(int v) {
+  if (STACK_VOICES < 2) return 0;
+  int offset = (2 * v - (STACK_VOICES - 1)) * BRAIDS_UNISON_DETUNE * 128 / (100 * (STACK_VOICES - 1));
+  if (v > 0) offset += BRAIDS_UNISON_SYNC << 7;
+  return offset;
+}
+#endif
+
+// Centralized pitch update function for smooth pitch wheel behavior
+void updatePitch() {
+#if BRAIDS_VOICE_MODE == BRAIDS_VOICE_UNISON
+  if (voices[0].active) {
+    for (int v = 0; v < STACK_VOICES; v++) {
+      braidsOsc[v].set_braids_pitch(braidsPitch(voices[0].note) + unisonDetune(v));
+    }
+  }
+#else
   for (int v = 0; v < VOICES; v++) {
     if (voices[v].active) {
-      float basePitch = (voices[v].note + (int)braidsParameters[3]) << 7; // Include coarse transpose
-      float modPitch = basePitch + pitchBendOffset;
-      braidsOsc[v].set_braids_pitch((int)modPitch);
+      braidsOsc[v].set_braids_pitch(braidsPitch(voices[v].note));
     }
   }
+#endif
 }
 
 void setup() {
@@ -479,7 +595,7 @@ void setup() {
     braidsEnvelope[v].sustain(braidsParameters[6] / 127.0);
     braidsEnvelope[v].release(braidsParameters[7]);
     
-    dcFilter[v].amplitude(filterStrength);
+    setFilterEnvDepth(v, filterStrength);
     filtEnv[v].attack(filtAttack);
     filtEnv[v].sustain(filtSustain);
     filtEnv[v].decay(filtDecay);
@@ -490,6 +606,9 @@ void setup() {
     braidsFilter[v].frequency(cutoff);
     braidsFilter[v].resonance((braidsParameters[9] / 127.0) * 3.0); 
     braidsFilter[v].octaveControl(3.0);
+#ifdef USE_SVF_VOICE_FILTER
+    braidsFilter[v].envelope(filtEnv[v]);
+#endif
   }
 
   lfo.frequency(lfoRate);
@@ -528,6 +647,11 @@ void setup() {
 #endif
   
   pinMode(MENU_ENCODER_SW, INPUT_PULLUP);
+
+  encoderBank.begin(encoderPins);
+#ifdef USE_ENCODER_ACCELERATION
+  encoderBank.setAcceleration(true);
+#endif
   
   // Initialize encoder values
   for (int i = 0; i < 19; i++) {
@@ -538,12 +662,12 @@ void setup() {
   // Initialize voice allocation
   for (int v = 0; v < VOICES; v++) {
     voices[v].active = false;
+    voices[v].releaseTime = 0;
     voices[v].note = 0;
     voices[v].velocity = 0;
-    voices[v].noteOnTime = 0;
     
     // Configure DC source for filter envelope
-    dcFilter[v].amplitude(filterStrength);
+    setFilterEnvDepth(v, filterStrength);
     
     // Configure filter envelopes
     filtEnv[v].attack(filtAttack);
@@ -557,6 +681,53 @@ void setup() {
     updateBraidsParameter(i, braidsParameters[i]);
   }
   
+#if BRAIDS_STACKED
+  // One shared chain: the stack takes voice 0's oscillator cords and the
+  // other chains are left unpatched, so their objects never run
+  AudioNoInterrupts();
+  for (int v = 1; v < VOICES; v++) {
+    for (int c = 0; c < VOICE_CORDS; c++) {
+      voiceCords[v][c]->disconnect();
+    }
+#ifdef USE_VOICE_SLEEP
+    voiceAwake[v] = false;
+#endif
+  }
+  patchCord1_0.disconnect();
+  patchCord6_0.disconnect();
+  patchCord7_0.disconnect();
+  patchCord8_0.disconnect();
+  patchCord1_0.connect(braidsStack, 0, braidsEnvelope[0], 0);
+  patchCord6_0.connect(lfo, 0, braidsStack, 0);
+  patchCord7_0.connect(lfo, 0, braidsStack, 1);
+  patchCord8_0.connect(lfo, 0, braidsStack, 2);
+  AudioInterrupts();
+  braidsStack.begin(braidsOsc, STACK_VOICES);
+#if BRAIDS_VOICE_MODE == BRAIDS_VOICE_UNISON && BRAIDS_UNISON_SYNC > 0
+  // The stack renders in voice order, so the first oscillator leads
+  for (int v = 1; v < STACK_VOICES; v++) {
+    braidsOsc[v].set_braids_sync(&braidsOsc[0]);
+  }
+#endif
+#endif
+
+#if BRAIDS_VOICE_MODE == BRAIDS_VOICE_DRUMS
+  // Hits carry their own envelope, so the amp envelope is opened once and
+  // left open: a voice sends no block between hits, and a gate closed then
+  // would only be processed when the next hit arrives, cutting it off.
+  // The pads set shape, timbre and color.
+  for (int v = 0; v < VOICES; v++) {
+    braidsOsc[v].set_braids_percussive();
+    braidsEnvelope[v].delay(0);
+    braidsEnvelope[v].attack(0);
+    braidsEnvelope[v].hold(0);
+    braidsEnvelope[v].decay(0);
+    braidsEnvelope[v].sustain(1.0);
+    braidsEnvelope[v].release(0);
+    braidsEnvelope[v].noteOn();
+  }
+#endif
+  
   // Set mixer gains for 6 voices - increased for better output level
   braidsMix1.gain(0, 0.7); // Voice 0
   braidsMix1.gain(1, 0.7); // Voice 1  
@@ -573,6 +744,21 @@ void setup() {
   braidsFinalMix.gain(2, 0.0); // Unused
   braidsFinalMix.gain(3, 0.0); // Unused
   
+  // Cost of each shape on this board, before the preset picks one
+#ifdef USE_SHAPE_BENCHMARK
+  shapeCost.measureAll(true);
+#else
+  shapeCost.calibrate();
+#endif
+#if BRAIDS_VOICE_MODE == BRAIDS_VOICE_DRUMS
+  // Any pad can land on any voice, so the heaviest pad sets the limit
+  uint8_t heaviest = drumKit[0].shape;
+  for (uint8_t i = 1; i < drumKitSize; i++) {
+    if (shapeCost.cycles(drumKit[i].shape) > shapeCost.cycles(heaviest)) heaviest = drumKit[i].shape;
+  }
+  voiceAllocator.setVoiceLimit(shapeCost.voiceLimit(heaviest, BRAIDS_CPU_BUDGET, VOICES));
+#endif
+
   Serial.println("Loading default Braids preset...");
   loadPreset(0);
   
@@ -614,48 +800,30 @@ void setup() {
   Serial.println(" Ready!");
 }
 
-void readDirectEncoders() {
-  encoderValues[0] = enc1.read() / 4;   // enc1
-  encoderValues[1] = enc2.read() / 4;   // enc2
-  encoderValues[2] = enc3.read() / 4;   // enc3
-  encoderValues[3] = enc4.read() / 4;   // enc4
-  encoderValues[4] = enc5.read() / 4;   // enc5
-  encoderValues[5] = enc6.read() / 4;   // enc6
-  encoderValues[6] = enc7.read() / 4;   // enc7
-  encoderValues[7] = enc8.read() / 4;   // enc8
-  encoderValues[8] = enc9.read() / 4;   // enc9
-  encoderValues[9] = enc10.read() / 4;  // enc10
-  encoderValues[10] = enc11.read() / 4; // enc11
-  encoderValues[11] = enc13.read() / 4; // enc13 (note: no enc12)
-  encoderValues[12] = enc14.read() / 4; // enc14
-  encoderValues[13] = enc15.read() / 4; // enc15
-  encoderValues[14] = enc16.read() / 4; // enc16
-  encoderValues[15] = enc17.read() / 4; // enc17
-  encoderValues[16] = enc18.read() / 4; // enc18
-  encoderValues[17] = enc19.read() / 4; // enc19
-  encoderValues[18] = enc20.read() / 4; // enc20
-}
-
 void readAllControls() {
-  readDirectEncoders();
-  
-  // Check for encoder changes and update parameters using configurable mapping
-  for (int i = 0; i < 19; i++) {
-    if (encoderValues[i] != lastEncoderValues[i]) {
-      // If any physical knob is turned, exit menu mode
-      if (inMenu) {
-        inMenu = false;
-      }
-      
-      int change = encoderValues[i] - lastEncoderValues[i];
-      int paramIndex = encoderMapping[i]; // Use configurable mapping
-      
-      // Only update if encoder is mapped to a valid parameter (not -1 for disabled)
-      if (paramIndex >= 0 && paramIndex < NUM_PARAMETERS) {
-        updateEncoderParameter(paramIndex, change);
-      }
-      lastEncoderValues[i] = encoderValues[i];
+  // Only visit the encoders the bank saw move
+  uint32_t moved = encoderBank.takeDirty();
+  while (moved) {
+    int i = __builtin_ctz(moved);
+    moved &= moved - 1;
+
+    int change = encoderBank.change(i);
+    if (change == 0) continue; // turned less than a detent
+    encoderValues[i] = encoderBank.read(i);
+
+    // If any physical knob is turned, exit menu mode
+    if (inMenu) {
+      inMenu = false;
+    }
+
+    int paramIndex = encoderMapping[i]; // Use configurable mapping
+
+    // Only update if encoder is mapped to a valid parameter (not -1 for disabled)
+    if (paramIndex >= 0 && paramIndex < NUM_PARAMETERS) {
+      updateEncoderParameter(paramIndex, change);
     }
+
+    lastEncoderValues[i] = encoderValues[i];
   }
   
   // Handle menu encoder parameter control (if configured) - ONLY when not in menu
@@ -677,14 +845,33 @@ void readAllControls() {
   }
 }
 
+// Filter envelope depth: the DC level the envelope shapes into the cutoff
+void setFilterEnvDepth(int v, float depth) {
+#ifdef USE_SVF_VOICE_FILTER
+  braidsFilter[v].envelopeDepth(depth);
+#else
+  dcFilter[v].amplitude(depth);
+#endif
+}
+
 void updateBraidsParameter(int paramIndex, float value) {
   // Store the value in the braids parameter array
   braidsParameters[paramIndex] = value;
   
+#if BRAIDS_VOICE_MODE == BRAIDS_VOICE_DRUMS
+  // Shape, timbre and color come from the pads, the amp envelope from the hits
+  if (paramIndex <= 2 || (paramIndex >= 4 && paramIndex <= 7)) return;
+#else
+  if (paramIndex == 0) {
+    // Heavier shapes get fewer voices, so the audio update keeps up
+    voiceAllocator.setVoiceLimit(shapeCost.voiceLimit((int)value, BRAIDS_CPU_BUDGET, VOICES));
+  }
+#endif
+  
   // Update Braids synthesis parameters for all voices
   for (int v = 0; v < VOICES; v++) {
     switch (paramIndex) {
-      case 0: // Shape (0-42)
+      case 0: // Shape (0-46)
         braidsOsc[v].set_braids_shape((int16_t)value);
         break;
       case 1: // Timbre (0-127)
@@ -725,7 +912,7 @@ void updateBraidsParameter(int paramIndex, float value) {
       case 10: // Filter Strength (0-127) - moved from index 11
         filterStrength = value / 127.0; // 0.0 to 1.0 range
         for (int v = 0; v < VOICES; v++) {
-          dcFilter[v].amplitude(filterStrength);
+          setFilterEnvDepth(v, filterStrength);
         }
         break;
       case 11: // Filter Attack (0-127) - moved from index 12
@@ -783,65 +970,274 @@ void updateBraidsParameter(int paramIndex, float value) {
   }
 }
 
-// Voice allocation - round-robin
-int findAvailableVoice() {
-  // Start from current voice and look for next available
-  for (int i = 0; i < VOICES; i++) {
-    int v = (currentVoice + i) % VOICES;
-    if (!voices[v].active) {
-      currentVoice = (v + 1) % VOICES; // Set next voice for next time
-      return v;
+// Envelope and filter chain a voice plays through
+int chainOf(int v) {
+#if BRAIDS_STACKED
+  return 0;
+#else
+  return v;
+#endif
+}
+
+// Whether a note is still holding a chain open
+bool chainHeld(int c) {
+#if BRAIDS_STACKED
+  for (int v = 0; v < VOICES; v++) {
+    if (voices[v].active) return true;
+  }
+  return false;
+#else
+  return voices[c].active;
+#endif
+}
+
+// Estimated amp envelope level of a voice, used to find the quietest releasing voice
+float voiceLevel(uint8_t v) {
+#if BRAIDS_VOICE_MODE == BRAIDS_VOICE_DRUMS
+  return braidsOsc[v].hitLevel();
+#else
+  switch (envelopePhase(braidsEnvelope[chainOf(v)], voices[v].active)) {
+    case ENV_IDLE:
+      return 0.0;
+    case ENV_RELEASE: {
+      // The envelope releases linearly from (roughly) the sustain level
+      float releaseMs = max(braidsParameters[7] / 127.0f * 4000.0f, 1.0f);
+      float remaining = 1.0 - (millis() - voices[v].releaseTime) / releaseMs;
+      return (braidsParameters[6] / 127.0f) * max(remaining, 0.0f);
     }
+    case ENV_SUSTAIN:
+      return braidsParameters[6] / 127.0f;
+    default:
+      return 1.0;
   }
-  
-  // If all voices are active, use round-robin for voice stealing
-  int voiceToSteal = currentVoice;
-  currentVoice = (currentVoice + 1) % VOICES; // Advance for next time
-  return voiceToSteal;
+#endif
 }
 
+// Return released voices to the free list once their amp envelope has finished
+void updateVoiceStates() {
+#if BRAIDS_VOICE_MODE == BRAIDS_VOICE_DRUMS
+  // A drum voice is free once its last hit has decayed
+  for (int v = 0; v < VOICES; v++) {
+    if (voiceAllocator.voiceState(v) == VOICE_RELEASING && !braidsOsc[v].isPlaying()) {
+      voiceAllocator.voiceIdle(v);
+      filtEnv[v].noteOff();
+    }
+  }
+#else
+  for (int v = 0; v < VOICES; v++) {
+    if (voiceAllocator.voiceState(v) == VOICE_RELEASING && !braidsEnvelope[chainOf(v)].isActive()) {
+      voiceAllocator.voiceIdle(v);
+#if BRAIDS_VOICE_MODE == BRAIDS_VOICE_PARAPHONIC
+      braidsStack.gateOff(v);
+#endif
+    }
+  }
+#if BRAIDS_VOICE_MODE == BRAIDS_VOICE_UNISON
+  // The unison oscillators run until the shared release has finished
+  if (!voices[0].active && !braidsEnvelope[0].isActive()) {
+    braidsStack.allOff();
+  }
+#endif
+#endif
+}
+
+#ifdef USE_VOICE_SLEEP
+// Reconnect a sleeping voice before its envelopes are triggered
+void wakeVoice(int v) {
+  if (voiceAwake[v]) return;
+  for (int c = 0; c < VOICE_CORDS; c++) {
+    voiceCords[v][c]->connect();
+  }
+  voiceAwake[v] = true;
+}
+
+// Disconnect voices whose note is released and whose amp envelope has finished
+// (for drums, whose last hit has decayed: their gate never closes), and free
+// their delay line slabs.
+// With no connections left their objects go inactive and update() is skipped;
+// the voice mixers treat the missing input as silence.
+void sleepIdleVoices() {
+  for (int v = 0; v < VOICES; v++) {
+#if BRAIDS_VOICE_MODE == BRAIDS_VOICE_DRUMS
+    bool sounding = braidsOsc[v].isPlaying();
+#else
+    bool sounding = braidsEnvelope[v].isActive();
+#endif
+    if (voiceAwake[v] && !chainHeld(v) && !sounding) {
+      for (int c = 0; c < VOICE_CORDS; c++) {
+        voiceCords[v][c]->disconnect();
+      }
+      voiceAwake[v] = false;
+      // A sleeping voice doesn't render, so its delay line slab goes back to
+      // the pool for the voices still awake
+      AudioNoInterrupts();
+      braidsOsc[v].releaseDelayLines();
+      AudioInterrupts();
+    }
+  }
+}
+#endif
+
+#if BRAIDS_VOICE_MODE == BRAIDS_VOICE_POLY
 void noteOn(uint8_t note, uint8_t velocity) {
-  int voice = findAvailableVoice();
+  int voice = voiceAllocator.noteOn(note);
   
   voices[voice].active = true;
   voices[voice].note = note;
   voices[voice].velocity = velocity;
-  voices[voice].noteOnTime = millis();
-  
-  
-  // Apply coarse transpose and pitch bend using Braids linear pitch format
-  float pitchBendOffset = pitchWheelValue * 256.0f; // ±256 for ±2 semitones
-  float basePitch = (note + (int)braidsParameters[3]) << 7; // Include coarse transpose
-  float modPitch = basePitch + pitchBendOffset;
-  braidsOsc[voice].set_braids_pitch((int)modPitch);
   
+  braidsOsc[voice].noteOn(braidsPitch(note));
   
   // Trigger envelopes
+#ifdef USE_VOICE_SLEEP
+  wakeVoice(voice);
+#endif
   braidsEnvelope[voice].noteOn();
   filtEnv[voice].noteOn(); // Trigger filter envelope
 }
 
-// Find voice playing a specific note
-int findVoiceForNote(uint8_t note) {
-  for (int v = 0; v < VOICES; v++) {
-    if (voices[v].active && voices[v].note == note) {
-      return v;
-    }
-  }
-  return -1; // Note not found
-}
-
 void noteOff(uint8_t note) {
   // Find voice with this note and release it
-  int voiceNum = findVoiceForNote(note);
+  int voiceNum = voiceAllocator.noteOff(note);
   if (voiceNum >= 0) {
     // Turn off envelopes but let them complete their release naturally
     braidsEnvelope[voiceNum].noteOff();
     filtEnv[voiceNum].noteOff(); // Trigger filter envelope release
     voices[voiceNum].active = false; // Mark as inactive for voice allocation
+    voices[voiceNum].releaseTime = millis();
   }
 }
 
+#elif BRAIDS_VOICE_MODE == BRAIDS_VOICE_PARAPHONIC
+// Each note gets an oscillator; the shared envelopes trigger on the first
+// note of a phrase and release with the last one
+void noteOn(uint8_t note, uint8_t velocity) {
+  int voice = voiceAllocator.noteOn(note);
+  bool retrigger = !chainHeld(0);
+  
+  if (retrigger) {
+    // New phrase: drop the oscillators still sounding in the last release
+    for (int v = 0; v < VOICES; v++) {
+      if (v != voice && voiceAllocator.voiceState(v) == VOICE_RELEASING) {
+        voiceAllocator.voiceIdle(v);
+        braidsStack.gateOff(v);
+      }
+    }
+  }
+  
+  voices[voice].active = true;
+  voices[voice].note = note;
+  voices[voice].velocity = velocity;
+  
+  braidsOsc[voice].noteOn(braidsPitch(note));
+  braidsStack.gateOn(voice);
+  
+  if (retrigger) {
+#ifdef USE_VOICE_SLEEP
+    wakeVoice(0);
+#endif
+    braidsEnvelope[0].noteOn();
+    filtEnv[0].noteOn();
+  }
+}
+
+void noteOff(uint8_t note) {
+  int voiceNum = voiceAllocator.noteOff(note);
+  if (voiceNum < 0) return;
+  
+  voices[voiceNum].active = false;
+  voices[voiceNum].releaseTime = millis();
+  
+  if (chainHeld(0)) {
+    // Other notes keep the envelopes open, this one just fades out
+    voiceAllocator.voiceIdle(voiceNum);
+    braidsStack.gateOff(voiceNum);
+  } else {
+    // Last note: it keeps sounding through the shared release
+    braidsEnvelope[0].noteOff();
+    filtEnv[0].noteOff();
+  }
+}
+
+#elif BRAIDS_VOICE_MODE == BRAIDS_VOICE_DRUMS
+// Each hit takes a voice that is released straight away, so the allocator
+// hands out free voices first and then steals the quietest decaying hit.
+// The hit is queued to the oscillator and lands in the next audio block at
+// the offset it was played at. Note-offs are ignored.
+void noteOn(uint8_t note, uint8_t velocity) {
+  const DrumPad* pad = drumPad(note);
+  if (!pad) return;
+  
+  int voice = voiceAllocator.noteOn(note);
+  voiceAllocator.noteOff(note);
+  voices[voice].active = false;
+  voices[voice].note = note;
+  voices[voice].velocity = velocity;
+  voices[voice].releaseTime = millis();
+  
+  if (!braidsOsc[voice].hit(braidsPitch(pad->pitch), pad->shape, pad->timbre * 258,
+                            pad->color * 258, velocity / 127.0, pad->decayMs)) {
+    return; // Queue full: more hits on this voice than one block holds
+  }
+  
+#ifdef USE_VOICE_SLEEP
+  wakeVoice(voice);
+#endif
+  filtEnv[voice].noteOn();
+}
+
+void noteOff(uint8_t note) {
+}
+
+#else // BRAIDS_VOICE_UNISON
+// Every oscillator plays the last held note, detuned; notes played legato
+// glide the pitch without restriking or retriggering the envelopes
+void noteOn(uint8_t note, uint8_t velocity) {
+  bool legato = unisonNotes.size() > 0;
+  unisonNotes.push(note);
+  
+  voices[0].active = true;
+  voices[0].note = note;
+  voices[0].velocity = velocity;
+  
+  for (int v = 0; v < STACK_VOICES; v++) {
+    int pitch = braidsPitch(note) + unisonDetune(v);
+    if (legato) {
+      braidsOsc[v].set_braids_pitch(pitch);
+    } else {
+      braidsOsc[v].noteOn(pitch);
+    }
+    braidsStack.gateOn(v);
+  }
+  
+  if (!legato) {
+#ifdef USE_VOICE_SLEEP
+    wakeVoice(0);
+#endif
+    braidsEnvelope[0].noteOn();
+    filtEnv[0].noteOn();
+  }
+}
+
+void noteOff(uint8_t note) {
+  unisonNotes.remove(note);
+  
+  if (unisonNotes.size() > 0) {
+    // Fall back to the last note still held
+    voices[0].note = unisonNotes.top();
+    updatePitch();
+    return;
+  }
+  
+  if (voices[0].active) {
+    voices[0].active = false;
+    voices[0].releaseTime = millis();
+    braidsEnvelope[0].noteOff();
+    filtEnv[0].noteOff();
+  }
+}
+#endif
+
 
 // Update encoder parameter with proper scaling (matches EPiano pattern)
 void updateEncoderParameter(int paramIndex, int change) {
@@ -850,8 +1246,8 @@ void updateEncoderParameter(int paramIndex, int change) {
   float increment = 1.0; // Direct increment for raw Braids values (not normalized)
   
   // Special handling for specific parameters
-  if (paramIndex == 0) { // Shape - limit to 0-42 range
-    braidsParameters[paramIndex] = constrain(braidsParameters[paramIndex] + (change * increment), 0.0, 42.0);
+  if (paramIndex == 0) { // Shape - limit to 0-46 range
+    braidsParameters[paramIndex] = constrain(braidsParameters[paramIndex] + (change * increment), 0.0, (float)BRAIDS_SHAPE_MAX);
   } else if (paramIndex == 8) { // Filter Cutoff - standard 0-127 range
     braidsParameters[paramIndex] = constrain(braidsParameters[paramIndex] + (change * increment), 0.0, 127.0);
   } else {
@@ -895,72 +1291,18 @@ void updateLFOModulation() {
   if (currentTime - lastLFOUpdate < 10) return; // Slower updates to avoid glitches (10ms = 100Hz)
   lastLFOUpdate = currentTime;
   
-  // Calculate pitch bend offset using Braids linear format
-  float pitchBendOffset = pitchWheelValue * 256.0f; // ±256 for ±2 semitones
-  
   // Calculate LFO signal
   float phase = (currentTime * lfoRate * 2 * PI) / 1000.0;
   float lfoSignal = sin(phase);
   
   // Apply modulation to each target if depth > 0.01
   
-  // Timbre modulation (Braids-specific) - need to scale to 16-bit like normal updates
-  if (lfoTimbreDepth > 0.01) {
-    float timbreModulation = lfoSignal * lfoTimbreDepth * 20.0; // ±20 timbre units
-    float baseTimbre = braidsParameters[1];
-    float modTimbre = constrain(baseTimbre + timbreModulation, 0.0, 127.0);
-    for (int v = 0; v < VOICES; v++) {
-      if (voices[v].active) {
-        braidsOsc[v].set_braids_timbre((int16_t)(modTimbre * 258)); // Scale to 16-bit like normal updates
-      }
-    }
-  } else {
-    // When LFO is not active, ensure base value is set correctly
-    for (int v = 0; v < VOICES; v++) {
-      if (voices[v].active) {
-        braidsOsc[v].set_braids_timbre((int16_t)(braidsParameters[1] * 258));
-      }
-    }
-  }
-  
-  // Color modulation (Braids-specific) - need to scale to 16-bit like normal updates
-  if (lfoColorDepth > 0.01) {
-        float colorModulation = lfoSignal * lfoColorDepth * 20.0; // ±20 color units
-    float baseColor = braidsParameters[2];
-    float modColor = constrain(baseColor + colorModulation, 0.0, 127.0);
-    for (int v = 0; v < VOICES; v++) {
-      if (voices[v].active) {
-        braidsOsc[v].set_braids_color((int16_t)(modColor * 258)); // Scale to 16-bit like normal updates
-      }
-    }
-  } else {
-    // When LFO is not active, ensure base value is set correctly
-    for (int v = 0; v < VOICES; v++) {
-      if (voices[v].active) {
-        braidsOsc[v].set_braids_color((int16_t)(braidsParameters[2] * 258));
-      }
-    }
-  }
-  
-  // Pitch modulation
-  if (lfoPitchDepth > 0.01) {
-        float pitchModulation = lfoSignal * lfoPitchDepth * 128.0; // ±1 semitone max
-    for (int v = 0; v < VOICES; v++) {
-      if (voices[v].active) {
-        float basePitch = (voices[v].note + (int)braidsParameters[3]) << 7; // Include coarse transpose
-        float modPitch = basePitch + pitchBendOffset + pitchModulation;
-        braidsOsc[v].set_braids_pitch((int)modPitch);
-      }
-    }
-  } else {
-    // No pitch LFO - apply only pitch wheel
-    for (int v = 0; v < VOICES; v++) {
-      if (voices[v].active) {
-        float basePitch = (voices[v].note + (int)braidsParameters[3]) << 7; // Include coarse transpose
-        float modPitch = basePitch + pitchBendOffset;
-        braidsOsc[v].set_braids_pitch((int)modPitch);
-      }
-    }
+  // Timbre, color and pitch follow the audio LFO inside each oscillator;
+  // only the depths are set here (±20 timbre/color units, ±1 semitone)
+  for (int v = 0; v < VOICES; v++) {
+    braidsOsc[v].set_braids_timbre_mod(lfoTimbreDepth * 20.0 / 127.0);
+    braidsOsc[v].set_braids_color_mod(lfoColorDepth * 20.0 / 127.0);
+    braidsOsc[v].set_braids_pitch_mod(lfoPitchDepth);
   }
   
   // Filter modulation
@@ -1024,6 +1366,10 @@ void loop() {
   
   // Update LFO modulation
   updateLFOModulation();
+  updateVoiceStates();
+#ifdef USE_VOICE_SLEEP
+  sleepIdleVoices();
+#endif
   
   // Update display if parameter changed during this loop iteration
   if (parameterChanged) {
@@ -8,6 +8,7 @@
 #include <Arduino.h>
 #include <String.h>
 #include <Encoder.h>
+#include "EncoderBank.h"
 
 #ifdef USE_LCD_DISPLAY
   #include <LiquidCrystal_I2C.h>
@@ -48,7 +49,7 @@ const char* settingsMenuItems[] = {"MIDI Channel", "< Back"};
 extern long encoderValues[];
 extern long lastEncoderValues[];
 extern Encoder menuEncoder;
-extern Encoder enc1, enc2, enc3, enc4, enc5, enc6, enc7, enc8, enc9, enc10, enc11, enc13, enc14, enc15, enc16, enc17, enc18, enc19, enc20;
+extern EncoderBank<19> encoderBank;
 extern void updateBraidsParameter(int paramIndex, float val);
 extern const int encoderMapping[19];
 
@@ -242,8 +243,8 @@ void handleEncoder() {
         int paramIndex = getParameterIndex(currentMenuState);
         if (newMenuValue > oldMenuValue) {
           // Adjust Braids parameter with proper increment
-          if (paramIndex == 0) { // Shape parameter (0-42)
-            braidsParameters[paramIndex] = constrain(braidsParameters[paramIndex] + 1.0, 0.0, 42.0);
+          if (paramIndex == 0) { // Shape parameter (0-46)
+            braidsParameters[paramIndex] = constrain(braidsParameters[paramIndex] + 1.0, 0.0, (float)BRAIDS_SHAPE_MAX);
           } else {
             // Standard 0-127 parameter (Filter Cutoff now at index 8)
             braidsParameters[paramIndex] = constrain(braidsParameters[paramIndex] + 1.0, 0.0, 127.0);
@@ -251,8 +252,8 @@ void handleEncoder() {
           updateParameterFromMenu(paramIndex, braidsParameters[paramIndex]);
         } else {
           // Adjust Braids parameter with proper decrement
-          if (paramIndex == 0) { // Shape parameter (0-42)
-            braidsParameters[paramIndex] = constrain(braidsParameters[paramIndex] - 1.0, 0.0, 42.0);
+          if (paramIndex == 0) { // Shape parameter (0-46)
+            braidsParameters[paramIndex] = constrain(braidsParameters[paramIndex] - 1.0, 0.0, (float)BRAIDS_SHAPE_MAX);
           } else {
             // Standard 0-127 parameter (Filter Cutoff now at index 8)
             braidsParameters[paramIndex] = constrain(braidsParameters[paramIndex] - 1.0, 0.0, 127.0);
@@ -671,37 +672,20 @@ void updateParameterFromMenu(int paramIndex, float val) {
 }
 
 void resetEncoderBaselines() {
+  long positions[19];
   for (int i = 0; i < 19; i++) {
+    positions[i] = encoderBank.read(i); // unmapped encoders keep their position
     int paramIndex = encoderMapping[i]; // Use configurable mapping
     
     // Only reset encoders that are mapped to valid parameters
     if (paramIndex >= 0 && paramIndex < NUM_PARAMETERS) {
-      long targetEncoderValue = (long)(braidsParameters[paramIndex]);
-      switch(i) {
-        case 0: enc1.write(targetEncoderValue * 4); break;
-        case 1: enc2.write(targetEncoderValue * 4); break;
-        case 2: enc3.write(targetEncoderValue * 4); break;
-        case 3: enc4.write(targetEncoderValue * 4); break;
-        case 4: enc5.write(targetEncoderValue * 4); break;
-        case 5: enc6.write(targetEncoderValue * 4); break;
-        case 6: enc7.write(targetEncoderValue * 4); break;
-        case 7: enc8.write(targetEncoderValue * 4); break;
-        case 8: enc9.write(targetEncoderValue * 4); break;
-        case 9: enc10.write(targetEncoderValue * 4); break;
-        case 10: enc11.write(targetEncoderValue * 4); break;
-        case 11: enc13.write(targetEncoderValue * 4); break;
-        case 12: enc14.write(targetEncoderValue * 4); break;
-        case 13: enc15.write(targetEncoderValue * 4); break;
-        case 14: enc16.write(targetEncoderValue * 4); break;
-        case 15: enc17.write(targetEncoderValue * 4); break;
-        case 16: enc18.write(targetEncoderValue * 4); break;
-        case 17: enc19.write(targetEncoderValue * 4); break;
-        case 18: enc20.write(targetEncoderValue * 4); break;
-      }
+      long targetEncoderValue = (long)(allParameterValues[paramIndex] * 100);
+      positions[i] = targetEncoderValue;
       encoderValues[i] = targetEncoderValue;
       lastEncoderValues[i] = targetEncoderValue;
     }
   }
+  encoderBank.sync(positions);
 }
 
 void loadPreset(int presetNum) {
@@ -27,6 +27,9 @@ enum BraidsParam {
   BRAIDS_NONE = -1  // Use this to disable an encoder
 };
 
+// Highest Braids shape index (MACRO_OSC_SHAPE_QPSK)
+#define BRAIDS_SHAPE_MAX 46
+
 // ============================================================================
 // Menu State Enums
 // ============================================================================
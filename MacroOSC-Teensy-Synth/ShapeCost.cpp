@@ -0,0 +1,102 @@
+#include "ShapeCost.h"
+#include <Audio.h>
+
+using namespace braids;
+
+// Cost of each shape relative to CSAW (= 100), worst of MIDI notes 36, 60
+// and 84, timbre and color at mid scale. Generated on the host (x86, -O2,
+// median of nine runs) by tools/shape_weights.py, which prints this table;
+// rerun it when a shape's render code changes. Host numbers move by about
+// 10% between runs. Not yet checked against the board: USE_SHAPE_BENCHMARK
+// prints the measured weights at boot to compare with.
+static const uint16_t shapeWeight[MACRO_OSC_SHAPE_LAST] = {
+  100, 229, 196, 329, 160, 200, 184, 206,   // CSAW MORPH SAW_SQR FOLD BUZZ SQR_SUB SAW_SUB SQR_SYN
+  134, 197, 314, 206, 173, 140, 127, 115,   // SAW_SYN SAWx3 SQRx3 TRIx3 SINx3 RING SWARM SAW_CMB
+   97, 201, 198, 176, 175, 125, 101, 188,   // TOY ZLPF ZPKF ZBPF ZHPF VOSM VOWL VFOF
+  299,  81, 234, 262, 172, 104, 119, 165,   // HARM FM FBFM WTFM PLUK BOWD BLOW FLUT
+  229, 204, 158, 291, 195, 138, 257, 214,   // BELL DRUM KICK CYMB SNAR WTBL WMAP WLIN
+  261, 131, 112,  27, 207,  98,  85         // WTx4 NOIS TWNQ CLKN CLOU PRTC QPSK
+};
+
+static const int16_t benchmarkPitches[] = { 36 << 7, 60 << 7, 84 << 7 };
+#define BENCHMARK_WARMUP 4
+#define BENCHMARK_BLOCKS 16
+
+ShapeCost::ShapeCost() {
+  for (int s = 0; s < MACRO_OSC_SHAPE_LAST; s++) shapeCycles[s] = 0;
+}
+
+// Average cycles per block, worst pitch. The audio update is held off while
+// timing: it would skew the count, and the oscillator claims a delay line
+// slab from the pool the voices share.
+uint32_t ShapeCost::measure(uint8_t shape) {
+  static MacroOscillator osc;
+  static int16_t buffer[AUDIO_BLOCK_SAMPLES];
+  static const uint8_t sync[AUDIO_BLOCK_SAMPLES] = { 0 };
+
+  uint32_t worst = 0;
+  for (uint8_t p = 0; p < sizeof(benchmarkPitches) / sizeof(benchmarkPitches[0]); p++) {
+    AudioNoInterrupts();
+    osc.Init();
+    osc.set_shape(static_cast<MacroOscillatorShape>(shape));
+    osc.set_pitch(benchmarkPitches[p]);
+    osc.set_parameters(16384, 16384);
+    osc.Strike();
+    for (int b = 0; b < BENCHMARK_WARMUP; b++) osc.Render(sync, buffer, AUDIO_BLOCK_SAMPLES);
+    uint32_t start = ARM_DWT_CYCCNT;
+    for (int b = 0; b < BENCHMARK_BLOCKS; b++) osc.Render(sync, buffer, AUDIO_BLOCK_SAMPLES);
+    uint32_t cycles = (ARM_DWT_CYCCNT - start) / BENCHMARK_BLOCKS;
+    // Hand any delay line slab back before the voices run again
+    osc.set_shape(MACRO_OSC_SHAPE_CSAW);
+    osc.Render(sync, buffer, AUDIO_BLOCK_SAMPLES);
+    AudioInterrupts();
+    if (cycles > worst) worst = cycles;
+  }
+  return worst;
+}
+
+void ShapeCost::calibrate() {
+  uint32_t reference = measure(MACRO_OSC_SHAPE_CSAW);
+  for (int s = 0; s < MACRO_OSC_SHAPE_LAST; s++) {
+    shapeCycles[s] = reference * shapeWeight[s] / 100;
+  }
+}
+
+void ShapeCost::measureAll(bool print) {
+  for (int s = 0; s < MACRO_OSC_SHAPE_LAST; s++) {
+    shapeCycles[s] = measure(s);
+  }
+  if (print) this->print();
+}
+
+uint32_t ShapeCost::cycles(uint8_t shape) const {
+  return shape < MACRO_OSC_SHAPE_LAST ? shapeCycles[shape] : 0;
+}
+
+uint8_t ShapeCost::voiceLimit(uint8_t shape, uint8_t budgetPercent, uint8_t maxVoices) const {
+  uint32_t perVoice = cycles(shape);
+  if (budgetPercent == 0 || perVoice == 0) return maxVoices;
+
+  const float cyclesPerBlock = F_CPU_ACTUAL / (AUDIO_SAMPLE_RATE_EXACT / AUDIO_BLOCK_SAMPLES);
+  uint32_t voices = (uint32_t)(cyclesPerBlock * budgetPercent / 100.0f) / perVoice;
+  if (voices < 1) voices = 1;
+  if (voices > maxVoices) voices = maxVoices;
+  return voices;
+}
+
+void ShapeCost::print() const {
+  const float cyclesPerBlock = F_CPU_ACTUAL / (AUDIO_SAMPLE_RATE_EXACT / AUDIO_BLOCK_SAMPLES);
+  uint32_t reference = shapeCycles[MACRO_OSC_SHAPE_CSAW];
+
+  Serial.println("Braids shape cost (cycles per block / % of a block / weight, CSAW = 100):");
+  for (int s = 0; s < MACRO_OSC_SHAPE_LAST; s++) {
+    Serial.print("  ");
+    Serial.print(s);
+    Serial.print(": ");
+    Serial.print(shapeCycles[s]);
+    Serial.print(" / ");
+    Serial.print(shapeCycles[s] * 100.0f / cyclesPerBlock, 2);
+    Serial.print(" / ");
+    Serial.println(reference ? shapeCycles[s] * 100 / reference : 0);
+  }
+}
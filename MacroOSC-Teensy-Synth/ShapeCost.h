@@ -0,0 +1,43 @@
+#ifndef SHAPE_COST_H
+#define SHAPE_COST_H
+
+#include "config.h"
+#include <Arduino.h>
+#include "src/macro_oscillator.h"
+
+// ============================================================================
+// Braids Shape Cost
+// ============================================================================
+// Cycles one voice takes to render a 128-sample block of each
+// MacroOscillatorShape, worst of three pitches. The relative weights were
+// measured on the host (tools/shape_weights.py); calibrate() times CSAW on
+// the board and scales them to cycles. measureAll() times every shape on
+// the board instead and prints the table, weights included, so the host
+// numbers can be checked and refreshed. voiceLimit() turns the table into the number of voices of a
+// shape that fit in a CPU budget, for VoiceAllocator::setVoiceLimit().
+
+class ShapeCost {
+public:
+  ShapeCost();
+
+  // Time CSAW here and scale the weight table to cycles (a few ms)
+  void calibrate();
+
+  // Time every shape here (about a second); prints the table if asked
+  void measureAll(bool print);
+
+  uint32_t cycles(uint8_t shape) const;
+
+  // Voices of this shape that fit in budgetPercent of an audio block,
+  // 1..maxVoices. A budget of 0 means no limit.
+  uint8_t voiceLimit(uint8_t shape, uint8_t budgetPercent, uint8_t maxVoices) const;
+
+  void print() const;
+
+private:
+  uint32_t measure(uint8_t shape);
+
+  uint32_t shapeCycles[braids::MACRO_OSC_SHAPE_LAST];
+};
+
+#endif // SHAPE_COST_H
@@ -0,0 +1,282 @@
+#ifndef VoiceAllocator_h_
+#define VoiceAllocator_h_
+
+// ============================================================================
+// Shared polyphonic voice allocator - Multi-Teensy Synth Collection
+// ============================================================================
+// Header-only, deployed into each project by Shared/deploy_config.sh.
+//
+// Every voice is in exactly one state: FREE, HELD (key down) or RELEASING
+// (key up, envelope still sounding). Free voices sit on a stack, busy voices
+// on an intrusive list in trigger order and releasing voices on a second list
+// in release order, so allocation, note off and stealing are all O(1). Only
+// the level-based choices scan, and only over the voices they compare.
+
+#include <stdint.h>
+#include <stddef.h>
+
+enum VoiceStealPolicy {
+  VOICE_STEAL_OLDEST,        // free voice, else the voice triggered longest ago
+  VOICE_STEAL_QUIETEST,      // free voice, else the quietest busy voice (needs a level function)
+  VOICE_STEAL_SAME_NOTE,     // voice already playing this note, else free, else oldest
+  VOICE_STEAL_RELEASE_FIRST  // free voice, else the quietest (or oldest) releasing voice, else the oldest held one
+};
+
+enum VoiceState {
+  VOICE_FREE,
+  VOICE_HELD,
+  VOICE_RELEASING
+};
+
+// Where a voice's amp envelope is, as far as isActive()/isSustain() can tell
+enum EnvelopePhase {
+  ENV_IDLE,
+  ENV_ATTACK,   // attack or decay
+  ENV_SUSTAIN,
+  ENV_RELEASE
+};
+
+template <class Envelope>
+EnvelopePhase envelopePhase(Envelope &env, bool held) {
+  if (!env.isActive()) return ENV_IDLE;
+  if (!held) return ENV_RELEASE;
+  return env.isSustain() ? ENV_SUSTAIN : ENV_ATTACK;
+}
+
+template <uint8_t N, VoiceStealPolicy Policy = VOICE_STEAL_RELEASE_FIRST>
+class VoiceAllocator {
+public:
+  // Returns the current output level of a voice (any scale, higher = louder)
+  typedef float (*LevelFunction)(uint8_t voice);
+
+  VoiceAllocator(LevelFunction level = NULL) : levelOf(level) { reset(); }
+
+  void reset() {
+    for (int n = 0; n < 128; n++) noteVoice[n] = -1;
+    freeHead = -1;
+    busyHead = busyTail = -1;
+    releaseHead = releaseTail = -1;
+    for (int v = N - 1; v >= 0; v--) {
+      state[v] = VOICE_FREE;
+      voiceNote[v] = 0;
+      busyPrev[v] = busyNext[v] = -1;
+      releasePrev[v] = releaseNext[v] = -1;
+      freeNext[v] = freeHead;
+      freeHead = v;
+    }
+    busyCount = 0;
+    limit = N;
+    lastStolen = false;
+  }
+
+  // Cap the voices sounding at once (1..N). Past the cap new notes steal, as
+  // if the others did not exist; voices already sounding are left to finish.
+  void setVoiceLimit(uint8_t n) {
+    limit = n < 1 ? 1 : (n > N ? N : n);
+  }
+  uint8_t voiceLimit() const { return limit; }
+
+  // Allocate a voice for a new note. stolen() tells whether it was sounding.
+  int8_t noteOn(uint8_t note) {
+    note &= 0x7F;
+    int8_t v = noteVoice[note];
+
+    // A note that is still held always retriggers its own voice
+    if (v >= 0 && (state[v] == VOICE_HELD || Policy == VOICE_STEAL_SAME_NOTE)) {
+      lastStolen = true;
+      unlinkBusy(v);
+      if (state[v] == VOICE_RELEASING) unlinkRelease(v);
+    } else if (freeHead >= 0 && busyCount < limit) {
+      v = freeHead;
+      freeHead = freeNext[v];
+      lastStolen = false;
+    } else {
+      v = victim();
+      lastStolen = true;
+      unlinkBusy(v);
+      if (state[v] == VOICE_RELEASING) unlinkRelease(v);
+      if (noteVoice[voiceNote[v]] == v) noteVoice[voiceNote[v]] = -1;
+    }
+
+    state[v] = VOICE_HELD;
+    voiceNote[v] = note;
+    noteVoice[note] = v;
+    appendBusy(v);
+    return v;
+  }
+
+  // Hold a chosen voice for a note, for the mono and legato modes that always
+  // play voice 0. Whatever the voice was doing before is taken over.
+  void voiceOn(uint8_t v, uint8_t note) {
+    if (v >= N) return;
+    note &= 0x7F;
+    if (state[v] == VOICE_FREE) {
+      if (freeHead == (int8_t)v) {
+        freeHead = freeNext[v];
+      } else {
+        int8_t p = freeHead;
+        while (freeNext[p] != (int8_t)v) p = freeNext[p];
+        freeNext[p] = freeNext[v];
+      }
+    } else {
+      unlinkBusy(v);
+      if (state[v] == VOICE_RELEASING) unlinkRelease(v);
+      if (noteVoice[voiceNote[v]] == (int8_t)v) noteVoice[voiceNote[v]] = -1;
+    }
+    state[v] = VOICE_HELD;
+    voiceNote[v] = note;
+    noteVoice[note] = v;
+    appendBusy(v);
+  }
+
+  // Release the voice holding this note. Returns the voice, or -1 if none.
+  int8_t noteOff(uint8_t note) {
+    int8_t v = noteVoice[note & 0x7F];
+    if (v < 0 || state[v] != VOICE_HELD) return -1;
+    voiceOff(v);
+    return v;
+  }
+
+  // Move a held voice into its release phase
+  void voiceOff(uint8_t v) {
+    if (v >= N || state[v] != VOICE_HELD) return;
+    state[v] = VOICE_RELEASING;
+    appendRelease(v);
+  }
+
+  // The voice's envelope has finished; hand it back to the free stack
+  void voiceIdle(uint8_t v) {
+    if (v >= N || state[v] == VOICE_FREE) return;
+    unlinkBusy(v);
+    if (state[v] == VOICE_RELEASING) unlinkRelease(v);
+    if (noteVoice[voiceNote[v]] == (int8_t)v) noteVoice[voiceNote[v]] = -1;
+    state[v] = VOICE_FREE;
+    freeNext[v] = freeHead;
+    freeHead = v;
+  }
+
+  // Voice currently holding a note, or -1
+  int8_t voiceForNote(uint8_t note) const {
+    int8_t v = noteVoice[note & 0x7F];
+    return (v >= 0 && state[v] == VOICE_HELD) ? v : -1;
+  }
+
+  uint8_t note(uint8_t v) const { return voiceNote[v]; }
+  VoiceState voiceState(uint8_t v) const { return (VoiceState)state[v]; }
+  bool isHeld(uint8_t v) const { return state[v] == VOICE_HELD; }
+  bool stolen() const { return lastStolen; }
+  uint8_t voices() const { return N; }
+
+private:
+  int8_t victim() const {
+    switch (Policy) {
+      case VOICE_STEAL_QUIETEST:
+        return quietest(busyHead, busyNext);
+      case VOICE_STEAL_RELEASE_FIRST:
+        return (releaseHead >= 0) ? quietest(releaseHead, releaseNext) : busyHead;
+      case VOICE_STEAL_OLDEST:
+      case VOICE_STEAL_SAME_NOTE:
+      default:
+        return busyHead;
+    }
+  }
+
+  // Quietest voice on a list; without a level function the list head (oldest)
+  int8_t quietest(int8_t head, const int8_t *next) const {
+    if (!levelOf) return head;
+    int8_t quietestVoice = head;
+    float lowest = levelOf(head);
+    for (int8_t v = next[head]; v >= 0; v = next[v]) {
+      float level = levelOf(v);
+      if (level < lowest) {
+        lowest = level;
+        quietestVoice = v;
+      }
+    }
+    return quietestVoice;
+  }
+
+  void appendBusy(int8_t v) {
+    busyPrev[v] = busyTail;
+    busyNext[v] = -1;
+    if (busyTail >= 0) busyNext[busyTail] = v; else busyHead = v;
+    busyTail = v;
+    busyCount++;
+  }
+
+  void unlinkBusy(int8_t v) {
+    if (busyPrev[v] >= 0) busyNext[busyPrev[v]] = busyNext[v]; else busyHead = busyNext[v];
+    if (busyNext[v] >= 0) busyPrev[busyNext[v]] = busyPrev[v]; else busyTail = busyPrev[v];
+    busyPrev[v] = busyNext[v] = -1;
+    busyCount--;
+  }
+
+  void appendRelease(int8_t v) {
+    releasePrev[v] = releaseTail;
+    releaseNext[v] = -1;
+    if (releaseTail >= 0) releaseNext[releaseTail] = v; else releaseHead = v;
+    releaseTail = v;
+  }
+
+  void unlinkRelease(int8_t v) {
+    if (releasePrev[v] >= 0) releaseNext[releasePrev[v]] = releaseNext[v]; else releaseHead = releaseNext[v];
+    if (releaseNext[v] >= 0) releasePrev[releaseNext[v]] = releasePrev[v]; else releaseTail = releasePrev[v];
+    releasePrev[v] = releaseNext[v] = -1;
+  }
+
+  LevelFunction levelOf;
+
+  int8_t noteVoice[128];          // note -> voice that last played it
+  uint8_t voiceNote[N];
+  uint8_t state[N];
+
+  int8_t freeHead;
+  int8_t freeNext[N];
+
+  int8_t busyHead, busyTail;      // all held and releasing voices, oldest trigger first
+  int8_t busyPrev[N], busyNext[N];
+  uint8_t busyCount;
+  uint8_t limit;                  // most voices allowed to sound at once
+
+  int8_t releaseHead, releaseTail; // releasing voices, oldest release first
+  int8_t releasePrev[N], releaseNext[N];
+
+  bool lastStolen;
+};
+
+// Held-note stack for mono and legato play modes (last note priority)
+template <uint8_t Size = 16>
+class NoteStack {
+public:
+  NoteStack() : count(0) {}
+
+  void push(uint8_t note) {
+    for (uint8_t i = 0; i < count; i++) {
+      if (notes[i] == note) return;
+    }
+    if (count < Size) notes[count++] = note;
+  }
+
+  void remove(uint8_t note) {
+    for (uint8_t i = 0; i < count; i++) {
+      if (notes[i] == note) {
+        for (uint8_t j = i; j < count - 1; j++) {
+          notes[j] = notes[j + 1];
+        }
+        count--;
+        return;
+      }
+    }
+  }
+
+  // Most recent held note, or -1
+  int top() const { return count > 0 ? notes[count - 1] : -1; }
+  uint8_t size() const { return count; }
+  void clear() { count = 0; }
+
+private:
+  uint8_t notes[Size];
+  uint8_t count;
+};
+
+#endif // VoiceAllocator_h_
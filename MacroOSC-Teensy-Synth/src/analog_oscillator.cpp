@@ -31,6 +31,7 @@
 #include "dsp.h"
 
 #include "resources.h"
+#include "shape_groups.h"
 #include "parameter_interpolation.h"
 
 namespace braids {
@@ -473,6 +474,7 @@ FLASHMEM void AnalogOscillator::RenderSine(
   phase_ = phase;
 }
 
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_ANALOG)
 FLASHMEM void AnalogOscillator::RenderTriangleFold(
     const uint8_t* sync_in,
     int16_t* buffer,
@@ -585,6 +587,7 @@ FLASHMEM void AnalogOscillator::RenderBuzz(
     *buffer++ = Crossfade(wave_1, wave_2, phase_, crossfade);
   }
 }
+#endif
 
 /* static */
 AnalogOscillator::RenderFn AnalogOscillator::fn_table_[] = {
@@ -594,9 +597,14 @@ AnalogOscillator::RenderFn AnalogOscillator::fn_table_[] = {
   &AnalogOscillator::RenderSquare,
   &AnalogOscillator::RenderTriangle,
   &AnalogOscillator::RenderSine,
+  // Only the ANALOG macro shapes use the folds and the buzz
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_ANALOG)
   &AnalogOscillator::RenderTriangleFold,
   &AnalogOscillator::RenderSineFold,
   &AnalogOscillator::RenderBuzz,
+#else
+  NULL, NULL, NULL,
+#endif
 };
 
 }  // namespace braids
@@ -34,6 +34,7 @@
 
 #include "parameter_interpolation.h"
 #include "resources.h"
+#include "shape_groups.h"
 
 namespace braids {
 
@@ -46,6 +47,39 @@ static const uint16_t kOctave = 12 * 128;
 static const uint32_t kFIR4Coefficients[4] = { 10530, 14751, 16384, 14751 };
 static const uint32_t kFIR4DcOffset = 28208;
 
+#if BRAIDS_DELAY_LINE_SLABS > 32
+#error "BRAIDS_DELAY_LINE_SLABS: the pool tracks at most 32 slabs"
+#endif
+
+// Shared by all oscillators. Only the audio update renders, so claiming and
+// releasing slabs needs no locking.
+static DMAMEM DelayLines delay_line_pool[BRAIDS_DELAY_LINE_SLABS];
+static uint32_t delay_line_pool_used = 0;
+
+/* static */
+FLASHMEM bool DigitalOscillator::UsesDelayLines(DigitalOscillatorShape shape) {
+  return shape == OSC_SHAPE_COMB_FILTER ||
+      (shape >= OSC_SHAPE_PLUCKED && shape <= OSC_SHAPE_FLUTED);
+}
+
+/* static */
+FLASHMEM DelayLines* DigitalOscillator::AllocateDelayLines() {
+  for (size_t i = 0; i < BRAIDS_DELAY_LINE_SLABS; ++i) {
+    if (!(delay_line_pool_used & (1UL << i))) {
+      delay_line_pool_used |= 1UL << i;
+      // Whatever the previous owner left in it would ring out otherwise.
+      memset(&delay_line_pool[i], 0, sizeof(DelayLines));
+      return &delay_line_pool[i];
+    }
+  }
+  return NULL;
+}
+
+/* static */
+FLASHMEM void DigitalOscillator::FreeDelayLines(DelayLines* lines) {
+  delay_line_pool_used &= ~(1UL << (lines - delay_line_pool));
+}
+
 FLASHMEM uint32_t DigitalOscillator::ComputePhaseIncrement(int16_t midi_pitch) {
   if (midi_pitch >= kPitchTableStart) {
     midi_pitch = kPitchTableStart - 1;
@@ -94,6 +128,7 @@ FLASHMEM void DigitalOscillator::Render(
     int16_t* buffer,
     size_t size) {
 
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_FM)
   // Quantize parameter for FM.
   if (shape_ >= OSC_SHAPE_FM &&
       shape_ <= OSC_SHAPE_CHAOTIC_FEEDBACK_FM) {
@@ -103,6 +138,7 @@ FLASHMEM void DigitalOscillator::Render(
     int16_t b = lut_fm_frequency_quantizer[integral + 1];
     parameter_[1] = a + ((b - a) * fractional >> 8);
   }
+#endif
 
   RenderFn fn = fn_table_[shape_];
 
@@ -112,6 +148,19 @@ FLASHMEM void DigitalOscillator::Render(
     init_ = true;
   }
 
+  if (UsesDelayLines(shape_)) {
+    if (!delay_lines_) {
+      delay_lines_ = AllocateDelayLines();
+      if (!delay_lines_) {
+        // Pool exhausted: this voice sits out until a slab comes free.
+        memset(buffer, 0, size * sizeof(int16_t));
+        return;
+      }
+    }
+  } else {
+    ReleaseDelayLines();
+  }
+
   phase_increment_ = ComputePhaseIncrement(pitch_);
   delay_ = ComputeDelay(pitch_);
 
@@ -124,6 +173,7 @@ FLASHMEM void DigitalOscillator::Render(
   (this->*fn)(sync, buffer, size);
 }
 
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_DUAL)
 FLASHMEM void DigitalOscillator::RenderTripleRingMod(
     const uint8_t* sync,
     int16_t* buffer,
@@ -249,7 +299,7 @@ FLASHMEM void DigitalOscillator::RenderComb(
   filtered_pitch = (15 * filtered_pitch + pitch) >> 4;
   state_.ffm.previous_sample = filtered_pitch;
 
-  int16_t* dl = delay_lines_.comb;
+  int16_t* dl = delay_lines_->comb;
   uint32_t delay = ComputeDelay(filtered_pitch);
   if (delay > (kCombDelayLength << 16)) {
     delay = kCombDelayLength << 16;
@@ -316,6 +366,9 @@ FLASHMEM void DigitalOscillator::RenderToy(
   phase_ = phase;
 }
 
+#endif
+
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_FORMANT)
 const uint32_t kPhaseReset[] = {
   0,
   0x80000000,
@@ -715,6 +768,9 @@ FLASHMEM void DigitalOscillator::RenderVowelFof(
   }
 }
 
+#endif
+
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_FM)
 FLASHMEM void DigitalOscillator::RenderFm(
     const uint8_t* sync,
     int16_t* buffer,
@@ -821,6 +877,9 @@ FLASHMEM void DigitalOscillator::RenderChaoticFeedbackFm(
 }
 
 
+#endif
+
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_PERCUSSION)
 static const int16_t kBellPartials[] = {
   -1284, -1283, -184, -183, 385, 1175, 1536, 2233, 2434, 2934, 3110
 };
@@ -918,6 +977,9 @@ FLASHMEM void DigitalOscillator::RenderStruckBell(
   state_.add.previous_sample = previous_sample;
 }
 
+#endif
+
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_HARMONICS)
 FLASHMEM void DigitalOscillator::RenderHarmonics(
     const uint8_t* sync,
     int16_t* buffer,
@@ -985,6 +1047,9 @@ FLASHMEM void DigitalOscillator::RenderHarmonics(
   }
 }
 
+#endif
+
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_PERCUSSION)
 FLASHMEM void DigitalOscillator::RenderStruckDrum(
     const uint8_t* sync,
     int16_t* buffer,
@@ -1083,6 +1148,9 @@ FLASHMEM void DigitalOscillator::RenderStruckDrum(
   }
 }
 
+#endif
+
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_PHYSICAL)
 FLASHMEM void DigitalOscillator::RenderPlucked(
     const uint8_t* sync,
     int16_t* buffer,
@@ -1140,7 +1208,7 @@ FLASHMEM void DigitalOscillator::RenderPlucked(
     int32_t sample = 0;
     for (size_t i = 0; i < kNumPluckVoices; ++i) {
       PluckState* p = &state_.plk[i];
-      int16_t* dl = delay_lines_.ks + i * 1025;
+      int16_t* dl = delay_lines_->ks + i * kKarplusStrongLength;
       // Initialization: Just use a white noise sample and fill the delay
       // line.
       if (p->initialization_ptr) {
@@ -1196,12 +1264,12 @@ FLASHMEM void DigitalOscillator::RenderBowed(
     const uint8_t* sync,
     int16_t* buffer,
     size_t size) {
-  int8_t* dl_b = delay_lines_.bowed.bridge;
-  int8_t* dl_n = delay_lines_.bowed.neck;
+  int8_t* dl_b = delay_lines_->bowed.bridge;
+  int8_t* dl_n = delay_lines_->bowed.neck;
 
   if (strike_) {
-    memset(dl_b, 0, sizeof(delay_lines_.bowed.bridge));
-    memset(dl_n, 0, sizeof(delay_lines_.bowed.neck));
+    memset(dl_b, 0, sizeof(delay_lines_->bowed.bridge));
+    memset(dl_n, 0, sizeof(delay_lines_->bowed.neck));
     memset(&state_, 0, sizeof(state_));
     strike_ = false;
   }
@@ -1280,7 +1348,11 @@ FLASHMEM void DigitalOscillator::RenderBowed(
     *buffer++ = (out + previous_sample) >> 1;
     *buffer++ = out;
     previous_sample = out;
-    ++excitation_ptr;
+    // Hold at the sustain part here rather than once per call, which only
+    // kept the index in range for the firmware's 24-sample blocks
+    if ((excitation_ptr >> 1) < LUT_BOWING_ENVELOPE_SIZE - 32) {
+      ++excitation_ptr;
+    }
     size -= 2;
   }
   if ((excitation_ptr >> 1) >= LUT_BOWING_ENVELOPE_SIZE - 32) {
@@ -1306,9 +1378,9 @@ FLASHMEM void DigitalOscillator::RenderBlown(
   uint16_t delay_ptr = state_.phy.delay_ptr;
   int32_t lp_state = state_.phy.lp_state;
 
-  int16_t* dl = delay_lines_.bore;
+  int16_t* dl = delay_lines_->bore;
   if (strike_) {
-    memset(dl, 0, sizeof(delay_lines_.bore));
+    memset(dl, 0, sizeof(delay_lines_->bore));
     strike_ = false;
   }
 
@@ -1374,13 +1446,13 @@ FLASHMEM void DigitalOscillator::RenderFluted(
   int32_t dc_blocking_x0 = state_.phy.filter_state[0];
   int32_t dc_blocking_y0 = state_.phy.filter_state[1];
 
-  int8_t* dl_b = delay_lines_.fluted.bore;
-  int8_t* dl_j = delay_lines_.fluted.jet;
+  int8_t* dl_b = delay_lines_->fluted.bore;
+  int8_t* dl_j = delay_lines_->fluted.jet;
 
   if (strike_) {
     excitation_ptr = 0;
-    memset(dl_b, 0, sizeof(delay_lines_.fluted.bore));
-    memset(dl_j, 0, sizeof(delay_lines_.fluted.jet));
+    memset(dl_b, 0, sizeof(delay_lines_->fluted.bore));
+    memset(dl_j, 0, sizeof(delay_lines_->fluted.jet));
     lp_state = 0;
     strike_ = false;
   }
@@ -1448,7 +1520,7 @@ FLASHMEM void DigitalOscillator::RenderFluted(
     int32_t out = bore_value >> 1;
     CLIP(out)
     *buffer++ = out;
-    if (size & 3) {
+    if ((size & 3) && excitation_ptr < LUT_BLOWING_ENVELOPE_SIZE - 32) {
       ++excitation_ptr;
     }
   }
@@ -1462,372 +1534,416 @@ FLASHMEM void DigitalOscillator::RenderFluted(
   state_.phy.filter_state[1] = dc_blocking_y0;
 }
 
-// struct WavetableDefinition {
-//   uint8_t num_steps;
-//   uint8_t wave_index[17];
-// };
-
-// static const WavetableDefinition wavetable_definitions[] = {
-// // 01 male
-// { 16 , { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 15 } },
-// // 02 female
-// { 16 , { 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 31 } },
-// // 03 choir
-// { 16 , { 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 47 } },
-// // 04 space_voice
-// { 16 , { 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 63 } },
-// // 05 tampura
-// { 16 , { 64, 65, 66, 67, 68, 68, 69, 70, 71, 72, 73, 73, 74, 75, 75, 76, 76 } },
-// // 06 shamus
-// { 16 , { 77, 78, 79, 80, 81, 82, 83, 84, 85, 86, 87, 88, 89, 90, 91, 92, 92 } },
-// // 07 swept_string
-// { 16 , { 93, 94, 95, 96, 97, 98, 99, 100, 101,
-//          102, 103, 104, 105, 106, 107, 108, 108 } },
-// // 08 bowed
-// { 16 , { 109, 110, 111, 112, 113, 114, 115, 116,
-//          117, 118, 119, 120, 121, 122, 123, 124, 124 } },
-// // 09 cello
-// { 16 , { 125, 126, 127, 128, 129, 130, 131, 132,
-//          132, 132, 132, 132, 132, 132, 132, 132, 132 } },
-// // 10 vibes
-// { 16 , { 133, 134, 135, 136, 137, 138, 139, 140,
-//          141, 142, 143, 144, 144, 144, 145, 145, 145 } },
-// // 11 slap
-// { 16 , { 146, 147, 148, 149, 150, 151, 151, 151,
-//          152, 152, 152, 152, 153, 153, 153, 153, 153 } },
-// // 12 piano
-// { 8 , { 154, 154, 154, 154, 154, 154, 155, 156, 156 } },
-// // 13 organ!
-// { 16 , { 176, 157, 158, 159, 160, 161, 162, 163,
-//          164, 165, 166, 167, 168, 169, 170, 171, 171 } },
-// // 14 waves!
-// { 16 , { 172, 173, 174, 175, 176, 177, 178, 179,
-//          180, 181, 182, 183, 184, 185, 186, 187, 187 } },
-// // 15 digital
-// { 16 , { 176, 188, 189, 190, 191, 192, 193, 194,
-//          195, 196, 197, 198, 199, 200, 201, 202, 202 } },
-// // 16 drone 1
-// { 16 , { 203, 205, 204, 205, 212, 206, 207, 208,
-//          208, 209, 210, 210, 211, 211, 212, 212, 212 } },
-// // 17 drone 2
-// { 8 , { 213, 213, 213, 214, 215, 216, 217, 218, 219 } },
-// // 18 metallic
-// { 16 , { 220, 221, 222, 223, 224, 225, 226, 227,
-//          228, 229, 230, 231, 232, 233, 234, 235, 235 } },
-// // 19 fantasy
-// { 16 , { 236, 237, 238, 239, 240, 241, 242, 243,
-//          244, 245, 246, 247, 248, 249, 250, 251, 251 } },
-// // 20 bell
-// { 4 , { 252, 253, 254, 255, 254 } },
-// };
-
-//void DigitalOscillator::RenderWavetables(
-//    const uint8_t* sync,
-//    int16_t* buffer,
-//    size_t size) {
-//  // Add some hysteresis to the second parameter to prevent a single DAC bit
-//  // error to cause a sharp and glitchy wavetable transition.
-//  if ((parameter_[1] > previous_parameter_[1] + 64) ||
-//      (parameter_[1] < previous_parameter_[1] - 64)) {
-//    previous_parameter_[1] = parameter_[1];
-//  }
-//
-//  uint32_t wavetable_index = static_cast<uint32_t>(previous_parameter_[1]) * 20;
-//  wavetable_index >>= 15;
-//
-//  uint32_t wave_pointer;
-//  const uint8_t* wave[2];
-//  const WavetableDefinition& wt = wavetable_definitions[wavetable_index];
-//
-//  wave_pointer = (parameter_[0] << 1) * wt.num_steps;
-//  for (size_t i = 0; i < 2; ++i) {
-//    size_t wave_index = wt.wave_index[(wave_pointer >> 16) + i];
-//    wave[i] = wt_waves + wave_index * 129;
-//  }
-//
-//  uint32_t phase_increment = phase_increment_ >> 1;
-//  while (size--) {
-//    int16_t sample;
-//    // 2x naive oversampling.
-//    phase_ += phase_increment;
-//    if (*sync++) {
-//      phase_ = 0;
-//    }
-//
-//    sample = Crossfade(wave[0], wave[1], phase_ >> 1, wave_pointer) >> 1;
-//    phase_ += phase_increment;
-//    sample += Crossfade(wave[0], wave[1], phase_ >> 1, wave_pointer) >> 1;
-//    *buffer++ = sample;
-//  }
-//}
+#endif
+
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_WAVETABLE)
+// Wave frames are read from flash through a small per-voice cache. A block
+// interpolates between at most four frames (WMAP), so each one is copied to
+// RAM once when the render function first asks for it and then stays put
+// for as long as the timbre/color settings keep pointing at it.
+FLASHMEM const uint8_t* DigitalOscillator::CachedWave(uint8_t index) {
+#ifdef BRAIDS_WAVE_CACHE_BYPASS
+  // Host check only (tools/wave_cache_check.py): every frame from flash
+  return wt_waves + index * kWaveFrameSize;
+#endif
+  for (size_t i = 0; i < kNumCachedWaves; ++i) {
+    if (wave_cache_index_[i] == index) {
+      wave_cache_used_ |= 1 << i;
+      return wave_cache_[i];
+    }
+  }
+  // Miss: refill a slot that no other frame of this block is using. If all
+  // of them are, read this frame straight from flash rather than evict one
+  // a caller still points at.
+  size_t slot = wave_cache_next_;
+  size_t tries = 0;
+  while (wave_cache_used_ & (1 << slot)) {
+    if (++tries == kNumCachedWaves) {
+      return wt_waves + index * kWaveFrameSize;
+    }
+    slot = (slot + 1) % kNumCachedWaves;
+  }
+  wave_cache_next_ = (slot + 1) % kNumCachedWaves;
+  memcpy(wave_cache_[slot], wt_waves + index * kWaveFrameSize, kWaveFrameSize);
+  wave_cache_index_[slot] = index;
+  wave_cache_used_ |= 1 << slot;
+  return wave_cache_[slot];
+}
 
-//void DigitalOscillator::RenderWaveMap(
-//    const uint8_t* sync,
-//    int16_t* buffer,
-//    size_t size) {
-//
-//  // The grid is 16x16; so there are 15 interpolation squares.
-//  uint16_t p[2];
-//  uint16_t wave_xfade[2];
-//  uint16_t wave_coordinate[2];
-//
-//  p[0] = parameter_[0] * 15 >> 4;
-//  p[1] = parameter_[1] * 15 >> 4;
-//  wave_xfade[0] = p[0] << 5;
-//  wave_xfade[1] = p[1] << 5;
-//  wave_coordinate[0] = p[0] >> 11;
-//  wave_coordinate[1] = p[1] >> 11;
-//
-//  const uint8_t* wave[2][2];
-//
-//  for (size_t i = 0; i < 2; ++i) {
-//    for (size_t j = 0; j < 2; ++j) {
-//      uint16_t wave_index = (wave_coordinate[0] + i) * 16 + (wave_coordinate[1] + j);
-//      wave[i][j] = wt_waves + wt_map[wave_index] * 129;
-//    }
-//  }
-//
-//  uint32_t phase_increment = phase_increment_ >> 1;
-//  while (size--) {
-//    int16_t sample;
-//    // 2x naive oversampling.
-//    phase_ += phase_increment;
-//    if (*sync++) {
-//      phase_ = 0;
-//    }
-//
-//    sample = Mix(
-//        Crossfade(wave[0][0], wave[0][1], phase_ >> 1, wave_xfade[1]),
-//        Crossfade(wave[1][0], wave[1][1], phase_ >> 1, wave_xfade[1]),
-//        wave_xfade[0]) >> 1;
-//    phase_ += phase_increment;
-//    sample += Mix(
-//        Crossfade(wave[0][0], wave[0][1], phase_ >> 1, wave_xfade[1]),
-//        Crossfade(wave[1][0], wave[1][1], phase_ >> 1, wave_xfade[1]),
-//        wave_xfade[0]) >> 1;
-//    *buffer++ = sample;
-//  }
-//}
+struct WavetableDefinition {
+  uint8_t num_steps;
+  uint8_t wave_index[17];
+};
 
-//static const uint8_t wave_line[] = {
-//  187, 179, 154, 155, 135, 134, 137, 19, 24, 3, 8, 66, 79, 25, 180, 174, 64,
-//  127, 198, 15, 10, 7, 11, 0, 191, 192, 115, 238, 237, 236, 241, 47, 70, 76,
-//  235, 26, 133, 208, 34, 175, 183, 146, 147, 148, 150, 151, 152, 153, 117,
-//  138, 32, 33, 35, 125, 199, 201, 30, 31, 193, 27, 29, 21, 18, 182
-//};
+static const WavetableDefinition wavetable_definitions[] = {
+// 01 male
+{ 16 , { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 15 } },
+// 02 female
+{ 16 , { 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 31 } },
+// 03 choir
+{ 16 , { 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 47 } },
+// 04 space_voice
+{ 16 , { 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 63 } },
+// 05 tampura
+{ 16 , { 64, 65, 66, 67, 68, 68, 69, 70, 71, 72, 73, 73, 74, 75, 75, 76, 76 } },
+// 06 shamus
+{ 16 , { 77, 78, 79, 80, 81, 82, 83, 84, 85, 86, 87, 88, 89, 90, 91, 92, 92 } },
+// 07 swept_string
+{ 16 , { 93, 94, 95, 96, 97, 98, 99, 100, 101,
+         102, 103, 104, 105, 106, 107, 108, 108 } },
+// 08 bowed
+{ 16 , { 109, 110, 111, 112, 113, 114, 115, 116,
+         117, 118, 119, 120, 121, 122, 123, 124, 124 } },
+// 09 cello
+{ 16 , { 125, 126, 127, 128, 129, 130, 131, 132,
+         132, 132, 132, 132, 132, 132, 132, 132, 132 } },
+// 10 vibes
+{ 16 , { 133, 134, 135, 136, 137, 138, 139, 140,
+         141, 142, 143, 144, 144, 144, 145, 145, 145 } },
+// 11 slap
+{ 16 , { 146, 147, 148, 149, 150, 151, 151, 151,
+         152, 152, 152, 152, 153, 153, 153, 153, 153 } },
+// 12 piano
+{ 8 , { 154, 154, 154, 154, 154, 154, 155, 156, 156 } },
+// 13 organ!
+{ 16 , { 176, 157, 158, 159, 160, 161, 162, 163,
+         164, 165, 166, 167, 168, 169, 170, 171, 171 } },
+// 14 waves!
+{ 16 , { 172, 173, 174, 175, 176, 177, 178, 179,
+         180, 181, 182, 183, 184, 185, 186, 187, 187 } },
+// 15 digital
+{ 16 , { 176, 188, 189, 190, 191, 192, 193, 194,
+         195, 196, 197, 198, 199, 200, 201, 202, 202 } },
+// 16 drone 1
+{ 16 , { 203, 205, 204, 205, 212, 206, 207, 208,
+         208, 209, 210, 210, 211, 211, 212, 212, 212 } },
+// 17 drone 2
+{ 8 , { 213, 213, 213, 214, 215, 216, 217, 218, 219 } },
+// 18 metallic
+{ 16 , { 220, 221, 222, 223, 224, 225, 226, 227,
+         228, 229, 230, 231, 232, 233, 234, 235, 235 } },
+// 19 fantasy
+{ 16 , { 236, 237, 238, 239, 240, 241, 242, 243,
+         244, 245, 246, 247, 248, 249, 250, 251, 251 } },
+// 20 bell
+{ 4 , { 252, 253, 254, 255, 254 } },
+};
 
+FLASHMEM void DigitalOscillator::RenderWavetables(
+    const uint8_t* sync,
+    int16_t* buffer,
+    size_t size) {
+  wave_cache_used_ = 0;
+  // Add some hysteresis to the second parameter to prevent a single DAC bit
+  // error to cause a sharp and glitchy wavetable transition.
+  if ((parameter_[1] > previous_parameter_[1] + 64) ||
+      (parameter_[1] < previous_parameter_[1] - 64)) {
+    previous_parameter_[1] = parameter_[1];
+  }
 
-//static const uint8_t mini_wave_line[] = {
-//  157, 161, 171, 188, 189, 191, 192, 193, 196, 198, 201, 234, 232,
-//  229, 226, 224, 1, 2, 3, 4, 5, 8, 12, 32, 36, 42, 47, 252, 254, 141, 139,
-//  135, 174
-//};
+  uint32_t wavetable_index = static_cast<uint32_t>(previous_parameter_[1]) * 20;
+  wavetable_index >>= 15;
 
-//void DigitalOscillator::RenderWaveLine(
-//    const uint8_t* sync,
-//    int16_t* buffer,
-//    size_t size) {
-//  smoothed_parameter_ = (3 * smoothed_parameter_ + (parameter_[0] << 1)) >> 2;
-//
-//  uint16_t scan = smoothed_parameter_;
-//  const uint8_t* wave_0 = wt_waves + wave_line[previous_parameter_[0] >> 9] * 129;
-//  const uint8_t* wave_1 = wt_waves + wave_line[scan >> 10] * 129;
-//  const uint8_t* wave_2 = wt_waves + wave_line[(scan >> 10) + 1] * 129;
-//
-//  uint16_t smooth_xfade = scan << 6;
-//  uint16_t rough_xfade = 0;
-//  uint16_t rough_xfade_increment = 32768 / size;
-//  uint32_t balance = parameter_[1] << 3;
-//
-//  uint32_t phase = phase_;
-//  uint32_t phase_increment = phase_increment_ >> 1;
-//
-//  int16_t rough, smooth;
-//
-//  if (parameter_[1] < 8192) {
-//    while (size--) {
-//      if (*sync++) {
-//        phase = 0;
-//      }
-//      int32_t sample = 0;
-//
-//      rough = Crossfade(wave_0, wave_1, (phase >> 1) & 0xfe000000, rough_xfade);
-//      smooth = Crossfade(wave_0, wave_1, phase >> 1, rough_xfade);
-//      sample += Mix(rough, smooth, balance);
-//      phase += phase_increment;
-//      rough_xfade += rough_xfade_increment;
-//
-//      rough = Crossfade(wave_0, wave_1, (phase >> 1) & 0xfe000000, rough_xfade);
-//      smooth = Crossfade(wave_0, wave_1, phase >> 1, rough_xfade);
-//      sample += Mix(rough, smooth, balance);
-//      phase += phase_increment;
-//      rough_xfade += rough_xfade_increment;
-//
-//      *buffer++ = sample >> 1;
-//    }
-//  } else if (parameter_[1] < 16384) {
-//    while (size--) {
-//      if (*sync++) {
-//        phase = 0;
-//      }
-//      int32_t sample = 0;
-//
-//      rough = Crossfade(wave_0, wave_1, phase >> 1, rough_xfade);
-//      smooth = Crossfade(wave_1, wave_2, phase >> 1, smooth_xfade);
-//      sample += Mix(rough, smooth, balance);
-//      phase += phase_increment;
-//      rough_xfade += rough_xfade_increment;
-//
-//      rough = Crossfade(wave_0, wave_1, phase >> 1, rough_xfade);
-//      smooth = Crossfade(wave_1, wave_2, phase >> 1, smooth_xfade);
-//      sample += Mix(rough, smooth, balance);
-//      phase += phase_increment;
-//      rough_xfade += rough_xfade_increment;
-//
-//      *buffer++ = sample >> 1;
-//    }
-//  } else if (parameter_[1] < 24576) {
-//    while (size--) {
-//      if (*sync++) {
-//        phase = 0;
-//      }
-//      int32_t sample = 0;
-//
-//      smooth = Crossfade(wave_1, wave_2, phase >> 1, smooth_xfade);
-//      rough = Crossfade(wave_1, wave_2, (phase >> 1) & 0xfe000000, smooth_xfade);
-//      sample += Mix(smooth, rough, balance);
-//      phase += phase_increment;
-//
-//      smooth = Crossfade(wave_1, wave_2, phase >> 1, smooth_xfade);
-//      rough = Crossfade(wave_1, wave_2, (phase >> 1) & 0xfe000000, smooth_xfade);
-//      sample += Mix(smooth, rough, balance);
-//      phase += phase_increment;
-//
-//      *buffer++ = sample >> 1;
-//    }
-//  } else {
-//    while (size--) {
-//      if (*sync++) {
-//        phase = 0;
-//      }
-//      int32_t sample = 0;
-//      smooth = Crossfade(wave_1, wave_2, (phase >> 1) & 0xfe000000, smooth_xfade);
-//      rough = Crossfade(wave_1, wave_2, (phase >> 1) & 0xf8000000, smooth_xfade);
-//      sample += Mix(smooth, rough, balance);
-//      phase += phase_increment;
-//
-//      smooth = Crossfade(wave_1, wave_2, (phase >> 1) & 0xfe000000, smooth_xfade);
-//      rough = Crossfade(wave_1, wave_2, (phase >> 1) & 0xf8000000, smooth_xfade);
-//      sample += Mix(smooth, rough, balance);
-//      phase += phase_increment;
-//
-//      *buffer++ = sample >> 1;
-//    }
-//  }
-//  phase_ = phase;
-//  previous_parameter_[0] = smoothed_parameter_ >> 1;
-//}
+  uint32_t wave_pointer;
+  const uint8_t* wave[2];
+  const WavetableDefinition& wt = wavetable_definitions[wavetable_index];
+
+  wave_pointer = (parameter_[0] << 1) * wt.num_steps;
+  for (size_t i = 0; i < 2; ++i) {
+    size_t wave_index = wt.wave_index[(wave_pointer >> 16) + i];
+    wave[i] = CachedWave(wave_index);
+  }
+
+  uint32_t phase_increment = phase_increment_ >> 1;
+  while (size--) {
+    int16_t sample;
+    // 2x naive oversampling.
+    phase_ += phase_increment;
+    if (*sync++) {
+      phase_ = 0;
+    }
+
+    sample = Crossfade(wave[0], wave[1], phase_ >> 1, wave_pointer) >> 1;
+    phase_ += phase_increment;
+    sample += Crossfade(wave[0], wave[1], phase_ >> 1, wave_pointer) >> 1;
+    *buffer++ = sample;
+  }
+}
+
+FLASHMEM void DigitalOscillator::RenderWaveMap(
+    const uint8_t* sync,
+    int16_t* buffer,
+    size_t size) {
+  wave_cache_used_ = 0;
+
+  // The grid is 16x16; so there are 15 interpolation squares.
+  uint16_t p[2];
+  uint16_t wave_xfade[2];
+  uint16_t wave_coordinate[2];
+
+  p[0] = parameter_[0] * 15 >> 4;
+  p[1] = parameter_[1] * 15 >> 4;
+  wave_xfade[0] = p[0] << 5;
+  wave_xfade[1] = p[1] << 5;
+  wave_coordinate[0] = p[0] >> 11;
+  wave_coordinate[1] = p[1] >> 11;
+
+  const uint8_t* wave[2][2];
+
+  for (size_t i = 0; i < 2; ++i) {
+    for (size_t j = 0; j < 2; ++j) {
+      uint16_t wave_index = (wave_coordinate[0] + i) * 16 + (wave_coordinate[1] + j);
+      wave[i][j] = CachedWave(wt_map[wave_index]);
+    }
+  }
+
+  uint32_t phase_increment = phase_increment_ >> 1;
+  while (size--) {
+    int16_t sample;
+    // 2x naive oversampling.
+    phase_ += phase_increment;
+    if (*sync++) {
+      phase_ = 0;
+    }
+
+    sample = Mix(
+        Crossfade(wave[0][0], wave[0][1], phase_ >> 1, wave_xfade[1]),
+        Crossfade(wave[1][0], wave[1][1], phase_ >> 1, wave_xfade[1]),
+        wave_xfade[0]) >> 1;
+    phase_ += phase_increment;
+    sample += Mix(
+        Crossfade(wave[0][0], wave[0][1], phase_ >> 1, wave_xfade[1]),
+        Crossfade(wave[1][0], wave[1][1], phase_ >> 1, wave_xfade[1]),
+        wave_xfade[0]) >> 1;
+    *buffer++ = sample;
+  }
+}
+
+static const uint8_t wave_line[] = {
+  187, 179, 154, 155, 135, 134, 137, 19, 24, 3, 8, 66, 79, 25, 180, 174, 64,
+  127, 198, 15, 10, 7, 11, 0, 191, 192, 115, 238, 237, 236, 241, 47, 70, 76,
+  235, 26, 133, 208, 34, 175, 183, 146, 147, 148, 150, 151, 152, 153, 117,
+  138, 32, 33, 35, 125, 199, 201, 30, 31, 193, 27, 29, 21, 18, 182
+};
+
+
+static const uint8_t mini_wave_line[] = {
+  157, 161, 171, 188, 189, 191, 192, 193, 196, 198, 201, 234, 232,
+  229, 226, 224, 1, 2, 3, 4, 5, 8, 12, 32, 36, 42, 47, 252, 254, 141, 139,
+  135, 174
+};
+
+FLASHMEM void DigitalOscillator::RenderWaveLine(
+    const uint8_t* sync,
+    int16_t* buffer,
+    size_t size) {
+  wave_cache_used_ = 0;
+  smoothed_parameter_ = (3 * smoothed_parameter_ + (parameter_[0] << 1)) >> 2;
+
+  uint16_t scan = smoothed_parameter_;
+  const uint8_t* wave_0 = CachedWave(wave_line[previous_parameter_[0] >> 9]);
+  const uint8_t* wave_1 = CachedWave(wave_line[scan >> 10]);
+  // The last step has no right neighbour; hold it at full timbre.
+  const uint8_t* wave_2 = CachedWave(wave_line[std::min((scan >> 10) + 1, 63)]);
+
+  uint16_t smooth_xfade = scan << 6;
+  uint16_t rough_xfade = 0;
+  uint16_t rough_xfade_increment = 32768 / size;
+  uint32_t balance = parameter_[1] << 3;
+
+  uint32_t phase = phase_;
+  uint32_t phase_increment = phase_increment_ >> 1;
+
+  int16_t rough, smooth;
+
+  if (parameter_[1] < 8192) {
+    while (size--) {
+      if (*sync++) {
+        phase = 0;
+      }
+      int32_t sample = 0;
+
+      rough = Crossfade(wave_0, wave_1, (phase >> 1) & 0xfe000000, rough_xfade);
+      smooth = Crossfade(wave_0, wave_1, phase >> 1, rough_xfade);
+      sample += Mix(rough, smooth, balance);
+      phase += phase_increment;
+      rough_xfade += rough_xfade_increment;
+
+      rough = Crossfade(wave_0, wave_1, (phase >> 1) & 0xfe000000, rough_xfade);
+      smooth = Crossfade(wave_0, wave_1, phase >> 1, rough_xfade);
+      sample += Mix(rough, smooth, balance);
+      phase += phase_increment;
+      rough_xfade += rough_xfade_increment;
+
+      *buffer++ = sample >> 1;
+    }
+  } else if (parameter_[1] < 16384) {
+    while (size--) {
+      if (*sync++) {
+        phase = 0;
+      }
+      int32_t sample = 0;
+
+      rough = Crossfade(wave_0, wave_1, phase >> 1, rough_xfade);
+      smooth = Crossfade(wave_1, wave_2, phase >> 1, smooth_xfade);
+      sample += Mix(rough, smooth, balance);
+      phase += phase_increment;
+      rough_xfade += rough_xfade_increment;
+
+      rough = Crossfade(wave_0, wave_1, phase >> 1, rough_xfade);
+      smooth = Crossfade(wave_1, wave_2, phase >> 1, smooth_xfade);
+      sample += Mix(rough, smooth, balance);
+      phase += phase_increment;
+      rough_xfade += rough_xfade_increment;
+
+      *buffer++ = sample >> 1;
+    }
+  } else if (parameter_[1] < 24576) {
+    while (size--) {
+      if (*sync++) {
+        phase = 0;
+      }
+      int32_t sample = 0;
+
+      smooth = Crossfade(wave_1, wave_2, phase >> 1, smooth_xfade);
+      rough = Crossfade(wave_1, wave_2, (phase >> 1) & 0xfe000000, smooth_xfade);
+      sample += Mix(smooth, rough, balance);
+      phase += phase_increment;
+
+      smooth = Crossfade(wave_1, wave_2, phase >> 1, smooth_xfade);
+      rough = Crossfade(wave_1, wave_2, (phase >> 1) & 0xfe000000, smooth_xfade);
+      sample += Mix(smooth, rough, balance);
+      phase += phase_increment;
+
+      *buffer++ = sample >> 1;
+    }
+  } else {
+    while (size--) {
+      if (*sync++) {
+        phase = 0;
+      }
+      int32_t sample = 0;
+      smooth = Crossfade(wave_1, wave_2, (phase >> 1) & 0xfe000000, smooth_xfade);
+      rough = Crossfade(wave_1, wave_2, (phase >> 1) & 0xf8000000, smooth_xfade);
+      sample += Mix(smooth, rough, balance);
+      phase += phase_increment;
+
+      smooth = Crossfade(wave_1, wave_2, (phase >> 1) & 0xfe000000, smooth_xfade);
+      rough = Crossfade(wave_1, wave_2, (phase >> 1) & 0xf8000000, smooth_xfade);
+      sample += Mix(smooth, rough, balance);
+      phase += phase_increment;
+
+      *buffer++ = sample >> 1;
+    }
+  }
+  phase_ = phase;
+  previous_parameter_[0] = smoothed_parameter_ >> 1;
+}
 
 #define SEMI * 128
 
-// static const uint16_t chords[17][3] = {
-//   { 2, 4, 6 },
-//   { 16, 32, 48 },
-//   { 2 SEMI, 7 SEMI, 12 SEMI },
-//   { 3 SEMI, 7 SEMI, 10 SEMI },
-//   { 3 SEMI, 7 SEMI, 12 SEMI },
-//   { 3 SEMI, 7 SEMI, 14 SEMI },
-//   { 3 SEMI, 7 SEMI, 17 SEMI },
-//   { 7 SEMI, 12 SEMI, 19 SEMI },
-//   { 7 SEMI, 3 + 12 SEMI, 5 + 19 SEMI },
-//   { 4 SEMI, 7 SEMI, 17 SEMI },
-//   { 4 SEMI, 7 SEMI, 14 SEMI },
-//   { 4 SEMI, 7 SEMI, 12 SEMI },
-//   { 4 SEMI, 7 SEMI, 11 SEMI },
-//   { 5 SEMI, 7 SEMI, 12 SEMI },
-//   { 4, 7 SEMI, 12 SEMI },
-//   { 4, 4 + 12 SEMI, 12 SEMI },
-//   { 4, 4 + 12 SEMI, 12 SEMI },
-// };
-
-//void DigitalOscillator::RenderWaveParaphonic(
-//    const uint8_t* sync,
-//    int16_t* buffer,
-//    size_t size) {
-//  if (strike_) {
-//    for (size_t i = 0; i < 4; ++i) {
-//      state_.saw.phase[i] = Random::GetWord();
-//    }
-//    strike_ = false;
-//  }
-//
-//  // Do not use an array here to allow these to be kept in arbitrary registers.
-//  uint32_t phase_0, phase_1, phase_2, phase_3;
-//  uint32_t phase_increment[3];
-//  uint32_t phase_increment_0;
-//
-//  phase_increment_0 = phase_increment_;
-//  phase_0 = state_.saw.phase[0];
-//  phase_1 = state_.saw.phase[1];
-//  phase_2 = state_.saw.phase[2];
-//  phase_3 = state_.saw.phase[3];
-//
-//  uint16_t chord_integral = parameter_[1] >> 11;
-//  uint16_t chord_fractional = parameter_[1] << 5;
-//  if (chord_fractional < 30720) {
-//    chord_fractional = 0;
-//  } else if (chord_fractional >= 34816) {
-//    chord_fractional = 65535;
-//  } else {
-//    chord_fractional = (chord_fractional - 30720) * 16;
-//  }
-//
-//  for (size_t i = 0; i < 3; ++i) {
-//    uint16_t detune_1 = chords[chord_integral][i];
-//    uint16_t detune_2 = chords[chord_integral + 1][i];
-//    uint16_t detune = detune_1 + ((detune_2 - detune_1) * chord_fractional >> 16);
-//    phase_increment[i] = ComputePhaseIncrement(pitch_ + detune);
-//  }
-//
-//  const uint8_t* wave_1 = wt_waves + mini_wave_line[parameter_[0] >> 10] * 129;
-//  const uint8_t* wave_2 = wt_waves + mini_wave_line[(parameter_[0] >> 10) + 1] * 129;
-//  uint16_t wave_xfade = parameter_[0] << 6;
-//
-//  while (size) {
-//    int32_t sample = 0;
-//
-//    phase_0 += phase_increment_0;
-//    phase_1 += phase_increment[0];
-//    phase_2 += phase_increment[1];
-//    phase_3 += phase_increment[2];
-//
-//    sample += Crossfade(wave_1, wave_2, phase_0 >> 1, wave_xfade);
-//    sample += Crossfade(wave_1, wave_2, phase_1 >> 1, wave_xfade);
-//    sample += Crossfade(wave_1, wave_2, phase_2 >> 1, wave_xfade);
-//    sample += Crossfade(wave_1, wave_2, phase_3 >> 1, wave_xfade);
-//    *buffer++ = sample >> 2;
-//
-//    phase_0 += phase_increment_0;
-//    phase_1 += phase_increment[0];
-//    phase_2 += phase_increment[1];
-//    phase_3 += phase_increment[2];
-//
-//    sample = 0;
-//    sample += Crossfade(wave_1, wave_2, phase_0 >> 1, wave_xfade);
-//    sample += Crossfade(wave_1, wave_2, phase_1 >> 1, wave_xfade);
-//    sample += Crossfade(wave_1, wave_2, phase_2 >> 1, wave_xfade);
-//    sample += Crossfade(wave_1, wave_2, phase_3 >> 1, wave_xfade);
-//    *buffer++ = sample >> 2;
-//    size -= 2;
-//  }
-//
-//  state_.saw.phase[0] = phase_0;
-//  state_.saw.phase[1] = phase_1;
-//  state_.saw.phase[2] = phase_2;
-//  state_.saw.phase[3] = phase_3;
-//
-//}
+static const uint16_t chords[17][3] = {
+  { 2, 4, 6 },
+  { 16, 32, 48 },
+  { 2 SEMI, 7 SEMI, 12 SEMI },
+  { 3 SEMI, 7 SEMI, 10 SEMI },
+  { 3 SEMI, 7 SEMI, 12 SEMI },
+  { 3 SEMI, 7 SEMI, 14 SEMI },
+  { 3 SEMI, 7 SEMI, 17 SEMI },
+  { 7 SEMI, 12 SEMI, 19 SEMI },
+  { 7 SEMI, 3 + 12 SEMI, 5 + 19 SEMI },
+  { 4 SEMI, 7 SEMI, 17 SEMI },
+  { 4 SEMI, 7 SEMI, 14 SEMI },
+  { 4 SEMI, 7 SEMI, 12 SEMI },
+  { 4 SEMI, 7 SEMI, 11 SEMI },
+  { 5 SEMI, 7 SEMI, 12 SEMI },
+  { 4, 7 SEMI, 12 SEMI },
+  { 4, 4 + 12 SEMI, 12 SEMI },
+  { 4, 4 + 12 SEMI, 12 SEMI },
+};
+
+FLASHMEM void DigitalOscillator::RenderWaveParaphonic(
+    const uint8_t* sync,
+    int16_t* buffer,
+    size_t size) {
+  wave_cache_used_ = 0;
+  if (strike_) {
+    for (size_t i = 0; i < 4; ++i) {
+      state_.saw.phase[i] = Random::GetWord();
+    }
+    strike_ = false;
+  }
+
+  // Do not use an array here to allow these to be kept in arbitrary registers.
+  uint32_t phase_0, phase_1, phase_2, phase_3;
+  uint32_t phase_increment[3];
+  uint32_t phase_increment_0;
+
+  phase_increment_0 = phase_increment_;
+  phase_0 = state_.saw.phase[0];
+  phase_1 = state_.saw.phase[1];
+  phase_2 = state_.saw.phase[2];
+  phase_3 = state_.saw.phase[3];
+
+  uint16_t chord_integral = parameter_[1] >> 11;
+  uint16_t chord_fractional = parameter_[1] << 5;
+  if (chord_fractional < 30720) {
+    chord_fractional = 0;
+  } else if (chord_fractional >= 34816) {
+    chord_fractional = 65535;
+  } else {
+    chord_fractional = (chord_fractional - 30720) * 16;
+  }
+
+  for (size_t i = 0; i < 3; ++i) {
+    uint16_t detune_1 = chords[chord_integral][i];
+    uint16_t detune_2 = chords[chord_integral + 1][i];
+    uint16_t detune = detune_1 + ((detune_2 - detune_1) * chord_fractional >> 16);
+    phase_increment[i] = ComputePhaseIncrement(pitch_ + detune);
+  }
 
+  const uint8_t* wave_1 = CachedWave(mini_wave_line[parameter_[0] >> 10]);
+  const uint8_t* wave_2 = CachedWave(mini_wave_line[(parameter_[0] >> 10) + 1]);
+  uint16_t wave_xfade = parameter_[0] << 6;
+
+  while (size) {
+    int32_t sample = 0;
+
+    phase_0 += phase_increment_0;
+    phase_1 += phase_increment[0];
+    phase_2 += phase_increment[1];
+    phase_3 += phase_increment[2];
+
+    sample += Crossfade(wave_1, wave_2, phase_0 >> 1, wave_xfade);
+    sample += Crossfade(wave_1, wave_2, phase_1 >> 1, wave_xfade);
+    sample += Crossfade(wave_1, wave_2, phase_2 >> 1, wave_xfade);
+    sample += Crossfade(wave_1, wave_2, phase_3 >> 1, wave_xfade);
+    *buffer++ = sample >> 2;
+
+    phase_0 += phase_increment_0;
+    phase_1 += phase_increment[0];
+    phase_2 += phase_increment[1];
+    phase_3 += phase_increment[2];
+
+    sample = 0;
+    sample += Crossfade(wave_1, wave_2, phase_0 >> 1, wave_xfade);
+    sample += Crossfade(wave_1, wave_2, phase_1 >> 1, wave_xfade);
+    sample += Crossfade(wave_1, wave_2, phase_2 >> 1, wave_xfade);
+    sample += Crossfade(wave_1, wave_2, phase_3 >> 1, wave_xfade);
+    *buffer++ = sample >> 2;
+    size -= 2;
+  }
+
+  state_.saw.phase[0] = phase_0;
+  state_.saw.phase[1] = phase_1;
+  state_.saw.phase[2] = phase_2;
+  state_.saw.phase[3] = phase_3;
+
+}
+
+#endif
+
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_NOISE)
 FLASHMEM void DigitalOscillator::RenderFilteredNoise(
     const uint8_t* sync,
     int16_t* buffer,
@@ -2176,6 +2292,9 @@ FLASHMEM void DigitalOscillator::RenderParticleNoise(
   state_.pno.filter_coefficient[2] = c3;
 }
 
+#endif
+
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_MODULATION)
 static const int32_t kConstellationQ[] = { 23100, -23100, -23100, 23100 };
 static const int32_t kConstellationI[] = { 23100, 23100, -23100, -23100 };
 
@@ -2298,6 +2417,9 @@ FLASHMEM void DigitalOscillator::RenderDigitalModulation(
 //  phase_ = phase;
 //}
 
+#endif
+
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_PERCUSSION)
 FLASHMEM void DigitalOscillator::RenderKick(
     const uint8_t* sync,
     int16_t* buffer,
@@ -2510,6 +2632,8 @@ FLASHMEM void DigitalOscillator::RenderCymbal(
   }
 }
 
+#endif
+
 /*
 void DigitalOscillator::RenderYourAlgo(
     const uint8_t* sync,
@@ -2523,10 +2647,17 @@ void DigitalOscillator::RenderYourAlgo(
 
 /* static */
 DigitalOscillator::RenderFn DigitalOscillator::fn_table_[] = {
+  // Shapes of groups left out of BRAIDS_SHAPE_GROUPS are never reached:
+  // MacroOscillator plays them as CSAW
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_DUAL)
   &DigitalOscillator::RenderTripleRingMod,
   &DigitalOscillator::RenderSawSwarm,
   &DigitalOscillator::RenderComb,
   &DigitalOscillator::RenderToy,
+#else
+  NULL, NULL, NULL, NULL,
+#endif
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_FORMANT)
   &DigitalOscillator::RenderDigitalFilter,
   &DigitalOscillator::RenderDigitalFilter,
   &DigitalOscillator::RenderDigitalFilter,
@@ -2534,29 +2665,60 @@ DigitalOscillator::RenderFn DigitalOscillator::fn_table_[] = {
   &DigitalOscillator::RenderVosim,
   &DigitalOscillator::RenderVowel,
   &DigitalOscillator::RenderVowelFof,
+#else
+  NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+#endif
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_HARMONICS)
   &DigitalOscillator::RenderHarmonics,
+#else
+  NULL,
+#endif
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_FM)
   &DigitalOscillator::RenderFm,
   &DigitalOscillator::RenderFeedbackFm,
   &DigitalOscillator::RenderChaoticFeedbackFm,
+#else
+  NULL, NULL, NULL,
+#endif
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_PHYSICAL)
   &DigitalOscillator::RenderPlucked,
   &DigitalOscillator::RenderBowed,
   &DigitalOscillator::RenderBlown,
   &DigitalOscillator::RenderFluted,
+#else
+  NULL, NULL, NULL, NULL,
+#endif
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_PERCUSSION)
   &DigitalOscillator::RenderStruckBell,
   &DigitalOscillator::RenderStruckDrum,
   &DigitalOscillator::RenderKick,
   &DigitalOscillator::RenderCymbal,
   &DigitalOscillator::RenderSnare,
-//  &DigitalOscillator::RenderWavetables,
-//  &DigitalOscillator::RenderWaveMap,
-//  &DigitalOscillator::RenderWaveLine,
-//  &DigitalOscillator::RenderWaveParaphonic,
+#else
+  NULL, NULL, NULL, NULL, NULL,
+#endif
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_WAVETABLE)
+  &DigitalOscillator::RenderWavetables,
+  &DigitalOscillator::RenderWaveMap,
+  &DigitalOscillator::RenderWaveLine,
+  &DigitalOscillator::RenderWaveParaphonic,
+#else
+  NULL, NULL, NULL, NULL,
+#endif
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_NOISE)
   &DigitalOscillator::RenderFilteredNoise,
   &DigitalOscillator::RenderTwinPeaksNoise,
   &DigitalOscillator::RenderClockedNoise,
   &DigitalOscillator::RenderGranularCloud,
   &DigitalOscillator::RenderParticleNoise,
+#else
+  NULL, NULL, NULL, NULL, NULL,
+#endif
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_MODULATION)
   &DigitalOscillator::RenderDigitalModulation,
+#else
+  NULL,
+#endif
   // &DigitalOscillator::RenderYourAlgo,
 
 //&DigitalOscillator::RenderQuestionMark
@@ -44,6 +44,9 @@ static const size_t kWGBoreLength = 2048;
 static const size_t kWGJetLength = 1024;
 static const size_t kWGFBoreLength = 4096;
 static const size_t kCombDelayLength = 8192;
+static const size_t kKarplusStrongLength = 1025;
+static const size_t kNumCachedWaves = 4;
+static const size_t kWaveFrameSize = 129;
 
 static const size_t kNumFormants = 5;
 static const size_t kNumPluckVoices = 3;
@@ -72,6 +75,12 @@ enum DigitalOscillatorShape {
   OSC_SHAPE_FEEDBACK_FM,
   OSC_SHAPE_CHAOTIC_FEEDBACK_FM,
 
+  // Same order as fn_table_ and MacroOscillatorShape.
+  OSC_SHAPE_PLUCKED,
+  OSC_SHAPE_BOWED,
+  OSC_SHAPE_BLOWN,
+  OSC_SHAPE_FLUTED,
+
   OSC_SHAPE_STRUCK_BELL,
   OSC_SHAPE_STRUCK_DRUM,
 
@@ -79,15 +88,10 @@ enum DigitalOscillatorShape {
   OSC_SHAPE_HAT,
   OSC_SHAPE_SNARE,
 
-  OSC_SHAPE_PLUCKED,
-  OSC_SHAPE_BOWED,
-  OSC_SHAPE_BLOWN,
-  OSC_SHAPE_FLUTED,
-
-  // OSC_SHAPE_WAVETABLES,
-  // OSC_SHAPE_WAVE_MAP,
-  // OSC_SHAPE_WAVE_LINE,
-  // OSC_SHAPE_WAVE_PARAPHONIC,
+  OSC_SHAPE_WAVETABLES,
+  OSC_SHAPE_WAVE_MAP,
+  OSC_SHAPE_WAVE_LINE,
+  OSC_SHAPE_WAVE_PARAPHONIC,
 
   OSC_SHAPE_FILTERED_NOISE,
   OSC_SHAPE_TWIN_PEAKS_NOISE,
@@ -216,6 +220,28 @@ struct HatState {
   uint32_t rng_state;
 };
 
+// Delay lines of the physical models and the comb filter. Only voices on one
+// of those shapes hold one, claimed from a pool shared by all oscillators.
+union DelayLines {
+  int16_t comb[kCombDelayLength];
+  int16_t ks[kKarplusStrongLength * 4];
+  struct {
+    int8_t bridge[kWGBridgeLength];
+    int8_t neck[kWGNeckLength];
+  } bowed;
+  int16_t bore[kWGBoreLength];
+  struct {
+    int8_t jet[kWGJetLength];
+    int8_t bore[kWGFBoreLength];
+  } fluted;
+};
+
+// Number of delay line slabs in the pool (16 KB each, in DMAMEM). Voices
+// asking for one when all are taken stay silent until one is released.
+#ifndef BRAIDS_DELAY_LINE_SLABS
+#define BRAIDS_DELAY_LINE_SLABS 6
+#endif
+
 union DigitalOscillatorState {
   ResoSquareState res;
   VowelSynthesizerState vow;
@@ -240,7 +266,7 @@ class DigitalOscillator {
  public:
   typedef void (DigitalOscillator::*RenderFn)(const uint8_t*, int16_t*, size_t);
 
-  DigitalOscillator() { }
+  DigitalOscillator() : delay_lines_(NULL) { }
   ~DigitalOscillator() { }
 
   inline void Init() {
@@ -255,6 +281,10 @@ class DigitalOscillator {
     phase_ = 0;
     strike_ = true;
     init_ = true;
+    for (size_t i = 0; i < kNumCachedWaves; ++i) {
+      wave_cache_index_[i] = -1;
+    }
+    wave_cache_next_ = 0;
   }
 
   inline void set_shape(DigitalOscillatorShape shape) {
@@ -285,6 +315,16 @@ class DigitalOscillator {
     strike_ = true;
   }
 
+  // Hand the delay line slab back to the pool, for when the macro oscillator
+  // moves to a shape that does not render through this oscillator, or the
+  // voice stops rendering. The next render takes a cleared slab.
+  inline void ReleaseDelayLines() {
+    if (delay_lines_) {
+      FreeDelayLines(delay_lines_);
+      delay_lines_ = NULL;
+    }
+  }
+
   void Render(const uint8_t* sync, int16_t* buffer, size_t size);
 
  private:
@@ -311,10 +351,10 @@ class DigitalOscillator {
   void RenderBlown(const uint8_t*, int16_t*, size_t);
   void RenderFluted(const uint8_t*, int16_t*, size_t);
 
-//  void RenderWavetables(const uint8_t*, int16_t*, size_t);
-//  void RenderWaveMap(const uint8_t*, int16_t*, size_t);
-//  void RenderWaveLine(const uint8_t*, int16_t*, size_t);
-//  void RenderWaveParaphonic(const uint8_t*, int16_t*, size_t);
+  void RenderWavetables(const uint8_t*, int16_t*, size_t);
+  void RenderWaveMap(const uint8_t*, int16_t*, size_t);
+  void RenderWaveLine(const uint8_t*, int16_t*, size_t);
+  void RenderWaveParaphonic(const uint8_t*, int16_t*, size_t);
 
   void RenderTwinPeaksNoise(const uint8_t*, int16_t*, size_t);
   void RenderFilteredNoise(const uint8_t*, int16_t*, size_t);
@@ -330,6 +370,12 @@ class DigitalOscillator {
 // void RenderQuestionMark(const uint8_t*, int16_t*, size_t);
 // void RenderYourAlgo(const uint8_t*, int16_t*, size_t);
 
+  const uint8_t* CachedWave(uint8_t index);
+
+  static bool UsesDelayLines(DigitalOscillatorShape shape);
+  static DelayLines* AllocateDelayLines();
+  static void FreeDelayLines(DelayLines* lines);
+
   uint32_t ComputePhaseIncrement(int16_t midi_pitch);
   uint32_t ComputeDelay(int16_t midi_pitch);
   int16_t InterpolateFormantParameter(
@@ -359,19 +405,13 @@ class DigitalOscillator {
   Excitation pulse_[4];
   Svf svf_[3];
 
-  union {
-    int16_t comb[kCombDelayLength];
-    int16_t ks[1025 * 4];
-    struct {
-      int8_t bridge[kWGBridgeLength];
-      int8_t neck[kWGNeckLength];
-    } bowed;
-    int16_t bore[kWGBoreLength];
-    struct {
-      int8_t jet[kWGJetLength];
-      int8_t bore[kWGFBoreLength];
-    } fluted;
-  } delay_lines_;
+  DelayLines* delay_lines_;  // NULL unless the shape needs one
+
+  // Wavetable frames currently being interpolated, copied out of flash
+  uint8_t wave_cache_[kNumCachedWaves][kWaveFrameSize];
+  int16_t wave_cache_index_[kNumCachedWaves];
+  uint8_t wave_cache_used_;  // slots referenced by the block being rendered
+  uint8_t wave_cache_next_;
 
   static RenderFn fn_table_[];
 
@@ -39,11 +39,22 @@ namespace braids {
 
 using namespace stmlib;
 
+// Scratch for the two-oscillator shapes, shared since voices render one at
+// a time.
+/* static */
+uint8_t MacroOscillator::sync_buffer_[kMaxBlockSize];
+/* static */
+int16_t MacroOscillator::temp_buffer_[kMaxBlockSize];
+
 FLASHMEM void MacroOscillator::Render(
     const uint8_t* sync,
     int16_t* buffer,
     size_t size) {
-  RenderFn fn = fn_table_[shape_];
+  if (shape_ < MACRO_OSC_SHAPE_TRIPLE_RING_MOD) {
+    digital_oscillator_.ReleaseDelayLines();
+  }
+  // Shapes built out with BRAIDS_SHAPE_GROUPS play as CSAW
+  RenderFn fn = shape_enabled(shape_) ? fn_table_[shape_] : &MacroOscillator::RenderCSaw;
   (this->*fn)(sync, buffer, size);
 }
 
@@ -63,6 +74,7 @@ FLASHMEM void MacroOscillator::RenderCSaw(
   }
 }
 
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_ANALOG)
 FLASHMEM void MacroOscillator::RenderMorph(
     const uint8_t* sync,
     int16_t* buffer,
@@ -155,6 +167,9 @@ FLASHMEM void MacroOscillator::RenderSawSquare(
   END_INTERPOLATE_PARAMETER_1
 }
 
+#endif
+
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_DUAL)
 #define SEMI * 128
 
 const int16_t intervals[65] = {
@@ -288,6 +303,9 @@ FLASHMEM void MacroOscillator::RenderDualSync(
   END_INTERPOLATE_PARAMETER_1
 }
 
+#endif
+
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_ANALOG)
 FLASHMEM void MacroOscillator::RenderSineTriangle(
     const uint8_t* sync,
     int16_t* buffer,
@@ -351,6 +369,8 @@ FLASHMEM void MacroOscillator::RenderBuzz(
   }
 }
 
+#endif
+
 FLASHMEM void MacroOscillator::RenderDigital(
     const uint8_t* sync,
     int16_t* buffer,
@@ -362,6 +382,7 @@ FLASHMEM void MacroOscillator::RenderDigital(
   digital_oscillator_.Render(sync, buffer, size);
 }
 
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_DUAL)
 FLASHMEM void MacroOscillator::RenderSawComb(
   const uint8_t* sync,
   int16_t* buffer,
@@ -376,14 +397,20 @@ FLASHMEM void MacroOscillator::RenderSawComb(
   digital_oscillator_.set_shape(OSC_SHAPE_COMB_FILTER);
   digital_oscillator_.Render(sync, buffer, size);
 }
+#endif
 
 /* static */
 MacroOscillator::RenderFn MacroOscillator::fn_table_[] = {
   &MacroOscillator::RenderCSaw,
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_ANALOG)
   &MacroOscillator::RenderMorph,
   &MacroOscillator::RenderSawSquare,
   &MacroOscillator::RenderSineTriangle,
   &MacroOscillator::RenderBuzz,
+#else
+  NULL, NULL, NULL, NULL,
+#endif
+#if BRAIDS_HAS_GROUP(BRAIDS_GROUP_DUAL)
   &MacroOscillator::RenderSub,
   &MacroOscillator::RenderSub,
   &MacroOscillator::RenderDualSync,
@@ -395,6 +422,9 @@ MacroOscillator::RenderFn MacroOscillator::fn_table_[] = {
   &MacroOscillator::RenderDigital,
   &MacroOscillator::RenderDigital,
   &MacroOscillator::RenderSawComb,
+#else
+  NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+#endif
   &MacroOscillator::RenderDigital,
   &MacroOscillator::RenderDigital,
   &MacroOscillator::RenderDigital,
@@ -37,9 +37,12 @@
 #include "digital_oscillator.h"
 #include "resources.h"
 #include "settings.h"
+#include "shape_groups.h"
 
 namespace braids {
 
+static const size_t kMaxBlockSize = 128;
+
 class MacroOscillator {
  public:
   typedef void (MacroOscillator::*RenderFn)(const uint8_t*, int16_t*, size_t);
@@ -81,6 +84,10 @@ class MacroOscillator {
     digital_oscillator_.Strike();
   }
 
+  inline void ReleaseDelayLines() {
+    digital_oscillator_.ReleaseDelayLines();
+  }
+
   void Render(const uint8_t* sync_buffer, int16_t* buffer, size_t size);
 
  private:
@@ -99,8 +106,8 @@ class MacroOscillator {
   int16_t parameter_[2];
   int16_t previous_parameter_[2];
   int16_t pitch_;
-  uint8_t sync_buffer_[24];
-  int16_t temp_buffer_[128];
+  static uint8_t sync_buffer_[kMaxBlockSize];
+  static int16_t temp_buffer_[kMaxBlockSize];
   int32_t lp_state_;
 
   AnalogOscillator analog_oscillator_[3];
@@ -34,6 +34,13 @@
 
 #include "stmlib.h"
 
+// Flash tables each get a section of their own, which the linker drops
+// when no render code reaches the table (with FLASHMEM they all shared one
+// .flashmem section per file and were kept or dropped together). The
+// Teensy 4 linker script places .progmem* in flash. Which tables a set of
+// shape groups keeps is reported by tools/braids_resources.py.
+#define BRAIDS_RESOURCE(name) __attribute__((section(".progmem.braids." #name)))
+
 namespace braids {
 
 typedef uint8_t ResourceId;
@@ -44,7 +51,7 @@ extern const int16_t* lookup_table_signed_table[];
 extern const uint32_t* lookup_table_hr_table[];
 extern const int16_t* waveform_table[];
 extern const int16_t* waveshaper_table[];
-// extern const uint8_t* wt_table[];
+extern const uint8_t* wt_table[];
 // extern const uint16_t* char_table[];
 extern const uint16_t lut_resonator_coefficient[];
 extern const uint16_t lut_resonator_scale[];
@@ -68,28 +75,27 @@ extern const uint32_t lut_env_portamento_increments[];
 extern const int16_t wav_formant_sine[];
 extern const int16_t wav_formant_square[];
 extern const int16_t wav_sine[];
-// extern const int16_t wav_bandlimited_comb_0[];
-// extern const int16_t wav_bandlimited_comb_1[];
-// extern const int16_t wav_bandlimited_comb_2[];
-// extern const int16_t wav_bandlimited_comb_3[];
-// extern const int16_t wav_bandlimited_comb_4[];
-// extern const int16_t wav_bandlimited_comb_5[];
-// extern const int16_t wav_bandlimited_comb_6[];
-// extern const int16_t wav_bandlimited_comb_7[];
-// extern const int16_t wav_bandlimited_comb_8[];
-// extern const int16_t wav_bandlimited_comb_9[];
-// extern const int16_t wav_bandlimited_comb_10[];
-// extern const int16_t wav_bandlimited_comb_11[];
-// extern const int16_t wav_bandlimited_comb_12[];
-// extern const int16_t wav_bandlimited_comb_13[];
-// extern const int16_t wav_bandlimited_comb_14[];
+extern const int16_t wav_bandlimited_comb_0[];
+extern const int16_t wav_bandlimited_comb_1[];
+extern const int16_t wav_bandlimited_comb_2[];
+extern const int16_t wav_bandlimited_comb_3[];
+extern const int16_t wav_bandlimited_comb_4[];
+extern const int16_t wav_bandlimited_comb_5[];
+extern const int16_t wav_bandlimited_comb_6[];
+extern const int16_t wav_bandlimited_comb_7[];
+extern const int16_t wav_bandlimited_comb_8[];
+extern const int16_t wav_bandlimited_comb_9[];
+extern const int16_t wav_bandlimited_comb_10[];
+extern const int16_t wav_bandlimited_comb_11[];
+extern const int16_t wav_bandlimited_comb_12[];
+extern const int16_t wav_bandlimited_comb_13[];
+extern const int16_t wav_bandlimited_comb_14[];
 extern const int16_t ws_moderate_overdrive[];
 extern const int16_t ws_violent_overdrive[];
 extern const int16_t ws_sine_fold[];
 extern const int16_t ws_tri_fold[];
-// extern const uint8_t wt_waves[];
-// extern const uint8_t wt_map[];
-// extern const uint8_t wt_code[];
+extern const uint8_t wt_waves[];
+extern const uint8_t wt_map[];
 extern const uint16_t chr_characters[];
 #define STR_DUMMY 0  // dummy
 #define LUT_RESONATOR_COEFFICIENT 0
@@ -137,35 +143,35 @@ extern const uint16_t chr_characters[];
 #define WAV_SINE 2
 #define WAV_SINE_SIZE 257
 #define WAV_BANDLIMITED_COMB_0 3
-// #define WAV_BANDLIMITED_COMB_0_SIZE 257
-// #define WAV_BANDLIMITED_COMB_1 4
-// #define WAV_BANDLIMITED_COMB_1_SIZE 257
-// #define WAV_BANDLIMITED_COMB_2 5
-// #define WAV_BANDLIMITED_COMB_2_SIZE 257
-// #define WAV_BANDLIMITED_COMB_3 6
-// #define WAV_BANDLIMITED_COMB_3_SIZE 257
-// #define WAV_BANDLIMITED_COMB_4 7
-// #define WAV_BANDLIMITED_COMB_4_SIZE 257
-// #define WAV_BANDLIMITED_COMB_5 8
-// #define WAV_BANDLIMITED_COMB_5_SIZE 257
-// #define WAV_BANDLIMITED_COMB_6 9
-// #define WAV_BANDLIMITED_COMB_6_SIZE 257
-// #define WAV_BANDLIMITED_COMB_7 10
-// #define WAV_BANDLIMITED_COMB_7_SIZE 257
-// #define WAV_BANDLIMITED_COMB_8 11
-// #define WAV_BANDLIMITED_COMB_8_SIZE 257
-// #define WAV_BANDLIMITED_COMB_9 12
-// #define WAV_BANDLIMITED_COMB_9_SIZE 257
-// #define WAV_BANDLIMITED_COMB_10 13
-// #define WAV_BANDLIMITED_COMB_10_SIZE 257
-// #define WAV_BANDLIMITED_COMB_11 14
-// #define WAV_BANDLIMITED_COMB_11_SIZE 257
-// #define WAV_BANDLIMITED_COMB_12 15
-// #define WAV_BANDLIMITED_COMB_12_SIZE 257
-// #define WAV_BANDLIMITED_COMB_13 16
-// #define WAV_BANDLIMITED_COMB_13_SIZE 257
-// #define WAV_BANDLIMITED_COMB_14 17
-// #define WAV_BANDLIMITED_COMB_14_SIZE 257
+#define WAV_BANDLIMITED_COMB_0_SIZE 257
+#define WAV_BANDLIMITED_COMB_1 4
+#define WAV_BANDLIMITED_COMB_1_SIZE 257
+#define WAV_BANDLIMITED_COMB_2 5
+#define WAV_BANDLIMITED_COMB_2_SIZE 257
+#define WAV_BANDLIMITED_COMB_3 6
+#define WAV_BANDLIMITED_COMB_3_SIZE 257
+#define WAV_BANDLIMITED_COMB_4 7
+#define WAV_BANDLIMITED_COMB_4_SIZE 257
+#define WAV_BANDLIMITED_COMB_5 8
+#define WAV_BANDLIMITED_COMB_5_SIZE 257
+#define WAV_BANDLIMITED_COMB_6 9
+#define WAV_BANDLIMITED_COMB_6_SIZE 257
+#define WAV_BANDLIMITED_COMB_7 10
+#define WAV_BANDLIMITED_COMB_7_SIZE 257
+#define WAV_BANDLIMITED_COMB_8 11
+#define WAV_BANDLIMITED_COMB_8_SIZE 257
+#define WAV_BANDLIMITED_COMB_9 12
+#define WAV_BANDLIMITED_COMB_9_SIZE 257
+#define WAV_BANDLIMITED_COMB_10 13
+#define WAV_BANDLIMITED_COMB_10_SIZE 257
+#define WAV_BANDLIMITED_COMB_11 14
+#define WAV_BANDLIMITED_COMB_11_SIZE 257
+#define WAV_BANDLIMITED_COMB_12 15
+#define WAV_BANDLIMITED_COMB_12_SIZE 257
+#define WAV_BANDLIMITED_COMB_13 16
+#define WAV_BANDLIMITED_COMB_13_SIZE 257
+#define WAV_BANDLIMITED_COMB_14 17
+#define WAV_BANDLIMITED_COMB_14_SIZE 257
 // #define WS_MODERATE_OVERDRIVE 0
 // #define WS_MODERATE_OVERDRIVE_SIZE 257
 // #define WS_VIOLENT_OVERDRIVE 1
@@ -174,12 +180,10 @@ extern const uint16_t chr_characters[];
 // #define WS_SINE_FOLD_SIZE 257
 // #define WS_TRI_FOLD 3
 // #define WS_TRI_FOLD_SIZE 257
-// #define WT_WAVES 0
-// #define WT_WAVES_SIZE 33024
-// #define WT_MAP 1
-// #define WT_MAP_SIZE 256
-// #define WT_CODE 2
-// #define WT_CODE_SIZE 1064
+#define WT_WAVES 0
+#define WT_WAVES_SIZE 33024
+#define WT_MAP 1
+#define WT_MAP_SIZE 256
 // #define CHR_CHARACTERS 0
 // #define CHR_CHARACTERS_SIZE 256
 
@@ -104,10 +104,10 @@ namespace braids {
       "KICK",
       "CYMB",
       "SNAR",
-      //    "WTBL",
-      //    "WMAP",
-      //    "WLIN",
-      //    "WTx4",
+          "WTBL",
+          "WMAP",
+          "WLIN",
+          "WTx4",
           "NOIS",
           "TWNQ",
           "CLKN",
@@ -77,10 +77,10 @@ namespace braids {
     MACRO_OSC_SHAPE_CYMBAL,
     MACRO_OSC_SHAPE_SNARE,
 
-    //  MACRO_OSC_SHAPE_WAVETABLES,
-    //  MACRO_OSC_SHAPE_WAVE_MAP,
-    //  MACRO_OSC_SHAPE_WAVE_LINE,
-    //  MACRO_OSC_SHAPE_WAVE_PARAPHONIC,
+    MACRO_OSC_SHAPE_WAVETABLES,
+    MACRO_OSC_SHAPE_WAVE_MAP,
+    MACRO_OSC_SHAPE_WAVE_LINE,
+    MACRO_OSC_SHAPE_WAVE_PARAPHONIC,
 
     MACRO_OSC_SHAPE_FILTERED_NOISE,
     MACRO_OSC_SHAPE_TWIN_PEAKS_NOISE,
@@ -0,0 +1,61 @@
+#ifndef BRAIDS_SHAPE_GROUPS_H_
+#define BRAIDS_SHAPE_GROUPS_H_
+
+#include "settings.h"
+
+// Shape groups built into the firmware. A group left out of
+// BRAIDS_SHAPE_GROUPS has its render code compiled out, and the linker then
+// drops every resource table only that code used (each table has a section
+// of its own, see BRAIDS_RESOURCE in resources.h). Its shapes play as CSAW,
+// which is always built. The groups follow the sections of the shape list;
+// tools/braids_resources.py reports what each one costs in flash and RAM
+// (WAVETABLE is the big one, 33 KB of wave data).
+// The mask is BRAIDS_SHAPE_GROUPS in config.h, which the sketch and every
+// source including this header read alike; -DBRAIDS_SHAPE_GROUPS=... in the
+// build flags overrides it.
+#define BRAIDS_GROUP_ANALOG      0x001   // MORPH, SAW_SQUARE, SINE_TRIANGLE, BUZZ
+#define BRAIDS_GROUP_DUAL        0x002   // SQUARE_SUB to TOY: subs, syncs, triples, swarm, comb
+#define BRAIDS_GROUP_FORMANT     0x004   // digital filters, VOSIM, VOWEL, VOWEL_FOF
+#define BRAIDS_GROUP_HARMONICS   0x008
+#define BRAIDS_GROUP_FM          0x010   // FM, FEEDBACK_FM, CHAOTIC_FEEDBACK_FM
+#define BRAIDS_GROUP_PHYSICAL    0x020   // PLUCKED, BOWED, BLOWN, FLUTED
+#define BRAIDS_GROUP_PERCUSSION  0x040   // STRUCK_BELL, STRUCK_DRUM, KICK, CYMBAL, SNARE
+#define BRAIDS_GROUP_WAVETABLE   0x080   // WAVETABLES, WAVE_MAP, WAVE_LINE, WAVE_PARAPHONIC
+#define BRAIDS_GROUP_NOISE       0x100   // FILTERED_NOISE to PARTICLE_NOISE
+#define BRAIDS_GROUP_MODULATION  0x200   // DIGITAL_MODULATION
+#define BRAIDS_GROUP_ALL         0x3FF
+
+#ifndef BRAIDS_SHAPE_GROUPS
+#include "../config.h"
+#endif
+#ifndef BRAIDS_SHAPE_GROUPS
+#define BRAIDS_SHAPE_GROUPS BRAIDS_GROUP_ALL
+#endif
+
+#define BRAIDS_HAS_GROUP(group) ((BRAIDS_SHAPE_GROUPS & (group)) != 0)
+
+namespace braids {
+
+// Group of a MacroOscillatorShape, 0 for CSAW
+inline uint16_t shape_group(uint8_t shape) {
+  if (shape == MACRO_OSC_SHAPE_CSAW) return 0;
+  if (shape <= MACRO_OSC_SHAPE_BUZZ) return BRAIDS_GROUP_ANALOG;
+  if (shape <= MACRO_OSC_SHAPE_TOY) return BRAIDS_GROUP_DUAL;
+  if (shape <= MACRO_OSC_SHAPE_VOWEL_FOF) return BRAIDS_GROUP_FORMANT;
+  if (shape <= MACRO_OSC_SHAPE_HARMONICS) return BRAIDS_GROUP_HARMONICS;
+  if (shape <= MACRO_OSC_SHAPE_CHAOTIC_FEEDBACK_FM) return BRAIDS_GROUP_FM;
+  if (shape <= MACRO_OSC_SHAPE_FLUTED) return BRAIDS_GROUP_PHYSICAL;
+  if (shape <= MACRO_OSC_SHAPE_SNARE) return BRAIDS_GROUP_PERCUSSION;
+  if (shape <= MACRO_OSC_SHAPE_WAVE_PARAPHONIC) return BRAIDS_GROUP_WAVETABLE;
+  if (shape <= MACRO_OSC_SHAPE_PARTICLE_NOISE) return BRAIDS_GROUP_NOISE;
+  return BRAIDS_GROUP_MODULATION;
+}
+
+inline bool shape_enabled(uint8_t shape) {
+  uint16_t group = shape_group(shape);
+  return group == 0 || (BRAIDS_SHAPE_GROUPS & group);
+}
+
+}  // namespace braids
+
+#endif  // BRAIDS_SHAPE_GROUPS_H_
@@ -2,35 +2,314 @@
 #include "synth_braids.h"
 #include "utility/dspinst.h"
 
+#if BRAIDS_STACK_MAX > 8
+#error "BRAIDS_STACK_MAX is limited to 8 (one gate bit per voice)"
+#endif
+#if (BRAIDS_SUB_BLOCK & 1) || BRAIDS_SUB_BLOCK < 2
+#error "BRAIDS_SUB_BLOCK must be even: some shapes render two samples per step"
+#endif
+
+// Sync input of a voice that isn't synced. Render() only reads it.
+static const uint8_t noSync[AUDIO_BLOCK_SAMPLES] = { 0 };
+
+// Same table lookup as AnalogOscillator::ComputePhaseIncrement()
+static uint32_t phaseIncrement(int32_t pitch)
+{
+	const int32_t highestNote = 128 * 128;
+	const int32_t octave = 12 * 128;
+	if (pitch >= highestNote) pitch = highestNote - 1;
+	if (pitch < 0) pitch = 0;
+
+	int32_t ref = pitch - highestNote;
+	size_t shifts = 0;
+	while (ref < 0) {
+		ref += octave;
+		++shifts;
+	}
+	uint32_t a = lut_oscillator_increments[ref >> 4];
+	uint32_t b = lut_oscillator_increments[(ref >> 4) + 1];
+	return (a + (static_cast<int32_t>(b - a) * (ref & 0xf) >> 4)) >> shifts;
+}
+
+
+void AudioSynthBraids::render(int16_t* out, const audio_block_t* pitchMod,
+	const audio_block_t* timbreMod, const audio_block_t* colorMod)
+{
+	uint32_t now = ARM_DWT_CYCCNT;
+	uint32_t blockStart = lastRender;
+	lastRender = now;
+
+	__disable_irq();
+	uint8_t pending = dirty;
+	dirty = 0;
+	pitchTo = pitch;
+	timbreTo = timbre;
+	colorTo = color;
+	__enable_irq();
+
+	if (pending & DIRTY_SHAPE) osc.set_shape(static_cast<MacroOscillatorShape>(shape));
+	if (pending & DIRTY_STRIKE) {
+		// A new note starts on its pitch instead of gliding there
+		pitchFrom = pitchTo;
+		osc.Strike();
+	}
+
+	// Sub-blocks while the settings move or an input modulates them, and
+	// one more block after the modulation stops to land on the settings
+	bool modulating = (pitchMod && pitchModDepth) || (timbreMod && timbreModDepth) ||
+		(colorMod && colorModDepth);
+	bool stepping = modulating || modulated || (pending & (DIRTY_PARAMETERS | DIRTY_PITCH));
+	modulated = modulating;
+	renderPitch = pitchTo;
+
+	// The master's sync pulses, if it has rendered since this voice last did
+	const uint8_t* syncIn = noSync;
+	AudioSynthBraids* master = syncSource;
+	if (master) {
+		if (master->syncBlocks != syncSeen) syncIn = master->syncOut;
+		syncSeen = master->syncBlocks;
+	}
+
+	// Hits queued since the last block start where they fall in time, one
+	// block on. Offsets are even: some shapes render two samples per step.
+	float cyclesPerSample = F_CPU_ACTUAL / AUDIO_SAMPLE_RATE_EXACT;
+	size_t from = 0;
+	while (from < AUDIO_BLOCK_SAMPLES) {
+		size_t to = AUDIO_BLOCK_SAMPLES;
+		if (hitTail != hitHead) {
+			__sync_synchronize();
+			const Hit& h = hits[hitTail & (BRAIDS_HIT_QUEUE - 1)];
+			// Queued just before the block start (update() got in between
+			// stamping and publishing), or while the voice was asleep and
+			// stamped no block start: play it straight away
+			int32_t since = (int32_t)(h.queued - blockStart);
+			uint32_t at = since > 0 ? (uint32_t)(since / cyclesPerSample) : 0;
+			if (at >= 2 * AUDIO_BLOCK_SAMPLES) at = 0;
+			if (at > AUDIO_BLOCK_SAMPLES - 2) at = AUDIO_BLOCK_SAMPLES - 2;
+			at &= ~1u;
+			if (at <= from) {
+				startHit(h);
+				hitTail = hitTail + 1;
+				continue;
+			}
+			to = at;
+		}
+		renderSpan(out, syncIn, from, to, pitchMod, timbreMod, colorMod, stepping);
+		from = to;
+	}
+
+	pitchFrom = pitchTo;
+	timbreFrom = timbreTo;
+	colorFrom = colorTo;
+	if (syncSlaves) syncBlocks = syncBlocks + 1;
+}
+
+void AudioSynthBraids::renderSpan(int16_t* out, const uint8_t* syncIn, size_t from, size_t to,
+	const audio_block_t* pitchMod, const audio_block_t* timbreMod, const audio_block_t* colorMod,
+	bool stepping)
+{
+	if (percussive && hitGain == 0) {
+		memset(out + from, 0, (to - from) * sizeof(int16_t));
+		if (syncSlaves) memset(syncOut + from, 0, to - from);
+		return;
+	}
+
+	for (size_t i = from; i < to; ) {
+		size_t end = to;
+		if (stepping) {
+			// Each sub-block aims at where the ramp and the inputs are at
+			// its last sample; the oscillator interpolates across it
+			size_t stepEnd = (i / BRAIDS_SUB_BLOCK + 1) * BRAIDS_SUB_BLOCK;
+			if (stepEnd > AUDIO_BLOCK_SAMPLES) stepEnd = AUDIO_BLOCK_SAMPLES;
+			if (stepEnd < end) end = stepEnd;
+			size_t last = stepEnd - 1;
+			renderPitch = modulate(ramp(pitchFrom, pitchTo, stepEnd), pitchMod, pitchModDepth, last, 32767);
+			osc.set_pitch(renderPitch);
+			osc.set_parameters(
+				modulate(ramp(timbreFrom, timbreTo, stepEnd), timbreMod, timbreModDepth, last, 32767),
+				modulate(ramp(colorFrom, colorTo, stepEnd), colorMod, colorModDepth, last, 32767));
+		}
+		osc.Render(syncIn + i, out + i, end - i);
+		if (syncSlaves) trackSync(i, end);
+		i = end;
+	}
+
+	if (percussive) {
+		// Exponential hit envelope, cut off at -60 dB
+		int32_t gain = hitGain;
+		for (size_t i = from; i < to; i++) {
+			out[i] = (int16_t)(((int64_t)out[i] * gain) >> 31);
+			gain = (int32_t)(((int64_t)gain * hitDecay) >> 31);
+			if (gain < (int32_t)(2147483647 / 1000)) {
+				gain = 0;
+				memset(out + i + 1, 0, (to - i - 1) * sizeof(int16_t));
+				break;
+			}
+		}
+		hitGain = gain;
+	}
+}
+
+// Sync pulses for the voices slaved to this one: a phase accumulator at the
+// pitch being rendered marks each cycle start with its position within the
+// sample, the format AnalogOscillator reads (fraction of a sample * 128 + 1)
+void AudioSynthBraids::trackSync(size_t from, size_t to)
+{
+	uint32_t increment = phaseIncrement(renderPitch);
+	uint32_t step = (increment >> 7) | 1;
+	uint32_t phase = syncPhase;
+	for (size_t i = from; i < to; i++) {
+		phase += increment;
+		syncOut[i] = phase < increment ? phase / step + 1 : 0;
+	}
+	syncPhase = phase;
+}
+
+void AudioSynthBraids::set_braids_sync(AudioSynthBraids* master)
+{
+	if (master == this) master = NULL;
+	__disable_irq();
+	if (syncSource) syncSource->syncSlaves--;
+	syncSource = master;
+	if (master) {
+		master->syncSlaves++;
+		syncSeen = master->syncBlocks;
+	}
+	__enable_irq();
+}
+
+void AudioSynthBraids::startHit(const Hit& h)
+{
+	shape = h.shape;
+	timbre = h.timbre;
+	color = h.color;
+	pitch = h.pitch;
+	pitchFrom = pitchTo = renderPitch = h.pitch;
+	timbreFrom = timbreTo = h.timbre;
+	colorFrom = colorTo = h.color;
+	osc.set_shape(static_cast<MacroOscillatorShape>(h.shape));
+	osc.set_parameters(h.timbre, h.color);
+	osc.set_pitch(h.pitch);
+	osc.Strike();
+	hitGain = h.gain;
+	hitDecay = h.decay;
+	percussive = true;
+}
+
+bool AudioSynthBraids::hit(int16_t pitchbraids, int16_t shapebraids, int16_t timbrebraids,
+	int16_t colorbraids, float level, float decayMs)
+{
+	uint8_t head = hitHead;
+	if ((uint8_t)(head - hitTail) >= BRAIDS_HIT_QUEUE) return false;
+
+	Hit& h = hits[head & (BRAIDS_HIT_QUEUE - 1)];
+	h.pitch = pitchbraids;
+	h.shape = shapebraids;
+	h.timbre = timbrebraids;
+	h.color = colorbraids;
+	h.gain = q31(level);
+	// -60 dB (ln 1000) after decayMs
+	float samples = max(decayMs, 1.0f) * (AUDIO_SAMPLE_RATE_EXACT / 1000.0f);
+	h.decay = q31(expf(-6.9078f / samples));
+	h.queued = ARM_DWT_CYCCNT;
+
+	// Publish the entry before moving the head; render() only reads up to it
+	__sync_synchronize();
+	hitHead = head + 1;
+	return true;
+}
 
 void AudioSynthBraids::update(void)
 {
-	audio_block_t *block;
-	uint32_t i, scale;
-	int32_t val1, val2;
-	const uint8_t sync_buffer[AUDIO_BLOCK_SAMPLES] = { 0 };
-	uint8_t buffer_index = 0;
+	audio_block_t *pitchMod = receiveReadOnly(0);
+	audio_block_t *timbreMod = receiveReadOnly(1);
+	audio_block_t *colorMod = receiveReadOnly(2);
+
+	if (percussive && !isPlaying()) {
+		// Between hits send nothing, which reads as silence; the block
+		// start is still stamped for the next hit's offset
+		lastRender = ARM_DWT_CYCCNT;
+	} else {
+		audio_block_t *block = allocate();
+		if (block) {
+			render(block->data, pitchMod, timbreMod, colorMod);
+			transmit(block, 0);
+			release(block);
+		}
+	}
+
+	if (pitchMod) release(pitchMod);
+	if (timbreMod) release(timbreMod);
+	if (colorMod) release(colorMod);
+}
+
+
+void AudioSynthBraidsStack::begin(AudioSynthBraids* voiceArray, uint8_t n)
+{
+	if (n > BRAIDS_STACK_MAX) n = BRAIDS_STACK_MAX;
+	__disable_irq();
+	for (uint8_t v = 0; v < n; v++) {
+		voices[v] = &voiceArray[v];
+		gain[v] = 0;
+	}
+	count = n;
+	gates = 0;
+	mixGain = (int32_t)(32767.0f / sqrtf(n > 0 ? n : 1));
+	__enable_irq();
+}
+
+void AudioSynthBraidsStack::update(void)
+{
+	audio_block_t *pitchMod = receiveReadOnly(0);
+	audio_block_t *timbreMod = receiveReadOnly(1);
+	audio_block_t *colorMod = receiveReadOnly(2);
 
-		block = allocate();
+	uint8_t g = gates;
+	int32_t sum[AUDIO_BLOCK_SAMPLES];
+	int16_t voiceOut[AUDIO_BLOCK_SAMPLES];
+	bool any = false;
+
+	for (uint8_t v = 0; v < count; v++) {
+		// The mix gain is folded into each voice's gain
+		int32_t target = (g & (1 << v)) ? mixGain : 0;
+		int32_t from = gain[v];
+		if (from == 0 && target == 0) {
+			// Not rendered until gated again, so its slab can go to another voice
+			voices[v]->releaseDelayLines();
+			continue;
+		}
+
+		voices[v]->render(voiceOut, pitchMod, timbreMod, colorMod);
+
+		if (!any) memset(sum, 0, sizeof(sum));
+		if (from == target) {
+			for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+				sum[i] += (voiceOut[i] * target) >> 15;
+			}
+		} else {
+			// Linear fade from the last block's gain, ending on the target
+			int32_t delta = target - from;
+			for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+				int32_t gv = from + delta * (i + 1) / AUDIO_BLOCK_SAMPLES;
+				sum[i] += (voiceOut[i] * gv) >> 15;
+			}
+			gain[v] = target;
+		}
+		any = true;
+	}
+
+	if (any) {
+		audio_block_t *block = allocate();
 		if (block) {
-			osc.Render(sync_buffer, buffer, AUDIO_BLOCK_SAMPLES);
-			for (i=0; i < AUDIO_BLOCK_SAMPLES; i++) {
-        val1 = buffer[buffer_index];
-        if(buffer_index+1 > AUDIO_BLOCK_SAMPLES){
-          val2 = 0;
-        }else{
-          val2 = buffer[buffer_index+1];
-        }
-			
-				scale = (buffer_index >>16) & 0x7FFF;
-				val2 *= scale;
-				val1 *= 0x10000 - scale;
-				block->data[i] = multiply_32x32_rshift32(val1+val2, magnitude);
-				buffer_index++;
+			for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+				block->data[i] = saturate16(sum[i]);
 			}
-			
 			transmit(block, 0);
 			release(block);
-			return;
 		}
+	}
+
+	if (pitchMod) release(pitchMod);
+	if (timbreMod) release(timbreMod);
+	if (colorMod) release(colorMod);
 }
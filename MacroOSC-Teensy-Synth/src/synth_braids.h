@@ -7,37 +7,118 @@
 
 using namespace braids;
 
+// Inputs (all optional): 0 = pitch, 1 = timbre, 2 = color modulation.
+//
+// While an input modulates the oscillator, or pitch, timbre or color have
+// changed since the last block, the block is rendered in sub-blocks of
+// BRAIDS_SUB_BLOCK samples (16 = 2.8 kHz, near the 4 kHz control rate of
+// the Braids firmware; 24 is the firmware's own block). Each sub-block
+// takes the inputs at its last sample and its share of a ramp from the
+// last block's settings to the new ones, and the oscillator interpolates
+// across it. Otherwise the whole block is rendered in one go.
+//
+// Smaller sub-blocks follow the inputs more closely for more calls per
+// block. Render time of a stepped block against the whole block at once,
+// over all shapes on the host (tools/sub_block_cost.py; median, worst shape
+// in brackets, which moves by tens of percent from run to run):
+//   8: +50% (+260%)   16: +25% (+115%)   24: +18% (+100%)
+//   32: +13% (+65%)   64: +5% (+20%)     128: +0%
+// The light shapes pay the most, their per-call setup being a larger share
+// of the work. A voice only pays it in blocks that step. Must be even.
+//
+// BRAIDS_SUB_BLOCK, BRAIDS_HIT_QUEUE and BRAIDS_STACK_MAX are set here and
+// not in config.h: src/*.cpp don't include config.h, and the last two size
+// the classes below, so the sketch and synth_braids.cpp must see the same
+// values. Setting one before this header is an error.
+#if defined(BRAIDS_SUB_BLOCK) || defined(BRAIDS_HIT_QUEUE) || defined(BRAIDS_STACK_MAX)
+#error "BRAIDS_SUB_BLOCK, BRAIDS_HIT_QUEUE and BRAIDS_STACK_MAX are set in src/synth_braids.h"
+#endif
+
+#define BRAIDS_SUB_BLOCK 16
+
+// One-shot hits waiting for the next update(), per voice (power of two)
+#define BRAIDS_HIT_QUEUE 4
+
 class AudioSynthBraids: public AudioStream
 {
 public:
-        AudioSynthBraids(): AudioStream(0, NULL), kAudioBlockSize(AUDIO_BLOCK_SAMPLES), magnitude(65536.0) { }
+        AudioSynthBraids(): AudioStream(3, inputQueueArray), kAudioBlockSize(AUDIO_BLOCK_SAMPLES) { }
         ~AudioSynthBraids() { }
 
-        void set_braids_shape(int16_t shape) {
-
-          // Sets the shape
-          MacroOscillatorShape osc_shape = static_cast<MacroOscillatorShape>(shape);
-          osc.set_shape(osc_shape);
-      	}
+        // The setters only record what changed; update() hands it to the
+        // oscillator at the start of the next block. Nothing here strikes
+        // except noteOn(), so control-rate updates of pitch, timbre and color
+        // leave plucked and struck shapes ringing.
+        void set_braids_shape(int16_t shapebraids) {
+          setParameter(shape, shapebraids, DIRTY_SHAPE);
+        }
 
         void set_braids_color(int16_t colorbraids) {
-      		color = colorbraids;
-          osc.set_parameters(timbre,color);
-      	}
+          setParameter(color, colorbraids, DIRTY_PARAMETERS);
+        }
 
         void set_braids_timbre(int16_t timbrebraids) {
-      		timbre = timbrebraids;
-          osc.set_parameters(timbre,color);
-      	}
+          setParameter(timbre, timbrebraids, DIRTY_PARAMETERS);
+        }
 
         void set_braids_pitch(int16_t pitchbraids) {
+          setParameter(pitch, pitchbraids, DIRTY_PITCH);
+        }
+
+        // Modulation depths: a full scale input moves the pitch by this many
+        // semitones, timbre and color by this share of their range.
+        void set_braids_pitch_mod(float semitones) {
+          pitchModDepth = (int32_t)(semitones * 128.0f);
+        }
+
+        void set_braids_timbre_mod(float depth) {
+          timbreModDepth = (int32_t)(constrain(depth, -1.0f, 1.0f) * 32767.0f);
+        }
+
+        void set_braids_color_mod(float depth) {
+          colorModDepth = (int32_t)(constrain(depth, -1.0f, 1.0f) * 32767.0f);
+        }
+
+        // New note: set the pitch and excite the oscillator once
+        void noteOn(int16_t pitchbraids) {
+          __disable_irq();
           pitch = pitchbraids;
-          if(pre_pitch!=pitch){
-    					osc.set_pitch(pitch);
-    					pre_pitch = pitch;
-    			}
-      		osc.Strike();
-      	}
+          dirty |= DIRTY_PITCH | DIRTY_STRIKE;
+          __enable_irq();
+        }
+
+        // Drum hit: shape, timbre, color and pitch for this hit only, a
+        // start level (0-1) and the time to decay to -60 dB. The hit goes
+        // into a lock-free queue and update() starts it at the sample that
+        // matches when it was queued, one block later, so hits keep their
+        // spacing instead of snapping to block boundaries. A voice that has
+        // taken a hit stays percussive: it renders nothing between hits and
+        // isPlaying() drops once the decay has run out, and update() sends
+        // no block until the next hit. Returns false if the queue is full.
+        bool hit(int16_t pitchbraids, int16_t shapebraids, int16_t timbrebraids,
+                 int16_t colorbraids, float level, float decayMs);
+        bool isPlaying() const { return hitGain != 0 || hitHead != hitTail; }
+
+        // Give the oscillator's delay line slab (COMB, PLUK, BOWD, BLOW, FLUT)
+        // back to the pool, for a voice that has stopped rendering. Only from
+        // the audio update or with audio interrupts off, as the pool isn't
+        // locked.
+        void releaseDelayLines() { osc.ReleaseDelayLines(); }
+
+        // Current level of the hit envelope, 0-1
+        float hitLevel() const { return hitGain * (1.0f / 2147483648.0f); }
+
+        // Percussive from the start, so the voice is silent until its first hit
+        void set_braids_percussive() { percussive = true; }
+
+        // Hard sync: restart this voice's waveform at every cycle of the
+        // master's pitch (NULL = free running). The master has to update
+        // before this voice, so it must come earlier in the sketch or the
+        // stack; without a fresh block from it this voice runs free. Only
+        // shapes with a sync input follow it: the analog ones, VOSIM, the
+        // FM, digital filter, harmonics and wavetable shapes among others;
+        // the physical models, drums and noises ignore it.
+        void set_braids_sync(AudioSynthBraids* master);
 
     const char* get_name(uint8_t n)
        {
@@ -50,23 +131,173 @@ public:
             osc.set_shape(MACRO_OSC_SHAPE_CSAW);
             osc.set_parameters(0, 0);
 
+            shape = MACRO_OSC_SHAPE_CSAW;
+            timbre = 0;
+            color = 0;
             pitch = 32 << 7;
+            dirty = DIRTY_PITCH;
+
+            pitchFrom = pitchTo = renderPitch = pitch;
+            timbreFrom = timbreTo = 0;
+            colorFrom = colorTo = 0;
+            modulated = false;
+
+            hitHead = hitTail = 0;
+            hitGain = 0;
+            percussive = false;
+            lastRender = ARM_DWT_CYCCNT;
+
+            syncSource = NULL;
+            syncSlaves = 0;
+            syncBlocks = syncSeen = 0;
+            syncPhase = 0;
         }
         virtual void update(void);
 
+        // Apply the pending settings and render one block into out, with
+        // any of the modulation blocks (NULL = none). update() calls this
+        // for a patched voice; AudioSynthBraidsStack calls it for the
+        // voices it sums, which are left unpatched.
+        void render(int16_t* out, const audio_block_t* pitchMod,
+                    const audio_block_t* timbreMod, const audio_block_t* colorMod);
+
 private:
+        enum {
+          DIRTY_SHAPE = 1,
+          DIRTY_PARAMETERS = 2,
+          DIRTY_PITCH = 4,
+          DIRTY_STRIKE = 8
+        };
+
+        void setParameter(volatile int16_t& value, int16_t newValue, uint8_t flag) {
+          if (value == newValue) return;
+          __disable_irq();
+          value = newValue;
+          dirty |= flag;
+          __enable_irq();
+        }
+
+        struct Hit {
+          int16_t pitch;
+          int16_t shape;
+          int16_t timbre;
+          int16_t color;
+          int32_t gain;                     // Q31 start level
+          int32_t decay;                    // Q31 per-sample multiplier
+          uint32_t queued;                  // ARM_DWT_CYCCNT when queued
+        };
+
+        void renderSpan(int16_t* out, const uint8_t* syncIn, size_t from, size_t to,
+                        const audio_block_t* pitchMod, const audio_block_t* timbreMod,
+                        const audio_block_t* colorMod, bool stepping);
+        void trackSync(size_t from, size_t to);
+        void startHit(const Hit& h);
+
+        // Value of a ramp across the block after n samples
+        static int32_t ramp(int32_t from, int32_t to, size_t n) {
+          return from + (to - from) * (int32_t)n / AUDIO_BLOCK_SAMPLES;
+        }
+
+        // 1.0 itself does not fit in Q31
+        static int32_t q31(float x) {
+          return x >= 1.0f ? 0x7FFFFFFF : (x <= 0.0f ? 0 : (int32_t)(x * 2147483648.0f));
+        }
+
+        static int16_t modulate(int32_t base, const audio_block_t* mod, int32_t depth, size_t index, int32_t max) {
+          if (mod && depth) {
+            base += (mod->data[index] * depth) >> 15;
+            if (base < 0) base = 0;
+            if (base > max) base = max;
+          }
+          return base;
+        }
+
+        audio_block_t *inputQueueArray[3];
         MacroOscillator osc;
 
         const uint16_t kAudioBlockSize;
         // Globals that define the parameters of the oscillator
-        volatile int16_t pitch,pre_pitch;
+        volatile int16_t pitch;
         volatile int16_t timbre;
         volatile int16_t color;
-        volatile int16_t shapebraids;
+        volatile int16_t shape;
+        volatile uint8_t dirty;
+
+        volatile int32_t pitchModDepth;     // pitch units (128 per semitone) at full scale
+        volatile int32_t timbreModDepth;
+        volatile int32_t colorModDepth;
+        bool modulated;                     // last block was rendered with modulation
+        int16_t pitchFrom, timbreFrom, colorFrom;   // settings the last block ended on
+        int16_t pitchTo, timbreTo, colorTo;         // settings this block ramps to
+        int16_t renderPitch;                // pitch of the sub-block being rendered
+
+        Hit hits[BRAIDS_HIT_QUEUE];
+        volatile uint8_t hitHead;           // written by hit()
+        volatile uint8_t hitTail;           // written by render()
+        uint32_t lastRender;                // ARM_DWT_CYCCNT at the start of the last block
+        volatile int32_t hitGain;           // Q31 hit envelope
+        int32_t hitDecay;
+        bool percussive;                    // has taken a hit, silent between hits
+
+        AudioSynthBraids* syncSource;       // master this voice is synced to
+        volatile uint8_t syncSlaves;        // voices synced to this one
+        volatile uint8_t syncBlocks;        // blocks rendered with syncOut filled
+        uint8_t syncSeen;                   // the master's syncBlocks at our last render
+        uint32_t syncPhase;
+        uint8_t syncOut[AUDIO_BLOCK_SAMPLES];   // cycle starts of this voice, for its slaves
+};
+
+// Voice modes of the MacroOSC synth (BRAIDS_VOICE_MODE in config.h)
+#define BRAIDS_VOICE_POLY        0   // one oscillator, envelope and filter per note
+#define BRAIDS_VOICE_PARAPHONIC  1   // one oscillator per note, one shared envelope and filter
+#define BRAIDS_VOICE_UNISON      2   // all oscillators on one note, detuned
+#define BRAIDS_VOICE_DRUMS       3   // one-shot hits, shape and tuning per note (DrumKit.h)
 
-      	int16_t buffer[AUDIO_BLOCK_SAMPLES] = { 0 };
+#define BRAIDS_STACK_MAX 8
+
+// Sums up to BRAIDS_STACK_MAX AudioSynthBraids into one output, so they
+// share a single envelope and filter. The voices must not be patched
+// themselves: the stack renders them, passing on its own three modulation
+// inputs, and only while they are gated or fading. A gated voice fades in
+// over one block and fades out over one block when the gate drops, so
+// notes leaving a held chord do not click. The sum is scaled by
+// 1/sqrt(voices) and saturated.
+class AudioSynthBraidsStack: public AudioStream
+{
+public:
+        AudioSynthBraidsStack(): AudioStream(3, inputQueueArray), count(0), gates(0), mixGain(32767) {
+          for (int v = 0; v < BRAIDS_STACK_MAX; v++) {
+            voices[v] = NULL;
+            gain[v] = 0;
+          }
+        }
+
+        void begin(AudioSynthBraids* voiceArray, uint8_t n);
+
+        void gateOn(uint8_t v) {
+          if (v < count) setGates(gates | (1 << v));
+        }
+        void gateOff(uint8_t v) {
+          if (v < count) setGates(gates & ~(1 << v));
+        }
+        void allOff() { setGates(0); }
+        bool isGated(uint8_t v) const { return gates & (1 << v); }
+
+        virtual void update(void);
+
+private:
+        void setGates(uint8_t g) {
+          __disable_irq();
+          gates = g;
+          __enable_irq();
+        }
 
-        volatile int32_t magnitude;
+        audio_block_t *inputQueueArray[3];
+        AudioSynthBraids* voices[BRAIDS_STACK_MAX];
+        uint8_t count;
+        volatile uint8_t gates;             // one bit per voice
+        int32_t gain[BRAIDS_STACK_MAX];     // Q15, where the last block's fade ended
+        int32_t mixGain;                    // Q15
 };
 
 #endif
@@ -0,0 +1,181 @@
+#!/usr/bin/python3
+
+# Braids resource audit: which tables of src/resources.cpp each shape group
+# keeps in the firmware, and what leaving a group out of BRAIDS_SHAPE_GROUPS
+# (src/shape_groups.h) saves in flash and RAM.
+#
+# The oscillator sources are compiled on the host once per group mask with
+# -ffunction-sections -fdata-sections and linked against a driver that only
+# calls MacroOscillator::Render, with --gc-sections, as the Teensy build
+# links. The tables still in the executable are the ones that mask keeps.
+# Table sizes come from resources.cpp itself, so they are the target's sizes
+# (pointers counted as 4 bytes); code size is not reported, as host code
+# says little about the Cortex-M7's.
+#
+# Usage: braids_resources.py [-mMASK] [-cCXX]
+#   -mMASK   also list the tables kept by one BRAIDS_SHAPE_GROUPS mask
+#   -cCXX    host C++ compiler (default g++)
+
+import sys
+import os
+import os.path
+import re
+import shutil
+import subprocess
+import tempfile
+
+GROUPS = [
+    ('ANALOG', 0x001),
+    ('DUAL', 0x002),
+    ('FORMANT', 0x004),
+    ('HARMONICS', 0x008),
+    ('FM', 0x010),
+    ('PHYSICAL', 0x020),
+    ('PERCUSSION', 0x040),
+    ('WAVETABLE', 0x080),
+    ('NOISE', 0x100),
+    ('MODULATION', 0x200),
+]
+ALL = 0x3FF
+
+SIZES = {'char': 1, 'int8_t': 1, 'uint8_t': 1, 'int16_t': 2, 'uint16_t': 2,
+         'int32_t': 4, 'uint32_t': 4}
+
+SOURCES = ['macro_oscillator', 'digital_oscillator', 'analog_oscillator',
+           'resources', 'random']
+
+ARDUINO_STUB = '''#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#define FLASHMEM
+#define PROGMEM
+#define DMAMEM
+#define constrain(a, l, h) ((a) < (l) ? (l) : ((a) > (h) ? (h) : (a)))
+'''
+
+DRIVER = '''#include "macro_oscillator.h"
+using namespace braids;
+int main(int argc, char** argv) {
+  static MacroOscillator osc;
+  static uint8_t sync[24];
+  static int16_t buffer[24];
+  osc.Init();
+  osc.set_shape((MacroOscillatorShape)(argc % MACRO_OSC_SHAPE_LAST));
+  osc.Render(sync, buffer, 24);
+  return buffer[argc % 24];
+}
+'''
+
+TABLE_RE = re.compile(
+    r'^[ \t]*(BRAIDS_RESOURCE\(\w+\) |FLASHMEM )?const (\w+)(\*?) (\w+)\[\] = \{(.*?)\};',
+    re.M | re.S)
+
+
+def parse_tables(path):
+    # name -> (bytes, 'flash' or 'ram', contents)
+    tables = {}
+    with open(path) as f:
+        text = f.read()
+    for m in TABLE_RE.finditer(text):
+        marker, ctype, pointer, name, body = m.groups()
+        body = re.sub(r'//.*', '', body)
+        entries = [e.strip() for e in body.split(',') if e.strip()]
+        size = len(entries) * (4 if pointer else SIZES[ctype])
+        tables[name] = (size, 'flash' if marker else 'ram', ctype + pointer + ':' + ','.join(entries))
+    return tables
+
+
+def link(cxx, src, work, mask):
+    out = os.path.join(work, 'mask_%03x' % mask)
+    objs = []
+    for name in SOURCES + ['driver']:
+        source = os.path.join(work if name == 'driver' else src, name + '.cpp')
+        obj = os.path.join(work, '%s_%03x.o' % (name, mask))
+        subprocess.check_call([cxx, '-Os', '-std=c++11', '-w', '-ffunction-sections',
+                               '-fdata-sections', '-DBRAIDS_SHAPE_GROUPS=%d' % mask,
+                               '-I' + work, '-I' + src, '-c', source, '-o', obj])
+        objs.append(obj)
+    subprocess.check_call([cxx, '-Wl,--gc-sections', '-o', out] + objs)
+    symbols = subprocess.check_output(['nm', '-C', '--defined-only', out]).decode()
+    return set(line.split('::')[-1] for line in symbols.splitlines() if 'braids::' in line)
+
+
+def total(tables, names, where):
+    return sum(tables[n][0] for n in names if tables[n][1] == where)
+
+
+def main():
+    mask = None
+    cxx = 'g++'
+    for arg in sys.argv[1:]:
+        if arg.startswith('-m'):
+            mask = int(arg[2:], 0) & ALL
+        elif arg.startswith('-c'):
+            cxx = arg[2:]
+        else:
+            print('usage: braids_resources.py [-mMASK] [-cCXX]')
+            return 1
+
+    src = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'src')
+    tables = parse_tables(os.path.join(src, 'resources.cpp'))
+
+    work = tempfile.mkdtemp(prefix='braids_resources')
+    try:
+        with open(os.path.join(work, 'Arduino.h'), 'w') as f:
+            f.write(ARDUINO_STUB)
+        with open(os.path.join(work, 'driver.cpp'), 'w') as f:
+            f.write(DRIVER)
+
+        def kept(m):
+            return link(cxx, src, work, m) & set(tables)
+
+        base = kept(0)
+        full = kept(ALL)
+        print('%d tables, %d bytes flash, %d bytes RAM' % (
+            len(tables), total(tables, tables, 'flash'), total(tables, tables, 'ram')))
+        print('CSAW only (mask 0x000): %d bytes flash, %d bytes RAM' % (
+            total(tables, base, 'flash'), total(tables, base, 'ram')))
+        print('All groups (mask 0x%03x): %d bytes flash, %d bytes RAM' % (
+            ALL, total(tables, full, 'flash'), total(tables, full, 'ram')))
+        print('')
+
+        print('%-11s %6s %12s %10s  tables' % ('group', 'mask', 'saves flash', 'saves RAM'))
+        for name, bit in GROUPS:
+            without = kept(ALL & ~bit)
+            saved = full - without
+            touched = sorted(kept(bit) - base)
+            print('%-11s 0x%03x %12d %10d  %s' % (
+                name, bit, total(tables, saved, 'flash'), total(tables, saved, 'ram'),
+                ' '.join(touched) if touched else '-'))
+        print('')
+
+        never = sorted(set(tables) - full)
+        print('Never linked: %d bytes flash, %d bytes RAM' % (
+            total(tables, never, 'flash'), total(tables, never, 'ram')))
+        for n in never:
+            print('  %-32s %6d %s' % (n, tables[n][0], tables[n][1]))
+        print('')
+
+        contents = {}
+        for n in sorted(tables):
+            contents.setdefault(tables[n][2], []).append(n)
+        duplicates = [names for names in contents.values() if len(names) > 1]
+        print('Duplicate tables: %s' % (
+            '; '.join(' = '.join(names) for names in duplicates) if duplicates else 'none'))
+
+        if mask is not None:
+            names = sorted(kept(mask))
+            print('')
+            print('Mask 0x%03x keeps %d bytes flash, %d bytes RAM:' % (
+                mask, total(tables, names, 'flash'), total(tables, names, 'ram')))
+            for n in names:
+                print('  %-32s %6d %s' % (n, tables[n][0], tables[n][1]))
+    finally:
+        shutil.rmtree(work)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,181 @@
+#!/usr/bin/python3
+
+# Host check of the shared delay line pool (BRAIDS_DELAY_LINE_SLABS).
+#
+# The oscillator sources of the commit that added the pool (the one adding
+# union DelayLines, or -rREV) are built from git alongside those of its
+# parent, when every DigitalOscillator held its own delay lines. Both render
+# 200 blocks of each shape below, with timbre, color and pitch moving and a
+# strike every 50 blocks, and the output is hashed; the hashes must match.
+# Later fixes change BOWD and FLUT, so the tree itself isn't compared.
+#
+# The tree's sources then play PLUK on one voice more than there are slabs:
+# the last voice must be silent, and must sound once another voice has
+# given its slab back.
+#
+# Usage: delay_line_check.py [-rREV] [-cCXX]
+#   -rREV    commit to compare against its parent
+#   -cCXX    host C++ compiler (default g++)
+
+import sys
+import os
+import os.path
+import shutil
+import subprocess
+import tempfile
+
+SOURCES = ['macro_oscillator', 'digital_oscillator', 'analog_oscillator',
+           'resources', 'random']
+
+ARDUINO_STUB = '''#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#define FLASHMEM
+#define PROGMEM
+#define DMAMEM
+#define constrain(a, l, h) ((a) < (l) ? (l) : ((a) > (h) ? (h) : (a)))
+'''
+
+# Prints "shape hash" lines, then (POOL_CHECK) the result of the pool check
+DRIVER = '''#include <stdio.h>
+#include "macro_oscillator.h"
+using namespace braids;
+
+static uint8_t sync[128];
+static int16_t buffer[128];
+
+static bool silent() {
+  for (int i = 0; i < 128; i++) {
+    if (buffer[i]) return false;
+  }
+  return true;
+}
+
+int main() {
+  static MacroOscillator osc;
+  const MacroOscillatorShape shapes[] = {
+    MACRO_OSC_SHAPE_CSAW, MACRO_OSC_SHAPE_SAW_COMB, MACRO_OSC_SHAPE_PLUCKED,
+    MACRO_OSC_SHAPE_BOWED, MACRO_OSC_SHAPE_BLOWN, MACRO_OSC_SHAPE_FLUTED
+  };
+  const char* names[] = { "CSAW", "SAWC", "PLUK", "BOWD", "BLOW", "FLUT" };
+  for (int s = 0; s < 6; s++) {
+    osc.Init();
+    osc.set_shape(shapes[s]);
+    uint32_t hash = 2166136261u;
+    for (int b = 0; b < 200; b++) {
+      if (b % 50 == 0) osc.Strike();
+      osc.set_pitch((40 + (b / 25) * 3) << 7);
+      osc.set_parameters((b * 977) & 32767, (b * 531 + 8000) & 32767);
+      osc.Render(sync, buffer, 128);
+      for (int i = 0; i < 128; i++) {
+        hash = (hash ^ (uint16_t)buffer[i]) * 16777619u;
+      }
+    }
+    printf("%s %08x\\n", names[s], hash);
+  }
+
+#ifdef POOL_CHECK
+  osc.ReleaseDelayLines();
+  static MacroOscillator voices[BRAIDS_DELAY_LINE_SLABS + 1];
+  const int last = BRAIDS_DELAY_LINE_SLABS;
+  bool ok = true;
+  for (int v = 0; v <= last; v++) {
+    voices[v].Init();
+    voices[v].set_shape(MACRO_OSC_SHAPE_PLUCKED);
+    voices[v].set_pitch(60 << 7);
+    voices[v].set_parameters(16000, 16000);
+    voices[v].Strike();
+  }
+  for (int b = 0; b < 4; b++) {
+    for (int v = 0; v <= last; v++) {
+      voices[v].Render(sync, buffer, 128);
+      if (silent() != (v == last)) ok = false;
+    }
+  }
+  // A voice gone to sleep hands its slab on
+  voices[0].ReleaseDelayLines();
+  voices[last].Strike();
+  voices[last].Render(sync, buffer, 128);
+  if (silent()) ok = false;
+  voices[0].Render(sync, buffer, 128);
+  if (!silent()) ok = false;
+  printf("pool %s\\n", ok ? "ok" : "FAILED");
+#endif
+  return 0;
+}
+'''
+
+
+def build(cxx, src, work, name, defines):
+    objs = []
+    for source_name in SOURCES + ['driver']:
+        source = os.path.join(work if source_name == 'driver' else src, source_name + '.cpp')
+        obj = os.path.join(work, name + '_' + source_name + '.o')
+        subprocess.check_call([cxx, '-O2', '-std=c++11', '-w', '-I' + work, '-I' + src] +
+                              defines + ['-c', source, '-o', obj])
+        objs.append(obj)
+    exe = os.path.join(work, name + '_check')
+    subprocess.check_call([cxx, '-o', exe] + objs)
+    return subprocess.check_output([exe]).decode().splitlines()
+
+
+# Sources of a revision, unpacked from git; returns their directory
+def unpack(root, rev, work, name):
+    directory = os.path.join(work, name + '_src')
+    os.mkdir(directory)
+    archive = subprocess.check_output(['git', 'archive', rev, 'src'], cwd=root)
+    subprocess.run(['tar', '-x', '-C', directory], input=archive, check=True)
+    return os.path.join(directory, 'src')
+
+
+def main():
+    cxx = 'g++'
+    rev = None
+    for arg in sys.argv[1:]:
+        if arg.startswith('-c'):
+            cxx = arg[2:]
+        elif arg.startswith('-r'):
+            rev = arg[2:]
+        else:
+            print('usage: delay_line_check.py [-rREV] [-cCXX]')
+            return 1
+
+    root = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+    src = os.path.join(root, 'src')
+    if rev is None:
+        added = subprocess.check_output(
+            ['git', 'log', '--format=%H', '-S', 'union DelayLines', '--',
+             'src/digital_oscillator.h'], cwd=root).decode().split()
+        rev = added[-1]
+
+    work = tempfile.mkdtemp(prefix='delay_line_check')
+    try:
+        with open(os.path.join(work, 'Arduino.h'), 'w') as f:
+            f.write(ARDUINO_STUB)
+        with open(os.path.join(work, 'driver.cpp'), 'w') as f:
+            f.write(DRIVER)
+        pooled = build(cxx, unpack(root, rev, work, 'pooled'), work, 'pooled', [])
+        before = build(cxx, unpack(root, rev + '^', work, 'before'), work, 'before', [])
+        tree = build(cxx, src, work, 'tree', ['-DPOOL_CHECK'])
+    finally:
+        shutil.rmtree(work)
+
+    failures = 0
+    for line_pooled, line_before in zip(pooled, before):
+        name, hash_pooled = line_pooled.split()
+        hash_before = line_before.split()[1]
+        same = hash_pooled == hash_before
+        print('%-5s pooled %s, before %s: %s' % (
+            name, hash_pooled, hash_before, 'same' if same else 'DIFFERENT'))
+        if not same:
+            failures += 1
+    print(tree[-1])
+    if not tree[-1].endswith(' ok'):
+        failures += 1
+    return 1 if failures else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
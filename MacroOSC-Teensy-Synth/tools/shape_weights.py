@@ -0,0 +1,150 @@
+#!/usr/bin/python3
+
+# Generates the shapeWeight[] table of ShapeCost.cpp: the cost of rendering
+# a block of each Braids shape relative to CSAW (= 100), worst of MIDI notes
+# 36, 60 and 84 with timbre and color at mid scale, as ShapeCost::measure()
+# times it on the board.
+#
+# The oscillator sources are compiled on the host and timed RUNS times; the
+# median weight of each shape is printed as the C initializer. Rerun it when
+# a shape's render code changes, and compare with the board's numbers
+# (USE_SHAPE_BENCHMARK prints them at boot).
+#
+# Usage: shape_weights.py [-rRUNS] [-cCXX]
+#   -rRUNS   timing runs to take the median of (default 5)
+#   -cCXX    host C++ compiler (default g++)
+
+import sys
+import os
+import os.path
+import shutil
+import subprocess
+import tempfile
+
+# Short names in shape order, as in the table comments
+NAMES = [
+    'CSAW', 'MORPH', 'SAW_SQR', 'FOLD', 'BUZZ', 'SQR_SUB', 'SAW_SUB', 'SQR_SYN',
+    'SAW_SYN', 'SAWx3', 'SQRx3', 'TRIx3', 'SINx3', 'RING', 'SWARM', 'SAW_CMB',
+    'TOY', 'ZLPF', 'ZPKF', 'ZBPF', 'ZHPF', 'VOSM', 'VOWL', 'VFOF',
+    'HARM', 'FM', 'FBFM', 'WTFM', 'PLUK', 'BOWD', 'BLOW', 'FLUT',
+    'BELL', 'DRUM', 'KICK', 'CYMB', 'SNAR', 'WTBL', 'WMAP', 'WLIN',
+    'WTx4', 'NOIS', 'TWNQ', 'CLKN', 'CLOU', 'PRTC', 'QPSK',
+]
+
+SOURCES = ['macro_oscillator', 'digital_oscillator', 'analog_oscillator',
+           'resources', 'random']
+
+ARDUINO_STUB = '''#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#define FLASHMEM
+#define PROGMEM
+#define DMAMEM
+#define constrain(a, l, h) ((a) < (l) ? (l) : ((a) > (h) ? (h) : (a)))
+'''
+
+# Same settings and block counts as ShapeCost::measure(), best of 25
+# repeats per pitch to keep host noise out; prints "shape ns" lines
+DRIVER = '''#include <stdio.h>
+#include <time.h>
+#include "macro_oscillator.h"
+using namespace braids;
+static double now() {
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e9 + t.tv_nsec;
+}
+int main() {
+  static MacroOscillator osc;
+  static uint8_t sync[128];
+  static int16_t buffer[128];
+  const int16_t pitches[] = { 36 << 7, 60 << 7, 84 << 7 };
+  for (int shape = 0; shape < MACRO_OSC_SHAPE_LAST; shape++) {
+    double worst = 0;
+    for (int p = 0; p < 3; p++) {
+      double best = 1e18;
+      for (int r = 0; r < 25; r++) {
+        osc.Init();
+        osc.set_shape((MacroOscillatorShape)shape);
+        osc.set_pitch(pitches[p]);
+        osc.set_parameters(16384, 16384);
+        osc.Strike();
+        for (int b = 0; b < 4; b++) osc.Render(sync, buffer, 128);
+        double start = now();
+        for (int b = 0; b < 16; b++) osc.Render(sync, buffer, 128);
+        double ns = (now() - start) / 16;
+        if (ns < best) best = ns;
+      }
+      if (best > worst) worst = best;
+    }
+    printf("%d %f\\n", shape, worst);
+  }
+  return 0;
+}
+'''
+
+
+def build(cxx, src, work):
+    objs = []
+    for name in SOURCES + ['driver']:
+        source = os.path.join(work if name == 'driver' else src, name + '.cpp')
+        obj = os.path.join(work, name + '.o')
+        subprocess.check_call([cxx, '-O2', '-std=c++11', '-w', '-I' + work, '-I' + src,
+                               '-c', source, '-o', obj])
+        objs.append(obj)
+    exe = os.path.join(work, 'shape_weights')
+    subprocess.check_call([cxx, '-o', exe] + objs)
+    return exe
+
+
+def weights(exe):
+    ns = {}
+    for line in subprocess.check_output([exe]).decode().splitlines():
+        shape, t = line.split()
+        ns[int(shape)] = float(t)
+    return [int(ns[s] * 100 / ns[0] + 0.5) for s in sorted(ns)]
+
+
+def main():
+    runs = 5
+    cxx = 'g++'
+    for arg in sys.argv[1:]:
+        if arg.startswith('-r'):
+            runs = max(1, int(arg[2:]))
+        elif arg.startswith('-c'):
+            cxx = arg[2:]
+        else:
+            print('usage: shape_weights.py [-rRUNS] [-cCXX]')
+            return 1
+
+    src = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'src')
+    work = tempfile.mkdtemp(prefix='shape_weights')
+    try:
+        with open(os.path.join(work, 'Arduino.h'), 'w') as f:
+            f.write(ARDUINO_STUB)
+        with open(os.path.join(work, 'driver.cpp'), 'w') as f:
+            f.write(DRIVER)
+        exe = build(cxx, src, work)
+        results = [weights(exe) for _ in range(runs)]
+    finally:
+        shutil.rmtree(work)
+
+    if len(results[0]) != len(NAMES):
+        print('%d shapes, but %d names: update NAMES' % (len(results[0]), len(NAMES)))
+        return 1
+    median = [sorted(r[s] for r in results)[runs // 2] for s in range(len(NAMES))]
+
+    print('static const uint16_t shapeWeight[MACRO_OSC_SHAPE_LAST] = {')
+    for row in range(0, len(NAMES), 8):
+        values = median[row:row + 8]
+        last = row + 8 >= len(NAMES)
+        text = ', '.join('%3d' % v for v in values) + ('' if last else ',')
+        print('  %-42s// %s' % (text, ' '.join(NAMES[row:row + 8])))
+    print('};')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
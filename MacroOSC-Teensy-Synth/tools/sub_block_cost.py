@@ -0,0 +1,138 @@
+#!/usr/bin/python3
+
+# Host timing behind the sub-block cost table in src/synth_braids.h: what a
+# block rendered in sub-blocks of BRAIDS_SUB_BLOCK samples costs against the
+# same block rendered in one go, for every shape.
+#
+# The oscillator sources are built once, with a driver that renders each
+# shape the way AudioSynthBraids does: a stepped block sets pitch, timbre
+# and color before every sub-block, a whole block sets them once. Each
+# figure is the best of several runs, so a busy host skews it less; the
+# Cortex-M7's figures will differ, the shape of the table less so.
+#
+# Usage: sub_block_cost.py [-sSIZES] [-cCXX]
+#   -sSIZES  comma separated sub-block sizes (default 8,16,24,32,64,128)
+#   -cCXX    host C++ compiler (default g++)
+
+import sys
+import os
+import os.path
+import shutil
+import subprocess
+import tempfile
+
+SOURCES = ['macro_oscillator', 'digital_oscillator', 'analog_oscillator',
+           'resources', 'random']
+
+ARDUINO_STUB = '''#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#define FLASHMEM
+#define PROGMEM
+#define DMAMEM
+#define constrain(a, l, h) ((a) < (l) ? (l) : ((a) > (h) ? (h) : (a)))
+'''
+
+# Prints "shape size ns" lines, one per shape and sub-block size
+DRIVER = '''#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include "macro_oscillator.h"
+using namespace braids;
+
+static MacroOscillator osc;
+static uint8_t sync[128];
+static int16_t buffer[128];
+
+static double nsPerBlock(int shape, int size) {
+  const int blocks = 1000;
+  double best = 1e18;
+  for (int r = 0; r < 7; r++) {
+    osc.Init();
+    osc.set_shape((MacroOscillatorShape)shape);
+    auto start = std::chrono::steady_clock::now();
+    for (int b = 0; b < blocks; b++) {
+      for (int i = 0; i < 128; i += size) {
+        int16_t step = (int16_t)((b * 128 + i) & 4095);
+        osc.set_pitch((48 << 7) + (step >> 4));
+        osc.set_parameters(8000 + step, 16000 - step);
+        osc.Render(sync, buffer + i, i + size < 128 ? size : 128 - i);
+      }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / blocks;
+    if (ns < best) best = ns;
+  }
+  return best;
+}
+
+int main(int argc, char** argv) {
+  for (int shape = 0; shape < MACRO_OSC_SHAPE_LAST; shape++) {
+    for (int a = 1; a < argc; a++) {
+      int size = atoi(argv[a]);
+      printf("%d %d %.0f\\n", shape, size, nsPerBlock(shape, size));
+    }
+  }
+  return 0;
+}
+'''
+
+
+def median(values):
+    values = sorted(values)
+    n = len(values)
+    return values[n // 2] if n & 1 else (values[n // 2 - 1] + values[n // 2]) / 2.0
+
+
+def main():
+    cxx = 'g++'
+    sizes = [8, 16, 24, 32, 64, 128]
+    for arg in sys.argv[1:]:
+        if arg.startswith('-c'):
+            cxx = arg[2:]
+        elif arg.startswith('-s'):
+            sizes = [int(s) for s in arg[2:].split(',')]
+        else:
+            print('usage: sub_block_cost.py [-sSIZES] [-cCXX]')
+            return 1
+    if 128 not in sizes:
+        sizes.append(128)
+
+    src = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'src')
+    work = tempfile.mkdtemp(prefix='sub_block_cost')
+    try:
+        with open(os.path.join(work, 'Arduino.h'), 'w') as f:
+            f.write(ARDUINO_STUB)
+        with open(os.path.join(work, 'driver.cpp'), 'w') as f:
+            f.write(DRIVER)
+        objs = []
+        for name in SOURCES + ['driver']:
+            source = os.path.join(work if name == 'driver' else src, name + '.cpp')
+            obj = os.path.join(work, name + '.o')
+            subprocess.check_call([cxx, '-O2', '-std=c++11', '-w', '-I' + work, '-I' + src,
+                                   '-c', source, '-o', obj])
+            objs.append(obj)
+        exe = os.path.join(work, 'sub_block_cost')
+        subprocess.check_call([cxx, '-o', exe] + objs)
+        output = subprocess.check_output([exe] + [str(s) for s in sizes]).decode()
+    finally:
+        shutil.rmtree(work)
+
+    times = {}
+    for line in output.splitlines():
+        shape, size, ns = line.split()
+        times[(int(shape), int(size))] = float(ns)
+    shapes = sorted(set(shape for shape, size in times))
+
+    print('sub-block  median  worst shape')
+    for size in sizes:
+        extra = [100.0 * (times[(shape, size)] / times[(shape, 128)] - 1.0) for shape in shapes]
+        worst = max(range(len(shapes)), key=lambda s: extra[s])
+        print('%9d  %+5.0f%%  %+5.0f%% (shape %d)' % (size, median(extra), extra[worst], shapes[worst]))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
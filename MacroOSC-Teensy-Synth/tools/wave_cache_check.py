@@ -0,0 +1,138 @@
+#!/usr/bin/python3
+
+# Host check of the wavetable frame cache (DigitalOscillator::CachedWave).
+#
+# The oscillator sources are compiled twice: as they are, and with
+# BRAIDS_WAVE_CACHE_BYPASS, which reads every frame straight from flash.
+# Both builds render 600 blocks of each wavetable shape with timbre, color
+# and pitch moving, and the output of each shape is hashed; the hashes must
+# match. The cached build also asks for a fifth frame while the four slots
+# are in use, which must come back from flash rather than evict a slot.
+#
+# Usage: wave_cache_check.py [-cCXX]
+#   -cCXX    host C++ compiler (default g++)
+
+import sys
+import os
+import os.path
+import shutil
+import subprocess
+import tempfile
+
+SOURCES = ['macro_oscillator', 'digital_oscillator', 'analog_oscillator',
+           'resources', 'random']
+
+ARDUINO_STUB = '''#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#define FLASHMEM
+#define PROGMEM
+#define DMAMEM
+#define constrain(a, l, h) ((a) < (l) ? (l) : ((a) > (h) ? (h) : (a)))
+'''
+
+# Prints "shape hash" lines, then the result of the fifth-frame check
+DRIVER = '''#include <stdio.h>
+#define private public
+#include "macro_oscillator.h"
+#undef private
+using namespace braids;
+int main() {
+  static MacroOscillator osc;
+  static uint8_t sync[128];
+  static int16_t buffer[128];
+  const MacroOscillatorShape shapes[] = {
+    MACRO_OSC_SHAPE_WAVETABLES, MACRO_OSC_SHAPE_WAVE_MAP,
+    MACRO_OSC_SHAPE_WAVE_LINE, MACRO_OSC_SHAPE_WAVE_PARAPHONIC
+  };
+  const char* names[] = { "WTBL", "WMAP", "WLIN", "WTx4" };
+  for (int s = 0; s < 4; s++) {
+    osc.Init();
+    osc.set_shape(shapes[s]);
+    uint32_t hash = 2166136261u;
+    for (int b = 0; b < 600; b++) {
+      osc.set_pitch((36 + (b / 50) * 4) << 7);
+      osc.set_parameters((b * 977) & 32767, (b * 531 + 8000) & 32767);
+      osc.Render(sync, buffer, 128);
+      for (int i = 0; i < 128; i++) {
+        hash = (hash ^ (uint16_t)buffer[i]) * 16777619u;
+      }
+    }
+    printf("%s %08x\\n", names[s], hash);
+  }
+
+  static DigitalOscillator digital;
+  digital.Init();
+  digital.wave_cache_used_ = 0;
+  const uint8_t* frames[5];
+  bool ok = true;
+  for (int i = 0; i < 5; i++) {
+    frames[i] = digital.CachedWave(i * 7);
+    if (memcmp(frames[i], wt_waves + i * 7 * kWaveFrameSize, kWaveFrameSize)) ok = false;
+  }
+  // The fifth comes from flash, and the four cached frames are untouched
+  if (frames[4] != wt_waves + 4 * 7 * kWaveFrameSize) ok = false;
+  for (int i = 0; i < 4; i++) {
+    if (memcmp(frames[i], wt_waves + i * 7 * kWaveFrameSize, kWaveFrameSize)) ok = false;
+  }
+  printf("fifth frame %s\\n", ok ? "ok" : "FAILED");
+  return 0;
+}
+'''
+
+
+def build(cxx, src, work, defines):
+    objs = []
+    for name in SOURCES + ['driver']:
+        source = os.path.join(work if name == 'driver' else src, name + '.cpp')
+        obj = os.path.join(work, name + '.o')
+        subprocess.check_call([cxx, '-O2', '-std=c++11', '-w', '-I' + work, '-I' + src] +
+                              defines + ['-c', source, '-o', obj])
+        objs.append(obj)
+    exe = os.path.join(work, 'wave_cache_check')
+    subprocess.check_call([cxx, '-o', exe] + objs)
+    return subprocess.check_output([exe]).decode().splitlines()
+
+
+def main():
+    cxx = 'g++'
+    for arg in sys.argv[1:]:
+        if arg.startswith('-c'):
+            cxx = arg[2:]
+        else:
+            print('usage: wave_cache_check.py [-cCXX]')
+            return 1
+
+    src = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'src')
+    work = tempfile.mkdtemp(prefix='wave_cache_check')
+    try:
+        with open(os.path.join(work, 'Arduino.h'), 'w') as f:
+            f.write(ARDUINO_STUB)
+        with open(os.path.join(work, 'driver.cpp'), 'w') as f:
+            f.write(DRIVER)
+        cached = build(cxx, src, work, [])
+        direct = build(cxx, src, work, ['-DBRAIDS_WAVE_CACHE_BYPASS'])
+    finally:
+        shutil.rmtree(work)
+
+    failures = 0
+    for line_cached, line_direct in zip(cached, direct):
+        if line_cached.startswith('fifth frame'):
+            print(line_cached)
+            if not line_cached.endswith(' ok'):
+                failures += 1
+            continue
+        name, hash_cached = line_cached.split()
+        hash_direct = line_direct.split()[1]
+        same = hash_cached == hash_direct
+        print('%-5s cached %s, from flash %s: %s' % (
+            name, hash_cached, hash_direct, 'same' if same else 'DIFFERENT'))
+        if not same:
+            failures += 1
+    return 1 if failures else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
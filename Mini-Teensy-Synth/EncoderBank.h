@@ -0,0 +1,174 @@
+#ifndef EncoderBank_h_
+#define EncoderBank_h_
+
+// ============================================================================
+// Shared panel encoder bank - Multi-Teensy Synth Collection
+// ============================================================================
+// Header-only, deployed into each project by Shared/deploy_config.sh.
+//
+// Decodes every panel encoder from its own pin-change interrupt and marks it
+// in a dirty bitmap, so the loop only visits encoders that actually moved
+// instead of reading all of them every pass. Positions count quadrature steps
+// exactly like the Encoder library (4 steps per detent, same direction), so
+// existing detent maths keeps working. Slots with ENCODER_NO_PIN are skipped
+// (e.g. the menu encoder slot, which stays on the Encoder library).
+
+#include <Arduino.h>
+
+#define ENCODER_NO_PIN 0xFF
+
+// Acceleration curve: detents arriving faster than these intervals are multiplied
+#ifndef ENCODER_ACCEL_SLOW_MS
+#define ENCODER_ACCEL_SLOW_MS 40   // x2 below this
+#endif
+#ifndef ENCODER_ACCEL_FAST_MS
+#define ENCODER_ACCEL_FAST_MS 15   // x4 below this
+#endif
+
+struct EncoderPins {
+  uint8_t clk;
+  uint8_t dt;
+};
+
+template <uint8_t N>
+class EncoderBank {
+public:
+  EncoderBank() : dirty(0), accelerate(false) {}
+
+  // Configure the pins and attach one CHANGE interrupt per pin
+  void begin(const EncoderPins *pins) {
+    instance = this;
+    for (uint8_t i = 0; i < N; i++) {
+      position[i] = 0;
+      consumed[i] = 0;
+      lastMove[i] = 0;
+      present[i] = pins[i].clk != ENCODER_NO_PIN && pins[i].dt != ENCODER_NO_PIN;
+      if (!present[i]) continue;
+
+      pinMode(pins[i].clk, INPUT_PULLUP);
+      pinMode(pins[i].dt, INPUT_PULLUP);
+      clkReg[i] = portInputRegister(pins[i].clk);
+      clkMask[i] = digitalPinToBitMask(pins[i].clk);
+      dtReg[i] = portInputRegister(pins[i].dt);
+      dtMask[i] = digitalPinToBitMask(pins[i].dt);
+      delayMicroseconds(2000); // let the pullups settle before sampling the start state
+      state[i] = pinState(i);
+
+      attachInterrupt(digitalPinToInterrupt(pins[i].clk), isrFor(i), CHANGE);
+      attachInterrupt(digitalPinToInterrupt(pins[i].dt), isrFor(i), CHANGE);
+    }
+  }
+
+  void setAcceleration(bool enabled) { accelerate = enabled; }
+
+  // Fetch and clear the set of encoders that moved since the last call
+  uint32_t takeDirty() {
+    noInterrupts();
+    uint32_t moved = dirty;
+    dirty = 0;
+    interrupts();
+    return moved;
+  }
+
+  // Absolute position in detents
+  long read(uint8_t i) const {
+    noInterrupts();
+    long steps = position[i];
+    interrupts();
+    return steps / 4;
+  }
+
+  // Detents turned since the last call, scaled by the acceleration curve
+  int change(uint8_t i) {
+    long detents = read(i);
+    long delta = detents - consumed[i];
+    if (delta == 0) return 0; // moved less than a detent
+    consumed[i] = detents;
+
+    if (accelerate) {
+      unsigned long now = millis();
+      unsigned long interval = now - lastMove[i];
+      lastMove[i] = now;
+      if (interval < ENCODER_ACCEL_FAST_MS) delta *= 4;
+      else if (interval < ENCODER_ACCEL_SLOW_MS) delta *= 2;
+    }
+    return (int)delta;
+  }
+
+  // Move one encoder to a detent position without reporting it as a change
+  void write(uint8_t i, long detents) {
+    noInterrupts();
+    position[i] = detents * 4;
+    dirty &= ~(1UL << i);
+    interrupts();
+    consumed[i] = detents;
+  }
+
+  // Move every encoder at once, e.g. after a preset load
+  void sync(const long *detents) {
+    noInterrupts();
+    for (uint8_t i = 0; i < N; i++) {
+      if (present[i]) position[i] = detents[i] * 4;
+    }
+    dirty = 0;
+    interrupts();
+    for (uint8_t i = 0; i < N; i++) {
+      if (present[i]) consumed[i] = detents[i];
+    }
+  }
+
+  bool exists(uint8_t i) const { return present[i]; }
+  uint8_t size() const { return N; }
+
+private:
+  uint8_t pinState(uint8_t i) const {
+    return ((*clkReg[i] & clkMask[i]) ? 1 : 0) | ((*dtReg[i] & dtMask[i]) ? 2 : 0);
+  }
+
+  // Same state machine as the Encoder library: old pins in bits 0-1, new in 2-3
+  void update(uint8_t i) {
+    static const int8_t stepTable[16] = { 0, 1, -1, 2, -1, 0, -2, 1, 1, -2, 0, -1, 2, -1, 1, 0 };
+    uint8_t now = pinState(i);
+    int8_t step = stepTable[state[i] | (now << 2)];
+    state[i] = now;
+    if (step) {
+      position[i] += step;
+      dirty |= 1UL << i;
+    }
+  }
+
+  template <uint8_t I>
+  static void isr() { if (I < N) instance->update(I); }
+
+  static void (*isrFor(uint8_t i))() {
+    static void (*const table[32])() = {
+      isr<0>,  isr<1>,  isr<2>,  isr<3>,  isr<4>,  isr<5>,  isr<6>,  isr<7>,
+      isr<8>,  isr<9>,  isr<10>, isr<11>, isr<12>, isr<13>, isr<14>, isr<15>,
+      isr<16>, isr<17>, isr<18>, isr<19>, isr<20>, isr<21>, isr<22>, isr<23>,
+      isr<24>, isr<25>, isr<26>, isr<27>, isr<28>, isr<29>, isr<30>, isr<31>
+    };
+    return table[i];
+  }
+
+  static_assert(N <= 32, "EncoderBank tracks at most 32 encoders in its dirty bitmap");
+
+  static EncoderBank *instance;
+
+  volatile uint32_t *clkReg[N];
+  volatile uint32_t *dtReg[N];
+  uint32_t clkMask[N];
+  uint32_t dtMask[N];
+  uint8_t state[N];
+  bool present[N];
+
+  volatile long position[N];     // quadrature steps, written from the ISRs
+  volatile uint32_t dirty;
+  long consumed[N];              // detents already reported by change()
+  unsigned long lastMove[N];
+  bool accelerate;
+};
+
+template <uint8_t N>
+EncoderBank<N> *EncoderBank<N>::instance = NULL;
+
+#endif // EncoderBank_h_
@@ -8,6 +8,7 @@
 #include <Arduino.h>
 #include <String.h>
 #include <Encoder.h>
+#include "EncoderBank.h"
 
 #ifdef USE_LCD_DISPLAY
   #include <LiquidCrystal_I2C.h>
@@ -54,7 +55,7 @@ const char* settingsMenuItems[] = {"Macro Knobs", "MIDI Channel", "< Back"};
 extern long encoderValues[];
 extern long lastEncoderValues[];
 extern Encoder menuEncoder;
-extern Encoder enc1, enc2, enc3, enc4, enc5, enc6, enc7, enc8, enc9, enc10, enc11, enc13, enc14, enc15, enc16, enc17, enc18, enc19, enc20;
+extern EncoderBank<20> encoderBank;
 extern void updateSynthParameter(int paramIndex, float val);
 extern int getWaveformIndex(float val, int osc);
 extern int getRangeIndex(float val);
@@ -903,38 +904,20 @@ void updateEncoderParameter(int paramIndex, int change) {
 }
 
 void resetEncoderBaselines() {
+  long positions[20];
   for (int i = 0; i < 20; i++) {
+    positions[i] = encoderBank.read(i); // unmapped encoders keep their position
     int paramIndex = encoderMapping[i]; // Use configurable mapping
     
     // Only reset encoders that are mapped to valid parameters
     if (paramIndex != -1 && paramIndex >= 0 && paramIndex < NUM_PARAMETERS) {
       long targetEncoderValue = (long)(allParameterValues[paramIndex] * 100);
-      switch(i) {
-        case 0: enc1.write(targetEncoderValue * 4); break;
-        case 1: enc2.write(targetEncoderValue * 4); break;
-        case 2: enc3.write(targetEncoderValue * 4); break;
-        case 3: enc4.write(targetEncoderValue * 4); break;
-        case 4: enc5.write(targetEncoderValue * 4); break;
-        case 5: enc6.write(targetEncoderValue * 4); break;
-        case 6: enc7.write(targetEncoderValue * 4); break;
-        case 7: enc8.write(targetEncoderValue * 4); break;
-        case 8: enc9.write(targetEncoderValue * 4); break;
-        case 9: enc10.write(targetEncoderValue * 4); break;
-        case 10: enc11.write(targetEncoderValue * 4); break;
-        case 11: /* menuEncoder handled by MenuNavigation.cpp */ break;
-        case 12: enc13.write(targetEncoderValue * 4); break;
-        case 13: enc14.write(targetEncoderValue * 4); break;
-        case 14: enc15.write(targetEncoderValue * 4); break;
-        case 15: enc16.write(targetEncoderValue * 4); break;
-        case 16: enc17.write(targetEncoderValue * 4); break;
-        case 17: enc18.write(targetEncoderValue * 4); break;
-        case 18: enc19.write(targetEncoderValue * 4); break;
-        case 19: enc20.write(targetEncoderValue * 4); break;
-      }
+      positions[i] = targetEncoderValue;
       encoderValues[i] = targetEncoderValue;
       lastEncoderValues[i] = targetEncoderValue;
     }
   }
+  encoderBank.sync(positions);
 }
 
 void printCurrentPresetValues() {
@@ -0,0 +1,201 @@
+#ifndef VOICE_FILTER_H
+#define VOICE_FILTER_H
+
+#include <Arduino.h>
+#include <AudioStream.h>
+
+// ============================================================================
+// Voice Filter
+// ============================================================================
+// Fixed-point state variable lowpass with its filter envelope built in, used
+// by Mini and MacroOSC when USE_SVF_VOICE_FILTER is set. It replaces the
+// AudioFilterLadder of each voice together with the AudioSynthWaveformDc ->
+// AudioEffectEnvelope pair driving its control input: one graph object per
+// voice instead of three, and integer maths per sample instead of the
+// ladder's float stages.
+//
+// The filter is the trapezoidal (zero-delay feedback) SVF, which stays
+// stable and in tune up to Nyquist without oversampling. Coefficients are
+// worked out in float once per VOICE_FILTER_STEP samples, the samples run
+// through it in Q31 with 8 bits of headroom. It is 12 dB/oct against the
+// ladder's 24, and resonance stops just short of self-oscillation.
+//
+// The control calls match the ladder's (frequency, resonance 0-1.8,
+// octaveControl) and FilterEnvelope takes the same calls as
+// AudioEffectEnvelope, so the note handling is unchanged.
+
+#ifndef VOICE_FILTER_STEP
+#define VOICE_FILTER_STEP 16       // samples per envelope/cutoff update (2.8 kHz)
+#endif
+
+// Linear ADSR stepped by the filter at control rate. Times are in ms as
+// for AudioEffectEnvelope: decay runs from full level to the sustain level,
+// release from wherever the envelope is down to zero.
+class FilterEnvelope {
+public:
+  FilterEnvelope() : state(IDLE), level(0.0f), attackInc(1.0f), decayMs(0.0f),
+                     sustainLevel(1.0f), decayInc(1.0f), releaseMs(0.0f), releaseInc(1.0f) {}
+
+  void attack(float ms) { attackInc = 1.0f / steps(ms); }
+  void decay(float ms) {
+    decayMs = ms;
+    decayInc = (1.0f - sustainLevel) / steps(decayMs);
+  }
+  void sustain(float level) {
+    sustainLevel = constrain(level, 0.0f, 1.0f);
+    decayInc = (1.0f - sustainLevel) / steps(decayMs);
+  }
+  void release(float ms) { releaseMs = ms; }
+
+  // A retrigger attacks from the current level rather than from zero
+  void noteOn() {
+    __disable_irq();
+    state = ATTACK;
+    __enable_irq();
+  }
+  void noteOff() {
+    __disable_irq();
+    if (state != IDLE) {
+      releaseInc = level / steps(releaseMs);
+      state = RELEASE;
+    }
+    __enable_irq();
+  }
+
+  bool isActive() const { return state != IDLE; }
+  bool isSustain() const { return state == SUSTAIN; }
+
+  // Level for the next VOICE_FILTER_STEP samples (audio interrupt)
+  float next() {
+    switch (state) {
+      case ATTACK:
+        level += attackInc;
+        if (level >= 1.0f) {
+          level = 1.0f;
+          state = DECAY;
+        }
+        break;
+      case DECAY:
+        level -= decayInc;
+        if (level <= sustainLevel) {
+          level = sustainLevel;
+          state = SUSTAIN;
+        }
+        break;
+      case SUSTAIN:
+        level = sustainLevel;
+        break;
+      case RELEASE:
+        level -= releaseInc;
+        if (level <= 0.0f) {
+          level = 0.0f;
+          state = IDLE;
+        }
+        break;
+      default:
+        break;
+    }
+    return level;
+  }
+
+private:
+  enum State { IDLE, ATTACK, DECAY, SUSTAIN, RELEASE };
+
+  static float steps(float ms) {
+    float n = ms * (AUDIO_SAMPLE_RATE_EXACT / 1000.0f) / VOICE_FILTER_STEP;
+    return n < 1.0f ? 1.0f : n;
+  }
+
+  volatile uint8_t state;
+  float level;
+  float attackInc;
+  float decayMs;
+  float sustainLevel;
+  float decayInc;
+  float releaseMs;
+  float releaseInc;
+};
+
+class AudioFilterVoiceSvf : public AudioStream {
+public:
+  AudioFilterVoiceSvf() : AudioStream(1, inputQueueArray), env(NULL), cutoff(1000.0f),
+                          octaves(3.0f), depth(0.0f), k(1.414f), lastHz(-1.0f),
+                          a1(0), a2(0), a3(0), ic1(0), ic2(0) {}
+
+  void frequency(float hz) { cutoff = constrain(hz, 1.0f, AUDIO_SAMPLE_RATE_EXACT * 0.49f); }
+
+  // Same range as AudioFilterLadder::resonance(); 1.8 and up is the peak
+  void resonance(float res) {
+    float r = constrain(res, 0.0f, 1.8f) / 1.8f;
+    k = 1.414f - 1.38f * r;      // Butterworth at 0, Q of about 30 at the top
+    lastHz = -1.0f;
+  }
+
+  // Octaves of sweep for a full-scale envelope, as the ladder's control input
+  void octaveControl(float n) { octaves = n; }
+
+  // The envelope that sweeps the cutoff, and the level it is scaled by (the
+  // amplitude the DC source fed to the ladder's control input)
+  void envelope(FilterEnvelope& e) { env = &e; }
+  void envelopeDepth(float d) { depth = d; }
+
+  virtual void update(void) {
+    audio_block_t *block = receiveWritable(0);
+
+    for (int s = 0; s < AUDIO_BLOCK_SAMPLES; s += VOICE_FILTER_STEP) {
+      float level = env ? env->next() : 0.0f;
+      if (!block) continue;        // keep the envelope moving through silence
+
+      float hz = cutoff;
+      if (level != 0.0f && depth != 0.0f) hz *= exp2f(octaves * depth * level);
+      if (hz > AUDIO_SAMPLE_RATE_EXACT * 0.49f) hz = AUDIO_SAMPLE_RATE_EXACT * 0.49f;
+      if (hz != lastHz) setCoefficients(hz);
+
+      int16_t *p = block->data + s;
+      for (int i = 0; i < VOICE_FILTER_STEP; i++) {
+        int32_t v3 = ((int32_t)p[i] << 8) - ic2;
+        int32_t v1 = mul(a1, ic1) + mul(a2, v3);
+        int32_t v2 = ic2 + mul(a2, ic1) + mul(a3, v3);
+        ic1 = 2 * v1 - ic1;
+        ic2 = 2 * v2 - ic2;
+        int32_t out = v2 >> 8;
+        p[i] = out > 32767 ? 32767 : (out < -32768 ? -32768 : out);
+      }
+    }
+
+    if (block) {
+      transmit(block);
+      release(block);
+    } else {
+      ic1 = ic2 = 0;
+    }
+  }
+
+private:
+  static int32_t mul(int32_t a, int32_t b) { return (int32_t)(((int64_t)a * b) >> 31); }
+
+  static int32_t q31(float x) {
+    return x >= 1.0f ? 0x7FFFFFFF : (int32_t)(x * 2147483648.0f);
+  }
+
+  void setCoefficients(float hz) {
+    float g = tanf(PI * hz / AUDIO_SAMPLE_RATE_EXACT);
+    float c1 = 1.0f / (1.0f + g * (g + k));
+    a1 = q31(c1);
+    a2 = q31(g * c1);
+    a3 = q31(g * g * c1);
+    lastHz = hz;
+  }
+
+  audio_block_t *inputQueueArray[1];
+  FilterEnvelope *env;
+  volatile float cutoff;
+  volatile float octaves;
+  volatile float depth;
+  volatile float k;
+  float lastHz;
+  int32_t a1, a2, a3;              // Q31
+  int32_t ic1, ic2;                // integrator states, samples << 8
+};
+
+#endif // VOICE_FILTER_H
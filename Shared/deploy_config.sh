@@ -42,6 +42,17 @@ deploy_to_project() {
     fi
 }
 
+# Function to copy a shared header into a specific project
+deploy_header_to_project() {
+    local project_dir="$1"
+    local header="$2"
+    
+    if [ -d "$BASE_DIR/$project_dir" ]; then
+        cp "$SCRIPT_DIR/$header" "$BASE_DIR/$project_dir/$header"
+        echo "✅ $project_dir/$header updated"
+    fi
+}
+
 # Deploy to each project
 deploy_to_project "EPiano-Teensy-Synth" "PROJECT_EPIANO" "EPiano-Teensy-Synth"
 deploy_to_project "DCO-Teensy-Synth" "PROJECT_DCO" "DCO-Teensy-Synth"  
@@ -49,5 +60,20 @@ deploy_to_project "FM-Teensy-Synth" "PROJECT_FM" "FM-Teensy-Synth"
 deploy_to_project "Mini-Teensy-Synth" "PROJECT_MINI" "Mini-Teensy-Synth"
 deploy_to_project "MacroOSC-Teensy-Synth" "PROJECT_MACRO" "MacroOSC-Teensy-Synth"
 
+# Shared voice allocator for the VA synths
+deploy_header_to_project "DCO-Teensy-Synth" "VoiceAllocator.h"
+deploy_header_to_project "Mini-Teensy-Synth" "VoiceAllocator.h"
+deploy_header_to_project "MacroOSC-Teensy-Synth" "VoiceAllocator.h"
+
+# Shared fixed-point voice filter
+deploy_header_to_project "Mini-Teensy-Synth" "VoiceFilter.h"
+deploy_header_to_project "MacroOSC-Teensy-Synth" "VoiceFilter.h"
+
+# Shared panel encoder bank
+deploy_header_to_project "DCO-Teensy-Synth" "EncoderBank.h"
+deploy_header_to_project "FM-Teensy-Synth" "EncoderBank.h"
+deploy_header_to_project "Mini-Teensy-Synth" "EncoderBank.h"
+deploy_header_to_project "MacroOSC-Teensy-Synth" "EncoderBank.h"
+
 echo ""
 echo "🎉 Configuration deployment complete!"
@@ -0,0 +1,13 @@
+// Host stand-in for the parts of the Teensy core the shared headers use
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+#define constrain(a, l, h) ((a) < (l) ? (l) : ((a) > (h) ? (h) : (a)))
+inline void __disable_irq() {}
+inline void __enable_irq() {}
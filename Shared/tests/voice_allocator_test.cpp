@@ -0,0 +1,308 @@
+// Host tests and benchmark for VoiceAllocator.h
+//
+//   make test     run the tests
+//   make bench    time note on/off traffic for each steal policy
+
+#include "../VoiceAllocator.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static int failures = 0;
+
+#define CHECK_EQ(actual, expected) do { \
+    long a_ = (long)(actual), e_ = (long)(expected); \
+    if (a_ != e_) { \
+      printf("%s:%d: %s is %ld, expected %ld\n", __FILE__, __LINE__, #actual, a_, e_); \
+      failures++; \
+    } \
+  } while (0)
+
+static float levels[8];
+static float levelOf(uint8_t v) { return levels[v]; }
+
+static void setLevels(float a, float b, float c, float d) {
+  levels[0] = a; levels[1] = b; levels[2] = c; levels[3] = d;
+}
+
+static void testFreeVoices() {
+  VoiceAllocator<4> va;
+  for (int n = 0; n < 4; n++) {
+    CHECK_EQ(va.noteOn(60 + n), n);
+    CHECK_EQ(va.stolen(), false);
+    CHECK_EQ(va.voiceState(n), VOICE_HELD);
+  }
+  CHECK_EQ(va.voiceForNote(62), 2);
+
+  // Note off releases, voiceIdle frees, and a freed voice is handed out next
+  CHECK_EQ(va.noteOff(61), 1);
+  CHECK_EQ(va.voiceState(1), VOICE_RELEASING);
+  CHECK_EQ(va.voiceForNote(61), -1);
+  CHECK_EQ(va.noteOff(61), -1);
+  CHECK_EQ(va.noteOff(99), -1);
+  va.voiceIdle(1);
+  CHECK_EQ(va.voiceState(1), VOICE_FREE);
+  CHECK_EQ(va.noteOn(70), 1);
+  CHECK_EQ(va.stolen(), false);
+}
+
+static void testRetrigger() {
+  // A held note retriggers its own voice under every policy
+  VoiceAllocator<4, VOICE_STEAL_OLDEST> oldest;
+  VoiceAllocator<4, VOICE_STEAL_RELEASE_FIRST> releaseFirst;
+  oldest.noteOn(60); oldest.noteOn(62);
+  releaseFirst.noteOn(60); releaseFirst.noteOn(62);
+  CHECK_EQ(oldest.noteOn(60), 0);
+  CHECK_EQ(oldest.stolen(), true);
+  CHECK_EQ(releaseFirst.noteOn(60), 0);
+  CHECK_EQ(releaseFirst.stolen(), true);
+
+  // The retriggered voice becomes the newest, so voice 1 is now the oldest
+  oldest.noteOn(64); oldest.noteOn(65);
+  CHECK_EQ(oldest.noteOn(66), 1);
+  CHECK_EQ(oldest.voiceForNote(62), -1);
+
+  // A released note is not retriggered: it gets a voice of its own
+  VoiceAllocator<4> va;
+  va.noteOn(60);
+  va.noteOff(60);
+  CHECK_EQ(va.noteOn(60), 1);
+  CHECK_EQ(va.stolen(), false);
+}
+
+static void testStealOldest() {
+  VoiceAllocator<4, VOICE_STEAL_OLDEST> va;
+  for (int n = 0; n < 4; n++) va.noteOn(60 + n);
+  va.noteOff(62);
+  // Trigger order decides, released or not
+  CHECK_EQ(va.noteOn(70), 0);
+  CHECK_EQ(va.stolen(), true);
+  CHECK_EQ(va.noteOn(71), 1);
+  CHECK_EQ(va.noteOn(72), 2);
+  CHECK_EQ(va.noteOff(60), -1);
+}
+
+static void testStealQuietest() {
+  VoiceAllocator<4, VOICE_STEAL_QUIETEST> va(levelOf);
+  for (int n = 0; n < 4; n++) va.noteOn(60 + n);
+  setLevels(1.0f, 0.5f, 0.2f, 0.8f);
+  CHECK_EQ(va.noteOn(70), 2);
+  CHECK_EQ(va.stolen(), true);
+  setLevels(1.0f, 0.5f, 1.0f, 0.8f);
+  CHECK_EQ(va.noteOn(71), 1);
+
+  // Without a level function it falls back to the oldest
+  VoiceAllocator<4, VOICE_STEAL_QUIETEST> blind;
+  for (int n = 0; n < 4; n++) blind.noteOn(60 + n);
+  CHECK_EQ(blind.noteOn(70), 0);
+}
+
+static void testStealSameNote() {
+  VoiceAllocator<4, VOICE_STEAL_SAME_NOTE> va;
+  va.noteOn(60);
+  va.noteOn(62);
+  va.noteOff(60);
+  // The releasing voice of the same note is reused although voices are free
+  CHECK_EQ(va.noteOn(60), 0);
+  CHECK_EQ(va.stolen(), true);
+  CHECK_EQ(va.voiceState(0), VOICE_HELD);
+  CHECK_EQ(va.noteOn(64), 2);
+  CHECK_EQ(va.stolen(), false);
+  va.noteOn(65);
+  CHECK_EQ(va.noteOn(66), 1);
+}
+
+static void testReleaseFirst() {
+  // Releasing voices go before held ones, oldest release first
+  VoiceAllocator<4, VOICE_STEAL_RELEASE_FIRST> va;
+  for (int n = 0; n < 4; n++) va.noteOn(60 + n);
+  va.noteOff(63);
+  va.noteOff(61);
+  CHECK_EQ(va.noteOn(70), 3);
+  CHECK_EQ(va.stolen(), true);
+  CHECK_EQ(va.noteOn(71), 1);
+  // Nothing releasing: the oldest held voice
+  CHECK_EQ(va.noteOn(72), 0);
+  CHECK_EQ(va.voiceForNote(60), -1);
+
+  // With a level function, the quietest releasing voice
+  VoiceAllocator<4, VOICE_STEAL_RELEASE_FIRST> leveled(levelOf);
+  for (int n = 0; n < 4; n++) leveled.noteOn(60 + n);
+  leveled.noteOff(60);
+  leveled.noteOff(61);
+  leveled.noteOff(62);
+  setLevels(0.6f, 0.7f, 0.1f, 0.0f);
+  CHECK_EQ(leveled.noteOn(70), 2);
+  // Voice 3 is quietest but held, so it is not taken
+  setLevels(0.6f, 0.3f, 1.0f, 0.0f);
+  CHECK_EQ(leveled.noteOn(71), 1);
+}
+
+static void testVoiceLimit() {
+  VoiceAllocator<4> va;
+  va.setVoiceLimit(2);
+  CHECK_EQ(va.voiceLimit(), 2);
+  CHECK_EQ(va.noteOn(60), 0);
+  CHECK_EQ(va.noteOn(61), 1);
+  // Past the limit a note steals although voices 2 and 3 are free
+  CHECK_EQ(va.noteOn(62), 0);
+  CHECK_EQ(va.stolen(), true);
+  // A freed voice counts back under the limit
+  va.noteOff(61);
+  va.voiceIdle(1);
+  CHECK_EQ(va.noteOn(63), 1);
+  CHECK_EQ(va.stolen(), false);
+
+  // Raising the limit opens the free voices again
+  va.setVoiceLimit(4);
+  CHECK_EQ(va.noteOn(64), 2);
+  CHECK_EQ(va.stolen(), false);
+
+  // Lowering it below the voices sounding leaves them, new notes steal
+  va.noteOn(65);
+  va.setVoiceLimit(1);
+  CHECK_EQ(va.noteOn(66), 0);
+  CHECK_EQ(va.stolen(), true);
+  CHECK_EQ(va.voiceState(3), VOICE_HELD);
+
+  va.setVoiceLimit(0);
+  CHECK_EQ(va.voiceLimit(), 1);
+  va.setVoiceLimit(9);
+  CHECK_EQ(va.voiceLimit(), 4);
+  va.reset();
+  CHECK_EQ(va.voiceLimit(), 4);
+}
+
+static void testVoiceOn() {
+  // Mono and legato hold voice 0 themselves; the allocator follows
+  VoiceAllocator<4> va;
+  va.voiceOn(0, 60);
+  CHECK_EQ(va.voiceState(0), VOICE_HELD);
+  CHECK_EQ(va.voiceForNote(60), 0);
+  // A free voice 0 left the free stack: poly notes get the others
+  CHECK_EQ(va.noteOn(70), 1);
+  va.noteOff(70);
+  va.voiceIdle(1);
+
+  // Moving voice 0 to the next note drops the old one
+  va.voiceOn(0, 62);
+  CHECK_EQ(va.voiceForNote(60), -1);
+  CHECK_EQ(va.voiceForNote(62), 0);
+
+  // Released and idled as usual, then free again
+  va.voiceOff(0);
+  CHECK_EQ(va.voiceState(0), VOICE_RELEASING);
+  va.voiceOn(0, 64);
+  CHECK_EQ(va.voiceState(0), VOICE_HELD);
+  CHECK_EQ(va.noteOff(64), 0);
+  va.voiceIdle(0);
+  for (int n = 0; n < 4; n++) {
+    va.noteOn(80 + n);
+    CHECK_EQ(va.stolen(), false);
+  }
+
+  // A voice in the middle of the free stack
+  VoiceAllocator<4> mid;
+  mid.voiceOn(2, 60);
+  CHECK_EQ(mid.noteOn(61), 0);
+  CHECK_EQ(mid.noteOn(62), 1);
+  CHECK_EQ(mid.noteOn(63), 3);
+  CHECK_EQ(mid.stolen(), false);
+
+  // reset() frees everything, as on a play mode change
+  mid.reset();
+  for (int v = 0; v < 4; v++) CHECK_EQ(mid.voiceState(v), VOICE_FREE);
+  CHECK_EQ(mid.voiceForNote(60), -1);
+}
+
+static void testNoteStack() {
+  NoteStack<4> stack;
+  CHECK_EQ(stack.top(), -1);
+  stack.push(60);
+  stack.push(64);
+  stack.push(60);
+  CHECK_EQ(stack.size(), 2);
+  CHECK_EQ(stack.top(), 64);
+
+  // Releasing the top note falls back to the one held before it
+  stack.push(67);
+  stack.remove(67);
+  CHECK_EQ(stack.top(), 64);
+  stack.remove(60);
+  CHECK_EQ(stack.top(), 64);
+  CHECK_EQ(stack.size(), 1);
+  stack.remove(99);
+  CHECK_EQ(stack.size(), 1);
+
+  // Notes past the size are dropped
+  stack.push(1); stack.push(2); stack.push(3); stack.push(4);
+  CHECK_EQ(stack.size(), 4);
+  CHECK_EQ(stack.top(), 3);
+  stack.clear();
+  CHECK_EQ(stack.top(), -1);
+}
+
+// Random chords played and released, voices freed a few notes after their
+// release as an envelope would. Returns ns per note (on + off).
+template <VoiceStealPolicy Policy>
+static double benchPolicy(int notes) {
+  static float benchLevels[8] = { 0.9f, 0.2f, 0.5f, 0.7f, 0.1f, 0.4f, 0.8f, 0.3f };
+  struct Level { static float of(uint8_t v) { return benchLevels[v]; } };
+  VoiceAllocator<8, Policy> va(Level::of);
+  uint8_t held[8] = { 0 };
+  int8_t releasing[4] = { -1, -1, -1, -1 };
+  uint32_t seed = 1;
+  volatile int sink = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < notes; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    uint8_t slot = (seed >> 8) & 7;
+    uint8_t note = 36 + ((seed >> 16) % 48);
+    int8_t off = va.noteOff(held[slot]);
+    if (off >= 0) {
+      if (releasing[i & 3] >= 0) va.voiceIdle(releasing[i & 3]);
+      releasing[i & 3] = off;
+    }
+    held[slot] = note;
+    sink += va.noteOn(note);
+  }
+  auto end = std::chrono::steady_clock::now();
+  (void)sink;
+  return std::chrono::duration<double, std::nano>(end - start).count() / notes;
+}
+
+static void bench() {
+  const int notes = 2000000;
+  printf("8 voices, %d notes, ns per note on + off\n", notes);
+  printf("  oldest         %6.1f\n", benchPolicy<VOICE_STEAL_OLDEST>(notes));
+  printf("  quietest       %6.1f\n", benchPolicy<VOICE_STEAL_QUIETEST>(notes));
+  printf("  same note      %6.1f\n", benchPolicy<VOICE_STEAL_SAME_NOTE>(notes));
+  printf("  release first  %6.1f\n", benchPolicy<VOICE_STEAL_RELEASE_FIRST>(notes));
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+    bench();
+    return 0;
+  }
+
+  testFreeVoices();
+  testRetrigger();
+  testStealOldest();
+  testStealQuietest();
+  testStealSameNote();
+  testReleaseFirst();
+  testVoiceLimit();
+  testVoiceOn();
+  testNoteStack();
+
+  if (failures) {
+    printf("%d check(s) failed\n", failures);
+    return 1;
+  }
+  printf("VoiceAllocator: all tests passed\n");
+  return 0;
+}
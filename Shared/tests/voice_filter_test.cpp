@@ -0,0 +1,318 @@
+// Host tests, response sweep and benchmark for VoiceFilter.h
+//
+//   make test     check the SVF's response, stability and envelope
+//   make sweep    write voice_filter_response.csv: gain of the SVF and
+//                 of the ladder model below against frequency
+//   make bench    time a block through each
+//
+// The Teensy library's AudioFilterLadder isn't in this tree, so the ladder
+// side is LadderModel: the same structure in float (input tanh, four
+// one-pole stages with the 0.3 zero, 2x oversampled, passband gain 0.5) but
+// not the library source. Its curves show the 24 dB against 12 dB slope and
+// its time is an order of magnitude; AudioProcessorUsage() on the board is
+// the real side-by-side.
+
+#include "VoiceFilter.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+audio_block_t* hostIn;
+audio_block_t hostOut;
+
+static int failures = 0;
+
+#define CHECK_NEAR(actual, expected, tolerance) do { \
+    double a_ = (actual), e_ = (expected); \
+    if (fabs(a_ - e_) > (tolerance)) { \
+      printf("%s:%d: %s is %.2f, expected %.2f +- %.2f\n", __FILE__, __LINE__, \
+             #actual, a_, e_, (double)(tolerance)); \
+      failures++; \
+    } \
+  } while (0)
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+      printf("%s:%d: %s failed\n", __FILE__, __LINE__, #cond); \
+      failures++; \
+    } \
+  } while (0)
+
+class LadderModel : public AudioStream {
+public:
+  LadderModel() : AudioStream(1, inputQueueArray), k(0.0f), alpha(0.0f), last(0.0f) {
+    memset(z0, 0, sizeof(z0));
+    memset(z1, 0, sizeof(z1));
+  }
+
+  void frequency(float hz) {
+    hz = constrain(hz, 5.0f, AUDIO_SAMPLE_RATE_EXACT * 0.425f);
+    alpha = 1.0f - expf(-2.0f * (float)PI * hz / (2.0f * AUDIO_SAMPLE_RATE_EXACT));
+  }
+
+  // Scaled to self-oscillate near the top of the ladder's 0-1.8 range
+  void resonance(float res) { k = constrain(res, 0.0f, 1.8f) * 2.4f; }
+
+  virtual void update(void) {
+    audio_block_t *block = receiveWritable(0);
+    if (!block) return;
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+      float x = block->data[i] * (1.0f / 32768.0f);
+      float y = 0.5f * (step(0.5f * (last + x)) + step(x));
+      last = x;
+      y *= 32768.0f;
+      block->data[i] = y > 32767.0f ? 32767 : (y < -32768.0f ? -32768 : (int16_t)y);
+    }
+    transmit(block);
+    release(block);
+  }
+
+private:
+  static float fastTanh(float x) {
+    if (x > 3.0f) return 1.0f;
+    if (x < -3.0f) return -1.0f;
+    float x2 = x * x;
+    return x * (27.0f + x2) / (27.0f + 9.0f * x2);
+  }
+
+  float step(float x) {
+    float u = fastTanh(x - (z1[3] - 0.5f * x) * k);
+    for (int s = 0; s < 4; s++) {
+      float ft = u * (1.0f / 1.3f) + z0[s] * (0.3f / 1.3f) - z1[s];
+      ft = ft * alpha + z1[s];
+      z0[s] = u;
+      z1[s] = ft;
+      u = ft;
+    }
+    return u;
+  }
+
+  audio_block_t *inputQueueArray[1];
+  float k;
+  float alpha;
+  float last;
+  float z0[4], z1[4];
+};
+
+// Gain in dB of a sine at hz through the filter, after it has settled
+template <class Filter>
+static double gainAt(Filter& filter, float hz) {
+  static audio_block_t block;
+  const double amplitude = 8000;
+  double phase = 0, sum = 0;
+  int n = 0;
+  hostIn = &block;
+  for (int b = 0; b < 200; b++) {
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+      block.data[i] = (int16_t)(amplitude * sin(phase));
+      phase += 2 * M_PI * hz / AUDIO_SAMPLE_RATE_EXACT;
+    }
+    filter.update();
+    if (b < 100) continue;
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+      sum += (double)hostOut.data[i] * hostOut.data[i];
+      n++;
+    }
+  }
+  return 20 * log10(sqrt(sum / n) / (amplitude / sqrt(2.0)));
+}
+
+static double svfGain(float fc, float res, float hz) {
+  AudioFilterVoiceSvf svf;
+  svf.frequency(fc);
+  svf.resonance(res);
+  return gainAt(svf, hz);
+}
+
+static double ladderGain(float fc, float res, float hz) {
+  LadderModel ladder;
+  ladder.frequency(fc);
+  ladder.resonance(res);
+  return gainAt(ladder, hz);
+}
+
+static void testResponse() {
+  // Butterworth at zero resonance: flat below, -3 dB at the cutoff, then
+  // 12 dB/oct (steeper near Nyquist, where the bilinear zero sits)
+  const float cutoffs[] = { 200, 1000, 5000, 15000 };
+  for (float fc : cutoffs) {
+    CHECK_NEAR(svfGain(fc, 0, fc / 4), 0.0, 0.2);
+    CHECK_NEAR(svfGain(fc, 0, fc), -3.0, 0.3);
+    if (fc * 2 < AUDIO_SAMPLE_RATE_EXACT / 2) CHECK(svfGain(fc, 0, fc * 2) < -11.0);
+    if (fc * 4 < AUDIO_SAMPLE_RATE_EXACT / 2) CHECK(svfGain(fc, 0, fc * 4) < -23.0);
+  }
+
+  // Resonance peaks at the cutoff without lifting the passband (the top
+  // of the range clips this test level, so only compare the two)
+  CHECK(svfGain(1000, 0.9f, 1000) > 2.0);
+  CHECK(svfGain(1000, 1.8f, 1000) > svfGain(1000, 0.9f, 1000) + 6.0);
+  CHECK_NEAR(svfGain(1000, 1.8f, 250), 0.0, 1.0);
+}
+
+static void testStability() {
+  // Full-scale noise, maximum resonance and the envelope sweeping the
+  // cutoff over seven octaves: the states must not run away
+  static audio_block_t block;
+  FilterEnvelope env;
+  env.attack(5);
+  env.decay(200);
+  env.sustain(0.3f);
+  env.release(100);
+  AudioFilterVoiceSvf svf;
+  svf.envelope(env);
+  svf.envelopeDepth(1.0f);
+  svf.octaveControl(7);
+  svf.frequency(100);
+  svf.resonance(1.8f);
+
+  srand(1);
+  hostIn = &block;
+  env.noteOn();
+  long peak = 0;
+  for (int b = 0; b < 2000; b++) {
+    if (b == 1000) env.noteOff();
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) block.data[i] = rand() % 65536 - 32768;
+    svf.update();
+    for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+      if (labs(hostOut.data[i]) > peak) peak = labs(hostOut.data[i]);
+    }
+  }
+  CHECK(peak > 0);
+  CHECK(!env.isActive());
+
+  // Silence afterwards rings down (Q is about 30 at 100 Hz, a time
+  // constant near 0.1 s). The truncating multiplies leave a dead band
+  // around zero at low cutoffs: a DC residue of a couple of LSB at 100 Hz,
+  // a few at 30 Hz, gated off by the amp envelope.
+  long tail = 0;
+  for (int b = 0; b < 1000; b++) {
+    memset(block.data, 0, sizeof(block.data));
+    svf.update();
+  }
+  for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+    if (labs(hostOut.data[i]) > tail) tail = labs(hostOut.data[i]);
+  }
+  CHECK(tail <= 2);
+}
+
+static void testEnvelope() {
+  // 10 ms attack at 16 samples a step is about 28 steps to full level
+  FilterEnvelope env;
+  env.attack(10);
+  env.decay(20);
+  env.sustain(0.5f);
+  env.release(30);
+  CHECK(!env.isActive());
+  env.noteOn();
+  int steps = 0;
+  while (env.next() < 1.0f && steps < 1000) steps++;
+  CHECK_NEAR(steps + 1, 10 * AUDIO_SAMPLE_RATE_EXACT / 1000 / VOICE_FILTER_STEP, 1.5);
+  while (!env.isSustain() && steps < 1000) { env.next(); steps++; }
+  CHECK_NEAR(env.next(), 0.5, 1e-6);
+  env.noteOff();
+  while (env.isActive() && steps < 1000) { env.next(); steps++; }
+  CHECK(!env.isActive());
+  CHECK_NEAR(env.next(), 0.0, 1e-6);
+
+  // Without an input block the envelope still advances
+  static AudioFilterVoiceSvf svf;
+  FilterEnvelope idle;
+  idle.attack(1);
+  svf.envelope(idle);
+  idle.noteOn();
+  hostIn = NULL;
+  svf.update();
+  CHECK(idle.next() == 1.0f);
+}
+
+// Gain of both filters at each third of an octave from 20 Hz, for plotting
+static void sweep() {
+  const float cutoffs[] = { 500, 2000, 8000 };
+  const float resonances[] = { 0.0f, 0.9f, 1.5f };
+  printf("hz");
+  for (float fc : cutoffs) {
+    for (float res : resonances) {
+      printf(",svf %.0f/%.1f,ladder %.0f/%.1f", fc, res, fc, res);
+    }
+  }
+  printf("\n");
+  for (double hz = 20; hz < 20000; hz *= pow(2.0, 1.0 / 3)) {
+    printf("%.0f", hz);
+    for (float fc : cutoffs) {
+      for (float res : resonances) {
+        printf(",%.2f,%.2f", svfGain(fc, res, hz), ladderGain(fc, res, hz));
+      }
+    }
+    printf("\n");
+  }
+}
+
+// Best of several runs, so a busy host doesn't skew the comparison
+template <class Filter>
+static double nsPerBlock(Filter& filter) {
+  static audio_block_t noise, block;
+  for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) noise.data[i] = rand() % 20000 - 10000;
+  hostIn = &block;
+  const int blocks = 20000;
+  double best = 1e18;
+  for (int r = 0; r < 9; r++) {
+    auto start = std::chrono::steady_clock::now();
+    for (int b = 0; b < blocks; b++) {
+      memcpy(block.data, noise.data, sizeof(block.data));
+      filter.update();
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / blocks;
+    if (ns < best) best = ns;
+  }
+  return best;
+}
+
+static void bench() {
+  FilterEnvelope env;
+  env.attack(3000);
+  AudioFilterVoiceSvf fixed, swept;
+  fixed.frequency(1000);
+  fixed.resonance(0.9f);
+  swept.frequency(200);
+  swept.resonance(0.9f);
+  swept.envelope(env);
+  swept.envelopeDepth(1.0f);
+  swept.octaveControl(5);
+  env.noteOn();
+  LadderModel ladder;
+  ladder.frequency(1000);
+  ladder.resonance(0.9f);
+
+  double ladderNs = nsPerBlock(ladder);
+  double fixedNs = nsPerBlock(fixed);
+  double sweptNs = nsPerBlock(swept);
+  printf("svf, fixed cutoff:     %6.0f ns/block\n", fixedNs);
+  printf("svf, envelope sweep:   %6.0f ns/block\n", sweptNs);
+  printf("ladder model:          %6.0f ns/block (%.1fx the swept svf)\n",
+         ladderNs, ladderNs / sweptNs);
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1 && strcmp(argv[1], "sweep") == 0) {
+    sweep();
+    return 0;
+  }
+  if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+    bench();
+    return 0;
+  }
+
+  testResponse();
+  testStability();
+  testEnvelope();
+
+  if (failures) {
+    printf("%d check(s) failed\n", failures);
+    return 1;
+  }
+  printf("VoiceFilter: all tests passed\n");
+  return 0;
+}